@@ -0,0 +1,196 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// Min/max/mean summary of a per-channel value stream at several time scales, so hours of
+// activity can be drawn at any zoom in time proportional to the pixels drawn rather than the
+// frames recorded. Level 0 holds the frames as pushed; each level above summarises `factor`
+// cells of the one below and is filled in as soon as those are complete. Every level is a
+// ring of the same capacity, so memory is fixed by the depth while the span covered grows by
+// the factor per level: full detail is kept for the most recent stretch, and older ranges are
+// answered from the coarser levels.
+class ActivityPyramid
+{
+public:
+    struct Cell
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float mean = 0.0f;
+    };
+
+    ActivityPyramid (int numChannelsToUse, int depthToUse, int capacityPerLevel = 4096, int decimationFactor = 4)
+        : numChannels (juce::jmax (1, numChannelsToUse)),
+          capacity (juce::jmax (decimationFactor, capacityPerLevel)),
+          factor (juce::jlimit (2, 4, decimationFactor))
+    {
+        levels.resize ((size_t) juce::jlimit (1, 16, depthToUse));
+
+        juce::int64 scale = 1;
+        for (auto& level : levels)
+        {
+            level.scale = scale;
+            level.cells.resize ((size_t) capacity * (size_t) numChannels);
+            level.partial.resize ((size_t) numChannels);
+            scale *= factor;
+        }
+    }
+
+    int getNumChannels() const noexcept             { return numChannels; }
+    int getDepth() const noexcept                   { return (int) levels.size(); }
+    juce::int64 getNumFrames() const noexcept       { return levels.front().written; }
+
+    /** The first frame any level still covers. */
+    juce::int64 getOldestFrame() const noexcept
+    {
+        auto oldest = getNumFrames();
+        for (const auto& level : levels)
+            oldest = juce::jmin (oldest, juce::jmax ((juce::int64) 0, level.written - capacity) * level.scale);
+        return oldest;
+    }
+
+    /** Appends one frame holding one value per channel. Amortised O(channels): a level above
+        is touched only once per `factor` cells of the level below. */
+    void push (const float* values) noexcept
+    {
+        auto* cells = getCells (0, getNumFrames());
+        for (int ch = 0; ch < numChannels; ++ch)
+            cells[ch] = { values[ch], values[ch], values[ch] };
+
+        commit (0);
+    }
+
+    /** Summarises frames [start, end) of every channel into dest (numChannels entries). Each
+        stretch is read from the coarsest cells that fit inside the range, with finer cells at
+        the unaligned edges and where the coarse cell is still being built, and from coarser
+        cells where the fine ones have already been overwritten. Returns false if no frame of
+        the range is still held. */
+    bool summarise (juce::int64 start, juce::int64 end, Cell* dest) const noexcept
+    {
+        start = juce::jmax (start, getOldestFrame());
+        end = juce::jmin (end, getNumFrames());
+
+        if (start >= end)
+            return false;
+
+        int top = 0;
+        while (top + 1 < getDepth() && levels[(size_t) top + 1].scale <= end - start)
+            ++top;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            dest[ch] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), 0.0f };
+
+        juce::int64 covered = 0;
+
+        for (auto position = start; position < end;)
+        {
+            int chosen = -1;
+
+            for (int l = top; l >= 0 && chosen < 0; --l)
+            {
+                const auto& level = levels[(size_t) l];
+                if (position % level.scale == 0 && position + level.scale <= end && isAvailable (l, position / level.scale))
+                    chosen = l;
+            }
+
+            for (int l = 0; l < getDepth() && chosen < 0; ++l)
+                if (isAvailable (l, position / levels[(size_t) l].scale))
+                    chosen = l;
+
+            if (chosen < 0)
+                break;
+
+            const auto scale = levels[(size_t) chosen].scale;
+            const auto cellStart = (position / scale) * scale;
+            const auto weight = (float) (juce::jmin (cellStart + scale, end) - position);
+            const auto* cells = getCells (chosen, position / scale);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                dest[ch].min = juce::jmin (dest[ch].min, cells[ch].min);
+                dest[ch].max = juce::jmax (dest[ch].max, cells[ch].max);
+                dest[ch].mean += cells[ch].mean * weight;
+            }
+
+            covered += (juce::int64) weight;
+            position = cellStart + scale;
+        }
+
+        if (covered == 0)
+            return false;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            dest[ch].mean /= (float) covered;
+
+        return true;
+    }
+
+private:
+    struct Level
+    {
+        juce::int64 scale = 1;          // frames per cell
+        juce::int64 written = 0;        // completed cells
+        std::vector<Cell> cells;        // ring: slot-major, numChannels per slot
+        std::vector<Cell> partial;      // the cell being built; mean holds the sum
+        int partialCount = 0;
+    };
+
+    bool isAvailable (int level, juce::int64 cell) const noexcept
+    {
+        const auto written = levels[(size_t) level].written;
+        return cell < written && cell >= written - capacity;
+    }
+
+    Cell* getCells (int level, juce::int64 cell) noexcept
+    {
+        return levels[(size_t) level].cells.data() + (size_t) (cell % capacity) * (size_t) numChannels;
+    }
+
+    const Cell* getCells (int level, juce::int64 cell) const noexcept
+    {
+        return levels[(size_t) level].cells.data() + (size_t) (cell % capacity) * (size_t) numChannels;
+    }
+
+    // The newest cell of `level` has been filled in: publish it and fold it into the level above.
+    void commit (int level) noexcept
+    {
+        auto& current = levels[(size_t) level];
+        const auto* cells = getCells (level, current.written);
+        ++current.written;
+
+        if (level + 1 >= getDepth())
+            return;
+
+        auto& parent = levels[(size_t) level + 1];
+        const auto first = parent.partialCount++ == 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& cell = parent.partial[(size_t) ch];
+            cell.min = first ? cells[ch].min : juce::jmin (cell.min, cells[ch].min);
+            cell.max = first ? cells[ch].max : juce::jmax (cell.max, cells[ch].max);
+            cell.mean = (first ? 0.0f : cell.mean) + cells[ch].mean;
+        }
+
+        if (parent.partialCount < factor)
+            return;
+
+        auto* target = getCells (level + 1, parent.written);
+        for (int ch = 0; ch < numChannels; ++ch)
+            target[ch] = { parent.partial[(size_t) ch].min, parent.partial[(size_t) ch].max,
+                           parent.partial[(size_t) ch].mean / (float) factor };
+
+        parent.partialCount = 0;
+        commit (level + 1);
+    }
+
+    const int numChannels;
+    const int capacity;
+    const int factor;
+    std::vector<Level> levels;
+
+    JUCE_DECLARE_NON_COPYABLE (ActivityPyramid)
+};
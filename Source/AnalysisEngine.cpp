@@ -0,0 +1,794 @@
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <utility>
+
+#include "AnalysisEngine.h"
+
+namespace
+{
+    constexpr float degToRad(float degrees) noexcept
+    {
+        return degrees * juce::MathConstants<float>::pi / 180.0f;
+    }
+
+    SpatialVector unitVectorFromAngles(float azimuthDeg, float elevationDeg) noexcept
+    {
+        const auto azimuth = degToRad(azimuthDeg);
+        const auto elevation = degToRad(elevationDeg);
+        const auto cosElevation = std::cos(elevation);
+
+        return {
+            cosElevation * std::cos(azimuth),
+            std::sin(elevation),
+            cosElevation * std::sin(azimuth)
+        };
+    }
+
+    SpatialVector mapUnitToRoom(const SpatialVector& unit,
+        const AnalysisEngine::RoomDimensions& room,
+        bool isLfe) noexcept
+    {
+        if (isLfe)
+            return { room.depth * 0.48f, -room.earHeight * 0.85f, 0.0f };
+
+        const auto depthHalf = room.depth * 0.5f;
+        const auto widthHalf = room.width * 0.5f;
+        const auto ceiling = room.height - room.earHeight;
+        const auto floor = room.earHeight;
+
+        const auto x = juce::jlimit(-depthHalf, depthHalf, unit.x * depthHalf);
+        const auto z = juce::jlimit(-widthHalf, widthHalf, unit.z * widthHalf);
+        const auto y = unit.y >= 0.0f
+            ? juce::jlimit(0.0f, ceiling, unit.y * ceiling)
+            : juce::jlimit(-floor, 0.0f, unit.y * floor);
+
+        return { x, y, z };
+    }    struct SpeakerSeed
+    {
+        juce::AudioChannelSet::ChannelType type;
+        const char* id;
+        const char* displayName;
+        float azimuthDegrees;
+        float elevationDegrees;
+        bool isLfe;
+    };
+
+        static constexpr SpeakerSeed speakerSeedTable[] =
+    {
+        { juce::AudioChannelSet::left,             "L",   "Left",             -30.0f,  0.0f, false },
+        { juce::AudioChannelSet::right,            "R",   "Right",             30.0f,  0.0f, false },
+        { juce::AudioChannelSet::centre,           "C",   "Centre",             0.0f,  0.0f, false },
+        { juce::AudioChannelSet::leftCentre,       "Lc",  "Left Centre",      -15.0f,  0.0f, false },
+        { juce::AudioChannelSet::rightCentre,      "Rc",  "Right Centre",      15.0f,  0.0f, false },
+        { juce::AudioChannelSet::surround,         "S",   "Surround",         180.0f,  0.0f, false },
+        { juce::AudioChannelSet::centreSurround,   "Cs",  "Centre Surround",  180.0f,  0.0f, false },
+        { juce::AudioChannelSet::LFE,              "LFE", "LFE",                0.0f, -30.0f, true  },
+        { juce::AudioChannelSet::leftSurround,     "Ls",  "Surround L",      -100.0f,  0.0f, false },
+        { juce::AudioChannelSet::rightSurround,    "Rs",  "Surround R",       100.0f,  0.0f, false },
+        { juce::AudioChannelSet::leftSurroundSide, "Lss", "Side Surround L",  -110.0f,  0.0f, false },
+        { juce::AudioChannelSet::rightSurroundSide,"Rss", "Side Surround R",   110.0f,  0.0f, false },
+        { juce::AudioChannelSet::leftSurroundRear, "Lrs", "Rear Surround L", -150.0f,  0.0f, false },
+        { juce::AudioChannelSet::rightSurroundRear,"Rrs", "Rear Surround R",  150.0f,  0.0f, false },
+        { juce::AudioChannelSet::wideLeft,         "Lw",  "Wide Left",        -55.0f,  0.0f, false },
+        { juce::AudioChannelSet::wideRight,        "Rw",  "Wide Right",        55.0f,  0.0f, false },
+        { juce::AudioChannelSet::topFrontLeft,     "Ltf", "Top Front L",      -45.0f, 50.0f, false },
+        { juce::AudioChannelSet::topFrontRight,    "Rtf", "Top Front R",       45.0f, 50.0f, false },
+        { juce::AudioChannelSet::topFrontCentre,   "Tfc", "Top Front C",        0.0f, 55.0f, false },
+        { juce::AudioChannelSet::topSideLeft,      "Lts", "Top Side L",       -90.0f, 65.0f, false },
+        { juce::AudioChannelSet::topSideRight,     "Rts", "Top Side R",        90.0f, 65.0f, false },
+        { juce::AudioChannelSet::topRearLeft,      "Ltr", "Top Rear L",      -135.0f, 50.0f, false },
+        { juce::AudioChannelSet::topRearRight,     "Rtr", "Top Rear R",       135.0f, 50.0f, false },
+        { juce::AudioChannelSet::topRearCentre,    "Trc", "Top Rear C",       180.0f, 55.0f, false }
+    };
+
+    // Pairs worth checking for misalignment: left/right mirror images at the same height,
+    // plus the centre against the front left and right.
+    std::vector<DelayEstimator::Pair> buildDelayPairs (const AnalysisEngine::SpeakerDefinitions& defs)
+    {
+        std::vector<DelayEstimator::Pair> pairs;
+
+        auto add = [&pairs] (size_t a, size_t b)
+        {
+            if (pairs.size() < (size_t) DelayEstimator::maxPairs)
+                pairs.push_back ({ (int) a, (int) b });
+        };
+
+        for (size_t a = 0; a < defs.size(); ++a)
+        {
+            for (size_t b = a + 1; b < defs.size(); ++b)
+            {
+                const auto& first = defs[a];
+                const auto& second = defs[b];
+
+                if (first.isLfe || second.isLfe)
+                    continue;
+
+                const auto mirrored = std::abs (first.azimuthDegrees) > 1.0f
+                                   && std::abs (first.azimuthDegrees + second.azimuthDegrees) < 1.0f
+                                   && std::abs (first.elevationDegrees - second.elevationDegrees) < 1.0f;
+
+                const auto isCentreAndFront = [] (const AnalysisEngine::SpeakerDefinition& c,
+                                                  const AnalysisEngine::SpeakerDefinition& f)
+                {
+                    return c.channelType == juce::AudioChannelSet::centre
+                        && (f.channelType == juce::AudioChannelSet::left || f.channelType == juce::AudioChannelSet::right);
+                };
+
+                if (mirrored || isCentreAndFront (first, second) || isCentreAndFront (second, first))
+                    add (a, b);
+            }
+        }
+
+        return pairs;
+    }
+
+
+}
+
+const AnalysisEngine::RoomDimensions AnalysisEngine::defaultRoom{ 6.4f, 3.05f, 7.6f, 1.2f };
+
+AnalysisEngine::AnalysisEngine()
+{
+    updateBandSplit();
+    setLayout (juce::AudioChannelSet::create7point1point4());
+}
+
+void AnalysisEngine::prepare (double sampleRate, const juce::AudioChannelSet& layout)
+{
+    currentSampleRate = sampleRate;
+    samplesProcessed = 0;
+    updateBandSplit();
+    setLayout (layout);
+    loudnessMeter.prepare (sampleRate);
+    correlationMatrix.prepare (sampleRate);
+    delayEstimator.prepare (sampleRate);
+}
+
+void AnalysisEngine::release()
+{
+    delayEstimator.release();
+}
+
+void AnalysisEngine::setMeterBallistics (const MeterBallistics& newBallistics) noexcept
+{
+    meterBallistics = newBallistics;
+    meterCoefficients.update (meterBallistics, currentSampleRate);
+}
+
+void AnalysisEngine::resetMeterCounters() noexcept
+{
+    for (auto& state : channelStates)
+        state.meter.resetCounters();
+}
+
+void AnalysisEngine::process (const juce::AudioBuffer<float>& buffer, bool offline, AnalysisGovernor::Tier tier, BlockResult& result) noexcept
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = buffer.getNumChannels();
+    const auto blockStart = samplesProcessed;
+    samplesProcessed += numSamples;
+
+    auto& metrics = result.metrics;
+    metrics.resize (speakerDefinitions.size());
+    std::fill (metrics.begin(), metrics.end(), SpeakerMetrics {});
+
+    if (metrics.empty())
+        return;
+
+    if (offline != wasRenderingOffline)
+    {
+        // Held bands and meters carry across the switch so the display does not jump;
+        // only the offline overlap buffers start over.
+        for (auto& state : channelStates)
+            state.fifoFill = 0;
+
+        wasRenderingOffline = offline;
+    }
+
+    const auto settings = AnalysisGovernor::getSettings (tier);
+    auto& analyser = reducedAnalyser;
+    const auto multiResolution = ! offline && settings.spectral && settings.fftOrderReduction == 0;
+
+    if (multiResolution && ! multiResolutionActive)
+    {
+        // The windows hold audio from before the governor last degraded; start them afresh.
+        for (size_t i = 0; i < channelStates.size(); ++i)
+            resetResolutionWindows ((int) i, channelStates[i]);
+    }
+
+    multiResolutionActive = multiResolution;
+    const auto hopSamples = (int) (settings.hopSeconds * currentSampleRate);
+
+    const auto numDefinitions = (int) metrics.size();
+    // Channel data in speaker definition order for the multichannel meters.
+    static_assert (LoudnessMeter::maxChannels == CorrelationMatrix::maxChannels, "meters must agree on channel count");
+    std::array<const float*, LoudnessMeter::maxChannels> definitionInputs {};
+    const auto channelsThisBlock = juce::jmax (1, (numDefinitions + settings.roundRobinDivisor - 1) / settings.roundRobinDivisor);
+
+    for (auto& state : channelStates)
+        state.spectrumFresh = false;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto channelType = channelLayout.getTypeOfChannel (ch);
+        const auto defIndex = findDefinitionIndexForChannel (channelType);
+        if (defIndex < 0 || static_cast<size_t> (defIndex) >= metrics.size())
+            continue;
+
+        const auto* channelData = buffer.getReadPointer (ch);
+
+        if (defIndex < LoudnessMeter::maxChannels)
+            definitionInputs[(size_t) defIndex] = channelData;
+
+        auto& entry = metrics[(size_t) defIndex];
+        auto& state = channelStates[(size_t) defIndex];
+        const auto readings = state.meter.process (channelData, numSamples, meterCoefficients, offline);
+        entry.rms = readings.rms;
+        entry.peak = readings.peak;
+        entry.truePeak = readings.truePeak;
+        entry.level = readings.level;
+        entry.rmsLevel = readings.rmsLevel;
+        entry.peakHold = readings.peakHold;
+        entry.crestFactorDb = readings.crestFactorDb;
+        entry.overs = readings.overs;
+        entry.clips = readings.clips;
+
+        if (offline)
+        {
+            analyseOffline (defIndex, state, channelData, numSamples, blockStart);
+        }
+        else if (multiResolution)
+        {
+            analyseMultiResolution (defIndex, state, channelData, numSamples, blockStart);
+        }
+        else
+        {
+            state.samplesSinceAnalysis = juce::jmin (state.samplesSinceAnalysis + numSamples, std::numeric_limits<int>::max() / 2);
+
+            const auto inRoundRobinWindow = (defIndex - roundRobinCursor + numDefinitions) % numDefinitions < channelsThisBlock;
+
+            if (settings.spectral && state.samplesSinceAnalysis >= hopSamples && inRoundRobinWindow)
+            {
+                const auto frame = analyser.analyse (channelData, numSamples, &state.spectralHistory);
+                state.heldBands = frame.bands;
+                state.samplesSinceAnalysis = 0;
+                keepSpectrum (state, analyser);
+                noteAnalysisFrame (defIndex, state, frame.features, channelData, juce::jmin (numSamples, analyser.size), blockStart);
+            }
+        }
+
+        entry.bands = state.heldBands;
+        entry.spectral = state.features;
+
+        if (speakerDefinitions[(size_t) defIndex].isLfe)
+        {
+            entry.bands.mid = 0.0f;
+            entry.bands.high = 0.0f;
+        }
+    }
+
+    roundRobinCursor = (roundRobinCursor + channelsThisBlock) % numDefinitions;
+    submitDelayPairs();
+    loudnessMeter.process (definitionInputs.data(), numSamples);
+    correlationMatrix.process (definitionInputs.data(), numDefinitions, numSamples);
+
+    correlationMatrix.getCorrelations (result.correlations);
+    result.energyVectors = computeEnergyVectors (metrics);
+}
+
+void AnalysisEngine::updateBandSplit()
+{
+    reducedAnalyser.prepare (currentSampleRate);
+
+    // Averaging each group of decimationFactor samples before keeping one puts the filter's
+    // nulls on the multiples of the decimated rate, which is exactly what would alias onto
+    // the low band.
+    decimationFactor = juce::jmax (1, (int) (currentSampleRate / decimatedRateTarget));
+
+    // The box filter keeps a mean, so the decimated stream has the input's amplitude; its
+    // analyser only needs the lower rate to put its bins on the common density scale.
+    lowResolutionAnalyser.prepare (currentSampleRate / decimationFactor);
+    midResolutionAnalyser.prepare (currentSampleRate);
+    highResolutionAnalyser.prepare (currentSampleRate);
+    offlineAnalyser.prepare (currentSampleRate);
+    offlineAnalyserHighRate.prepare (currentSampleRate);
+
+    meterCoefficients.update (meterBallistics, currentSampleRate);
+}
+
+void AnalysisEngine::resetResolutionWindows (int defIndex, ChannelAnalysisState& state) const noexcept
+{
+    // Each window starts part-filled. Low frames, the most expensive per sample, are spread
+    // across the channels so they fall due on different blocks; mid frames stay aligned
+    // across channels because delay estimation pairs their spectra.
+    const auto numChannels = juce::jmax (1, (int) channelStates.size());
+
+    auto& low = state.resolutionWindows[lowResolution];
+    const auto lowHop = (int) low.samples.size() / 2;
+    low.fill = lowHop + lowHop * defIndex / numChannels;
+
+    auto& mid = state.resolutionWindows[midResolution];
+    mid.fill = (int) mid.samples.size() / 2;
+
+    auto& high = state.resolutionWindows[highResolution];
+    high.fill = (int) high.samples.size() / 2;
+
+    state.decimatorSum = 0.0f;
+    state.decimatorCount = 0;
+}
+
+void AnalysisEngine::analyseMultiResolution (int defIndex, ChannelAnalysisState& state, const float* data, int numSamples, juce::int64 blockStart) noexcept
+{
+    // Slides one window along a stream with 50% overlap; calls onFrame with the window and
+    // the number of input samples consumed when it became full.
+    auto slide = [] (SlidingWindow& window, const float* input, int count, auto&& onFrame)
+    {
+        const auto size = (int) window.samples.size();
+        const auto hop = size / 2;
+        auto* samples = window.samples.data();
+
+        for (int pos = 0; pos < count;)
+        {
+            const auto toCopy = juce::jmin (size - window.fill, count - pos);
+            juce::FloatVectorOperations::copy (samples + window.fill, input + pos, toCopy);
+            window.fill += toCopy;
+            pos += toCopy;
+
+            if (window.fill < size)
+                break;
+
+            onFrame (samples, pos);
+
+            std::copy (samples + hop, samples + size, samples);
+            window.fill = size - hop;
+        }
+    };
+
+    std::array<float, numResolutions> bandSums {};
+    std::array<int, numResolutions> frames {};
+
+    slide (state.resolutionWindows[highResolution], data, numSamples, [&] (const float* window, int consumed)
+    {
+        const auto size = highResolutionAnalyser.size;
+        const auto frame = highResolutionAnalyser.analyse (window, size, &state.spectralHistory);
+        bandSums[highResolution] += frame.bands.high;
+        ++frames[highResolution];
+
+        // The shortest window gives the sharpest onset timing.
+        noteAnalysisFrame (defIndex, state, frame.features, window, size, blockStart + consumed - size);
+    });
+
+    slide (state.resolutionWindows[midResolution], data, numSamples, [&] (const float* window, int)
+    {
+        const auto frame = midResolutionAnalyser.analyse (window, midResolutionAnalyser.size, nullptr);
+        bandSums[midResolution] += frame.bands.mid;
+        ++frames[midResolution];
+        keepSpectrum (state, midResolutionAnalyser);
+    });
+
+    // Box-filter decimation in short chunks, so no per-block scratch allocation is needed.
+    std::array<float, 256> decimated;
+    int numDecimated = 0;
+
+    auto flushDecimated = [&]
+    {
+        slide (state.resolutionWindows[lowResolution], decimated.data(), numDecimated, [&] (const float* window, int)
+        {
+            const auto frame = lowResolutionAnalyser.analyse (window, lowResolutionAnalyser.size, nullptr);
+            bandSums[lowResolution] += frame.bands.low;
+            ++frames[lowResolution];
+        });
+
+        numDecimated = 0;
+    };
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        state.decimatorSum += data[i];
+
+        if (++state.decimatorCount == decimationFactor)
+        {
+            decimated[(size_t) numDecimated++] = state.decimatorSum / (float) decimationFactor;
+            state.decimatorSum = 0.0f;
+            state.decimatorCount = 0;
+
+            if (numDecimated == (int) decimated.size())
+                flushDecimated();
+        }
+    }
+
+    flushDecimated();
+
+    // Bands without a new frame this block keep their previous value.
+    if (frames[lowResolution] > 0)  state.heldBands.low = bandSums[lowResolution] / (float) frames[lowResolution];
+    if (frames[midResolution] > 0)  state.heldBands.mid = bandSums[midResolution] / (float) frames[midResolution];
+    if (frames[highResolution] > 0) state.heldBands.high = bandSums[highResolution] / (float) frames[highResolution];
+}
+
+void AnalysisEngine::analyseOffline (int defIndex, ChannelAnalysisState& state, const float* data, int numSamples, juce::int64 blockStart) noexcept
+{
+    auto& analyser = currentSampleRate > 64000.0 ? offlineAnalyserHighRate : offlineAnalyser;
+    const auto size = analyser.size;
+    const auto hop = size / 2;
+    auto* fifo = state.overlapFifo.data();
+
+    FrequencyBands sum;
+    int frames = 0;
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const auto toCopy = juce::jmin (size - state.fifoFill, numSamples - pos);
+        juce::FloatVectorOperations::copy (fifo + state.fifoFill, data + pos, toCopy);
+        state.fifoFill += toCopy;
+        pos += toCopy;
+
+        if (state.fifoFill < size)
+            break;
+
+        const auto frame = analyser.analyse (fifo, size, &state.spectralHistory);
+        sum.low += frame.bands.low;
+        sum.mid += frame.bands.mid;
+        sum.high += frame.bands.high;
+        ++frames;
+
+        // The frame ends at the sample just copied.
+        noteAnalysisFrame (defIndex, state, frame.features, fifo, size, blockStart + pos - size);
+
+        std::copy (fifo + hop, fifo + size, fifo);
+        state.fifoFill = size - hop;
+    }
+
+    // Blocks shorter than the hop keep the previous frames' bands.
+    if (frames > 0)
+    {
+        state.heldBands = { sum.low / (float) frames, sum.mid / (float) frames, sum.high / (float) frames };
+        keepSpectrum (state, analyser);
+    }
+}
+
+AnalysisEngine::EnergyVectors AnalysisEngine::computeEnergyVectors (const SpeakerMetricsArray& metrics) const noexcept
+{
+    // The band values are RMS spectral densities on a common scale, so their squares
+    // compare as energies across channels.
+    const auto numSpeakers = juce::jmin (metrics.size(), speakerDirections[0].size());
+    const auto* dx = speakerDirections[0].data();
+    const auto* dy = speakerDirections[1].data();
+    const auto* dz = speakerDirections[2].data();
+
+    EnergyVectors result;
+
+    for (size_t band = 0; band < result.size(); ++band)
+    {
+        float sumX = 0.0f, sumY = 0.0f, sumZ = 0.0f, total = 0.0f;
+
+        for (size_t i = 0; i < numSpeakers; ++i)
+        {
+            const auto& bands = metrics[i].bands;
+            const auto amplitude = band == 0 ? bands.low : (band == 1 ? bands.mid : bands.high);
+            const auto energy = amplitude * amplitude * (dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+
+            sumX += dx[i] * energy;
+            sumY += dy[i] * energy;
+            sumZ += dz[i] * energy;
+            total += energy;
+        }
+
+        auto& vector = result[band];
+        vector.energy = total;
+
+        if (total <= 1.0e-12f)
+            continue;
+
+        const SpatialVector mean { sumX / total, sumY / total, sumZ / total };
+        vector.magnitude = juce::jlimit (0.0f, 1.0f, mean.length());
+        vector.direction = vector.magnitude > 1.0e-6f ? mean / mean.length() : SpatialVector {};
+        vector.spreadDegrees = juce::radiansToDegrees (std::acos (vector.magnitude));
+    }
+
+    return result;
+}
+
+void AnalysisEngine::noteAnalysisFrame (int defIndex, ChannelAnalysisState& state, const SpectralFeatures& features,
+                                                const float* frame, int frameLength, juce::int64 frameStart) noexcept
+{
+    state.features = features;
+
+    const auto strength = state.onsetDetector.process (features.flux, frameStart);
+    if (strength <= 0.0f)
+        return;
+
+    // The flux only says which frame holds the attack; place it on the first sample that
+    // reaches half the frame's peak.
+    const auto range = juce::FloatVectorOperations::findMinAndMax (frame, frameLength);
+    const auto halfPeak = 0.5f * juce::jmax (std::abs (range.getStart()), std::abs (range.getEnd()));
+
+    int attack = 0;
+    while (attack < frameLength - 1 && std::abs (frame[attack]) < halfPeak)
+        ++attack;
+
+    onsetEvents.push ({ defIndex, frameStart + attack, strength });
+}
+
+void AnalysisEngine::keepSpectrum (ChannelAnalysisState& state, const BandAnalyser& analyser) noexcept
+{
+    juce::FloatVectorOperations::copy (state.spectrum.data(), analyser.buffer.get(), analyser.size + 2);
+    state.spectrumOrder = analyser.order;
+    state.spectrumFresh = true;
+}
+
+void AnalysisEngine::submitDelayPairs() noexcept
+{
+    // Only pairs whose channels were both transformed this block share a time window;
+    // round-robin and hop tiers therefore feed the estimator less often.
+    for (size_t i = 0; i < delayPairs.size(); ++i)
+    {
+        const auto& first = channelStates[(size_t) delayPairs[i].first];
+        const auto& second = channelStates[(size_t) delayPairs[i].second];
+
+        if (first.spectrumFresh && second.spectrumFresh && first.spectrumOrder == second.spectrumOrder)
+            delayEstimator.submit ((int) i, first.spectrum.data(), second.spectrum.data(), first.spectrumOrder);
+    }
+}
+
+AnalysisEngine::BandAnalyser::BandAnalyser (int orderToUse)
+    : order (orderToUse),
+      size (1 << orderToUse),
+      fft (orderToUse),
+      window ((size_t) size, juce::dsp::WindowingFunction<float>::hann)
+{
+    buffer.allocate (2 * size, true);
+
+    auto* table = buffer.get();
+    std::fill (table, table + size, 1.0f);
+    window.multiplyWithWindowingTable (table, (size_t) size);
+
+    windowPower = 0.0;
+    for (int i = 0; i < size; ++i)
+        windowPower += (double) table[i] * table[i];
+}
+
+void AnalysisEngine::BandAnalyser::prepare (double sampleRate)
+{
+    // A bin's power is the density times the window power times the sample rate over two,
+    // so this factor carries a mean bin power over to the reference transform's.
+    constexpr double referenceWindowPower = 1.5 * fftSize;   // unit-mean Hann
+    constexpr double referenceSampleRate = 48000.0;
+    densityScale = (float) ((referenceWindowPower * referenceSampleRate) / (windowPower * sampleRate));
+
+    hzPerBin = (float) sampleRate / (float) size;
+    lowBandLimit = juce::jlimit (1, size / 2, (int) std::ceil (200.0f / hzPerBin));
+    midBandLimit = juce::jlimit (lowBandLimit + 1, size / 2, (int) std::ceil (2000.0f / hzPerBin));
+}
+
+AnalysisEngine::AnalysisFrame AnalysisEngine::BandAnalyser::analyse (const float* data, int numSamples, SpectralHistory* history) noexcept
+{
+    AnalysisFrame frame;
+    auto& bands = frame.bands;
+    auto* fftData = buffer.get();
+
+    const auto copyCount = std::min (size, numSamples);
+    juce::FloatVectorOperations::copy (fftData, data, copyCount);
+    if (copyCount < size)
+        juce::FloatVectorOperations::clear (fftData + copyCount, size - copyCount);
+    juce::FloatVectorOperations::clear (fftData + size, size);
+
+    window.multiplyWithWindowingTable (fftData, (size_t) size);
+    // The complex spectrum stays in the buffer for delay estimation; magnitudes are taken
+    // on the fly rather than with the frequency-only transform, which would overwrite it.
+    fft.performRealOnlyForwardTransform (fftData, true);
+
+    const auto nyquist = size / 2;
+    const auto wantFeatures = history != nullptr;
+    const auto hasPrevious = wantFeatures && history->order == order;
+    auto* previous = wantFeatures ? history->magnitudes.data() : nullptr;
+
+    // One pass over the bins feeds the bands and every feature sum; the magnitudes replace
+    // the previous frame's in the history as they are read.
+    float magnitudeSum = 0.0f, weightedBinSum = 0.0f, powerSum = 0.0f, logPowerSum = 0.0f, rise = 0.0f;
+
+    for (int bin = 1; bin < nyquist; ++bin)
+    {
+        const auto re = fftData[2 * bin];
+        const auto im = fftData[2 * bin + 1];
+        const auto power = re * re + im * im;
+        const auto magnitude = std::sqrt (power);
+
+        if (bin < lowBandLimit)      bands.low += power;
+        else if (bin < midBandLimit) bands.mid += power;
+        else                         bands.high += power;
+
+        if (! wantFeatures)
+            continue;
+
+        magnitudeSum += magnitude;
+        weightedBinSum += magnitude * (float) bin;
+        powerSum += power;
+        logPowerSum += std::log (power + 1.0e-12f);
+
+        if (hasPrevious)
+            rise += juce::jmax (0.0f, magnitude - previous[bin]);
+
+        previous[bin] = magnitude;
+    }
+
+    auto& features = frame.features;
+    const auto numBins = (float) (nyquist - 1);
+
+    if (wantFeatures)
+        history->order = order;
+
+    if (wantFeatures && magnitudeSum > 1.0e-9f)
+    {
+        features.centroidHz = weightedBinSum / magnitudeSum * hzPerBin;
+        features.flatness = juce::jlimit (0.0f, 1.0f, std::exp (logPowerSum / numBins) / (powerSum / numBins));
+        features.flux = juce::jlimit (0.0f, 1.0f, rise / magnitudeSum);
+
+        const auto rolloffTarget = 0.85f * powerSum;
+        auto cumulative = 0.0f;
+        auto rolloffBin = nyquist - 1;
+
+        for (int bin = 1; bin < nyquist; ++bin)
+        {
+            cumulative += previous[bin] * previous[bin];
+            if (cumulative >= rolloffTarget)
+            {
+                rolloffBin = bin;
+                break;
+            }
+        }
+
+        features.rolloffHz = (float) rolloffBin * hzPerBin;
+    }
+
+    // Mean power per bin is the density up to densityScale, whose square root then reads
+    // alike for every size and rate.
+    const auto lowNorm = std::max (1, lowBandLimit - 1);
+    const auto midNorm = std::max (1, midBandLimit - lowBandLimit);
+    const auto highNorm = std::max (1, nyquist - midBandLimit);
+
+    bands.low = std::sqrt (bands.low * densityScale / (float) lowNorm);
+    bands.mid = std::sqrt (bands.mid * densityScale / (float) midNorm);
+    bands.high = std::sqrt (bands.high * densityScale / (float) highNorm);
+
+    return frame;
+}
+
+juce::AudioChannelSet AnalysisEngine::getDefaultLayoutForChannelCount (int numChannels)
+{
+    switch (numChannels)
+    {
+        case 1:  return juce::AudioChannelSet::mono();
+        case 2:  return juce::AudioChannelSet::stereo();
+        case 6:  return juce::AudioChannelSet::create5point1();
+        case 8:  return juce::AudioChannelSet::create7point1();
+        case 10: return juce::AudioChannelSet::create7point1point2();
+        case 12: return juce::AudioChannelSet::create7point1point4();
+        case 14: return juce::AudioChannelSet::create9point1point4();
+        case 16: return juce::AudioChannelSet::create9point1point6();
+        default: return {};
+    }
+}
+
+AnalysisEngine::SpeakerDefinitions AnalysisEngine::buildSpeakerDefinitions (const juce::AudioChannelSet& layout)
+{
+    SpeakerDefinitions defs;
+    defs.reserve (layout.size());
+
+    auto findSeed = [] (juce::AudioChannelSet::ChannelType type) -> const SpeakerSeed*
+    {
+        for (const auto& seed : speakerSeedTable)
+        {
+            if (seed.type == type)
+                return &seed;
+        }
+
+        return nullptr;
+    };
+
+    juce::StringArray usedIds;
+
+    for (int channelIndex = 0; channelIndex < layout.size(); ++channelIndex)
+    {
+        const auto channelType = layout.getTypeOfChannel (channelIndex);
+        const auto* seed = findSeed (channelType);
+
+        float azimuth = seed != nullptr ? seed->azimuthDegrees : 0.0f;
+        float elevation = seed != nullptr ? seed->elevationDegrees : 0.0f;
+        const bool isLfe = seed != nullptr ? seed->isLfe : (channelType == juce::AudioChannelSet::LFE);
+
+        const auto unit = unitVectorFromAngles (azimuth, elevation);
+        const auto position = mapUnitToRoom (unit, defaultRoom, isLfe);
+
+        auto aim = -position;
+        const auto aimLength = aim.length();
+        if (aimLength > 1.0e-4f)
+            aim /= aimLength;
+        else
+            aim = { -1.0f, 0.0f, 0.0f };
+
+        juce::String id = seed != nullptr ? seed->id : juce::AudioChannelSet::getAbbreviatedChannelTypeName (channelType);
+        if (id.isEmpty())
+            id = juce::String (channelIndex + 1);
+
+        if (usedIds.contains (id))
+            id += '_' + juce::String (channelIndex + 1);
+        usedIds.add (id);
+        juce::String displayName = seed != nullptr ? seed->displayName : juce::AudioChannelSet::getChannelTypeName (channelType);
+
+        defs.push_back ({
+            id,
+            displayName,
+            azimuth,
+            elevation,
+            position.length(),
+            isLfe,
+            position,
+            aim,
+            channelType
+        });
+    }
+
+    return defs;
+}
+
+void AnalysisEngine::setLayout (const juce::AudioChannelSet& layout)
+{
+    channelLayout = layout.size() > 0 ? layout : juce::AudioChannelSet::create7point1point4();
+    auto defs = buildSpeakerDefinitions (channelLayout);
+
+    channelStates.resize (defs.size());
+    for (auto& state : channelStates)
+    {
+        state = {};
+        state.samplesSinceAnalysis = std::numeric_limits<int>::max() / 2;
+        state.overlapFifo.assign ((size_t) (1 << offlineFftOrderHighRate), 0.0f);
+        state.spectrum.assign ((size_t) (1 << offlineFftOrderHighRate) + 2, 0.0f);
+        state.spectralHistory.magnitudes.assign ((size_t) (1 << offlineFftOrderHighRate) / 2 + 1, 0.0f);
+        state.onsetDetector.prepare (currentSampleRate);
+        state.resolutionWindows[lowResolution].samples.assign ((size_t) (1 << lowResolutionOrder), 0.0f);
+        state.resolutionWindows[midResolution].samples.assign ((size_t) (1 << midResolutionOrder), 0.0f);
+        state.resolutionWindows[highResolution].samples.assign ((size_t) (1 << highResolutionOrder), 0.0f);
+    }
+
+    for (size_t i = 0; i < channelStates.size(); ++i)
+        resetResolutionWindows ((int) i, channelStates[i]);
+    roundRobinCursor = 0;
+
+    for (auto& axis : speakerDirections)
+        axis.assign (defs.size(), 0.0f);
+
+    for (size_t i = 0; i < defs.size(); ++i)
+    {
+        const auto length = defs[i].position.length();
+        if (defs[i].isLfe || length < 1.0e-4f)
+            continue;
+
+        speakerDirections[0][i] = defs[i].position.x / length;
+        speakerDirections[1][i] = defs[i].position.y / length;
+        speakerDirections[2][i] = defs[i].position.z / length;
+    }
+
+    delayPairs = buildDelayPairs (defs);
+    delayEstimator.setPairs (delayPairs);
+
+    std::array<float, LoudnessMeter::maxChannels> loudnessWeights {};
+    for (size_t i = 0; i < defs.size() && i < loudnessWeights.size(); ++i)
+        loudnessWeights[i] = LoudnessMeter::channelWeightFor (defs[i].azimuthDegrees, defs[i].elevationDegrees, defs[i].isLfe);
+    loudnessMeter.setChannelWeights (loudnessWeights.data(), (int) juce::jmin (defs.size(), loudnessWeights.size()));
+
+    speakerDefinitions = std::move (defs);
+}
+
+int AnalysisEngine::findDefinitionIndexForChannel (juce::AudioChannelSet::ChannelType type) const noexcept
+{
+    for (size_t i = 0; i < speakerDefinitions.size(); ++i)
+    {
+        if (speakerDefinitions[i].channelType == type)
+            return static_cast<int> (i);
+    }
+
+    return -1;
+}
+
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "AnalysisGovernor.h"
+#include "ChannelMeter.h"
+#include "CorrelationMatrix.h"
+#include "DelayEstimator.h"
+#include "LoudnessMeter.h"
+#include "SpatialVector.h"
+#include "SpectralFeatures.h"
+
+// The analysis behind the display, with no dependency on the plugin or GUI modules: speaker
+// layout, per-channel meters and band analysis, loudness, correlation, delay estimation,
+// energy vectors and onsets. The plugin runs it on the audio thread; the batch analyser runs
+// one per file, as fast as the file can be read.
+class AnalysisEngine
+{
+public:
+    static constexpr int fftOrder = 9;
+    static constexpr int fftSize = 1 << fftOrder;
+
+    // Offline renders have no deadline, so they use a longer transform with 50% overlap
+    // across the whole block; the larger order is for sample rates above 64 kHz.
+    static constexpr int offlineFftOrder = 11;
+    static constexpr int offlineFftOrderHighRate = 12;
+
+    // Realtime Full tier: each band comes from the transform that suits it. Lows use a
+    // 1024-point window on a stream decimated to ~12 kHz (about 85 ms, like 4096 points at
+    // 48 kHz), mids 1024 points and highs 256 points at the full rate, all with 50% overlap.
+    // Each analyser is prepared at the rate it actually sees, the decimated one included, so
+    // its bands come out as densities on the same scale as the other tiers'.
+    static constexpr int lowResolutionOrder = 10;
+    static constexpr int midResolutionOrder = 10;
+    static constexpr int highResolutionOrder = 8;
+    static constexpr double decimatedRateTarget = 12000.0;
+
+    struct FrequencyBands
+    {
+        float low{ 0.0f };
+        float mid{ 0.0f };
+        float high{ 0.0f };
+    };
+
+    struct SpeakerDefinition
+    {
+        juce::String id;
+        juce::String displayName;
+        float azimuthDegrees;
+        float elevationDegrees;
+        float radius;
+        bool isLfe;
+        SpatialVector position;
+        SpatialVector aimDirection;
+        juce::AudioChannelSet::ChannelType channelType{};
+    };
+
+    struct SpeakerMetrics
+    {
+        float rms{ 0.0f };
+        float peak{ 0.0f };
+        float truePeak{ 0.0f };       // BS.1770 4x oversampled; the sample peak on blocks below -6 dBFS
+        float level{ 0.0f };          // ballistic peak envelope
+        float rmsLevel{ 0.0f };       // ballistic RMS
+        float peakHold{ 0.0f };
+        float crestFactorDb{ 0.0f };
+        std::uint32_t overs{ 0 };     // samples beyond full scale since the last counter reset
+        std::uint32_t clips{ 0 };     // runs of full-scale samples since the last counter reset
+        FrequencyBands bands{};
+        SpectralFeatures spectral{};
+    };
+
+    // Gerzon energy vector of one band: the energy-weighted mean of the speaker directions
+    // as seen from the listening position.
+    struct EnergyVector
+    {
+        SpatialVector direction;           // unit vector, zero when the band is silent
+        float magnitude{ 0.0f };           // rE: 1 = a single speaker, towards 0 = diffuse
+        float spreadDegrees{ 0.0f };       // perceived half-width, acos (rE)
+        float energy{ 0.0f };
+    };
+
+    using EnergyVectors = std::array<EnergyVector, 3>;   // low, mid, high
+
+    struct RoomDimensions
+    {
+        float width;
+        float height;
+        float depth;
+        float earHeight;
+    };
+
+    using SpeakerDefinitions = std::vector<SpeakerDefinition>;
+    using SpeakerMetricsArray = std::vector<SpeakerMetrics>;
+
+    // Everything one block produces, in speaker definition order.
+    struct BlockResult
+    {
+        SpeakerMetricsArray metrics;
+        CorrelationMatrix::Values correlations {};
+        EnergyVectors energyVectors {};
+    };
+
+    static const RoomDimensions defaultRoom;
+
+    AnalysisEngine();
+
+    /** Allocates. An empty layout falls back to 7.1.4. */
+    void prepare (double sampleRate, const juce::AudioChannelSet& layout);
+    void release();
+
+    /** Allocates; resets the per-channel state. */
+    void setLayout (const juce::AudioChannelSet& layout);
+    const juce::AudioChannelSet& getLayout() const noexcept          { return channelLayout; }
+    const SpeakerDefinitions& getSpeakerDefinitions() const noexcept { return speakerDefinitions; }
+
+    double getSampleRate() const noexcept                { return currentSampleRate; }
+    juce::int64 getSamplesProcessed() const noexcept     { return samplesProcessed; }
+
+    /** Analyses one block whose channels are in layout order. Offline blocks get the long
+        overlapped transform on every channel; realtime blocks follow the tier. The metrics
+        are resized to the number of speakers, which only allocates after a layout change. */
+    void process (const juce::AudioBuffer<float>& buffer, bool offline, AnalysisGovernor::Tier tier, BlockResult& result) noexcept;
+
+    /** Same thread as process(). */
+    void setMeterBallistics (const MeterBallistics& newBallistics) noexcept;
+    void resetMeterCounters() noexcept;
+
+    LoudnessMeter& getLoudnessMeter() noexcept                       { return loudnessMeter; }
+    const LoudnessMeter& getLoudnessMeter() const noexcept           { return loudnessMeter; }
+    const DelayEstimator& getDelayEstimator() const noexcept         { return delayEstimator; }
+
+    /** Single consumer: takes the oldest queued onset, if any. */
+    bool popOnsetEvent (OnsetEvent& event) noexcept                  { return onsetEvents.pop (event); }
+
+    static SpeakerDefinitions buildSpeakerDefinitions (const juce::AudioChannelSet& layout);
+
+    /** The layout assumed for a file whose channels are not labelled (or are labelled only
+        partly, as WAV channel masks cannot name wide or top-side speakers). Empty for
+        counts no supported layout has. */
+    static juce::AudioChannelSet getDefaultLayoutForChannelCount (int numChannels);
+
+private:
+    // One FFT size with its window, scratch buffer and band split. After analyse() the
+    // buffer holds the complex spectrum (size / 2 + 1 interleaved bins) of that frame.
+    //
+    // A band reads as the RMS of its power spectral density, so the same signal gives the
+    // same value whatever the transform length, window and sample rate: a tone's power is
+    // spread over its bins and noise over the band's width in Hz alike. The unit is the RMS
+    // bin magnitude of a fftSize-point unit-mean Hann transform at 48 kHz.
+    struct AnalysisFrame
+    {
+        FrequencyBands bands;
+        SpectralFeatures features;
+    };
+
+    struct BandAnalyser
+    {
+        explicit BandAnalyser (int order);
+
+        void prepare (double sampleRate);
+        /** Features (and the flux history) are only computed when a history is given. */
+        AnalysisFrame analyse (const float* data, int numSamples, SpectralHistory* history) noexcept;
+
+        const int order;
+        const int size;
+        juce::dsp::FFT fft;
+        juce::dsp::WindowingFunction<float> window;
+        juce::HeapBlock<float> buffer;
+        double windowPower = 1.0;   // sum of the squared window
+        int lowBandLimit = 1;
+        int midBandLimit = 2;
+        float hzPerBin = 1.0f;
+        float densityScale = 1.0f;  // mean bin power to the reference unit
+    };
+
+    enum Resolution { lowResolution, midResolution, highResolution, numResolutions };
+
+    // Samples collected towards one resolution's next frame.
+    struct SlidingWindow
+    {
+        std::vector<float> samples;
+        int fill = 0;
+    };
+
+    // Per speaker definition.
+    struct ChannelAnalysisState
+    {
+        FrequencyBands heldBands;      // from the channel's last FFT, reused by skipped blocks
+        int samplesSinceAnalysis = 0;
+        std::vector<float> overlapFifo;
+        int fifoFill = 0;
+        ChannelMeter meter;
+        std::vector<float> spectrum;   // last analysed frame, kept for delay estimation
+        int spectrumOrder = 0;
+        bool spectrumFresh = false;    // analysed during the current block
+        SpectralHistory spectralHistory;
+        SpectralFeatures features;     // from the last analysed frame
+        OnsetDetector onsetDetector;
+        std::array<SlidingWindow, numResolutions> resolutionWindows;
+        float decimatorSum = 0.0f;
+        int decimatorCount = 0;
+    };
+
+    void updateBandSplit();
+    void analyseMultiResolution (int defIndex, ChannelAnalysisState& state, const float* data, int numSamples, juce::int64 blockStart) noexcept;
+    void resetResolutionWindows (int defIndex, ChannelAnalysisState& state) const noexcept;
+    void analyseOffline (int defIndex, ChannelAnalysisState& state, const float* data, int numSamples, juce::int64 blockStart) noexcept;
+    void noteAnalysisFrame (int defIndex, ChannelAnalysisState& state, const SpectralFeatures& features,
+                            const float* frame, int frameLength, juce::int64 frameStart) noexcept;
+    void keepSpectrum (ChannelAnalysisState& state, const BandAnalyser& analyser) noexcept;
+    void submitDelayPairs() noexcept;
+    EnergyVectors computeEnergyVectors (const SpeakerMetricsArray& metrics) const noexcept;
+    int findDefinitionIndexForChannel (juce::AudioChannelSet::ChannelType type) const noexcept;
+
+    juce::AudioChannelSet channelLayout;
+    SpeakerDefinitions speakerDefinitions;
+    LoudnessMeter loudnessMeter;
+    CorrelationMatrix correlationMatrix;
+    DelayEstimator delayEstimator;
+    std::vector<DelayEstimator::Pair> delayPairs;
+
+    // Unit speaker directions from the listener, one row per axis so the energy vector sums
+    // run down contiguous arrays. LFE rows are zero.
+    std::array<std::vector<float>, 3> speakerDirections;
+
+    BandAnalyser reducedAnalyser{ fftOrder - 1 };
+    BandAnalyser lowResolutionAnalyser{ lowResolutionOrder };
+    BandAnalyser midResolutionAnalyser{ midResolutionOrder };
+    BandAnalyser highResolutionAnalyser{ highResolutionOrder };
+    int decimationFactor = 4;
+    bool multiResolutionActive = false;
+    BandAnalyser offlineAnalyser{ offlineFftOrder };
+    BandAnalyser offlineAnalyserHighRate{ offlineFftOrderHighRate };
+
+    std::vector<ChannelAnalysisState> channelStates;
+    OnsetEventQueue onsetEvents;
+    juce::int64 samplesProcessed = 0;
+    int roundRobinCursor = 0;
+    bool wasRenderingOffline = false;
+
+    double currentSampleRate = 48000.0;
+    MeterBallistics meterBallistics;
+    ChannelMeter::Coefficients meterCoefficients;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisEngine)
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+
+// Steps the spectral analysis down when the audio thread runs close to its block deadline,
+// and back up once there is headroom again. Each tier keeps the savings of the tiers before
+// it: a smaller FFT, then a longer hop between FFTs, then spreading channels round-robin
+// across blocks, and finally RMS/peak only with the last band split held.
+// update() runs on the audio thread; getTier() may be called from any thread.
+class AnalysisGovernor
+{
+public:
+    enum class Tier
+    {
+        Full,
+        ReducedFft,
+        LongHop,
+        RoundRobin,
+        LevelsOnly
+    };
+
+    static constexpr int numTiers = 5;
+
+    struct Settings
+    {
+        int fftOrderReduction;   // octaves below the full FFT size
+        double hopSeconds;       // minimum time between FFTs of one channel; 0 = every block
+        int roundRobinDivisor;   // 1 = every channel per block, N = roughly 1/N of them
+        bool spectral;           // false = levels only, bands held
+    };
+
+    static Settings getSettings (Tier tier) noexcept
+    {
+        switch (tier)
+        {
+            case Tier::Full:        return { 0, 0.0,   1, true };
+            case Tier::ReducedFft:  return { 1, 0.0,   1, true };
+            case Tier::LongHop:     return { 1, 0.04,  1, true };
+            case Tier::RoundRobin:  return { 1, 0.04,  4, true };
+            case Tier::LevelsOnly:  return { 1, 0.04,  4, false };
+        }
+
+        return { 0, 0.0, 1, true };
+    }
+
+    static const char* getTierDescription (Tier tier) noexcept
+    {
+        switch (tier)
+        {
+            case Tier::Full:        return "Full";
+            case Tier::ReducedFft:  return "Reduced FFT";
+            case Tier::LongHop:     return "Reduced FFT, long hop";
+            case Tier::RoundRobin:  return "Round-robin channels";
+            case Tier::LevelsOnly:  return "Levels only, bands held";
+        }
+
+        return "";
+    }
+
+    /** Feeds the load (elapsed / budget) of the previous block; returns the tier for this one. */
+    Tier update (float load, double blockSeconds) noexcept
+    {
+        auto current = (int) tier.load (std::memory_order_relaxed);
+
+        if (blockSeconds <= 0.0)
+            return (Tier) current;
+
+        // Rise quickly so a burst of slow blocks is caught, fall slowly so one quiet block
+        // does not look like headroom.
+        const auto timeConstant = load > smoothedLoad ? attackSeconds : releaseSeconds;
+        smoothedLoad += (load - smoothedLoad) * (float) (1.0 - std::exp (-blockSeconds / timeConstant));
+
+        secondsSinceChange += blockSeconds;
+        secondsOverLimit  = smoothedLoad > degradeLoad ? secondsOverLimit + blockSeconds : 0.0;
+        secondsUnderLimit = smoothedLoad < restoreLoad ? secondsUnderLimit + blockSeconds : 0.0;
+
+        if (secondsOverLimit >= degradeDwellSeconds && current < numTiers - 1)
+        {
+            // Restoring a tier that immediately proved too expensive: wait longer next time.
+            if (lastChangeWasRestore && secondsSinceChange < quickRelapseSeconds)
+                restoreDwellSeconds = juce::jmin (restoreDwellSeconds * 2.0, maxRestoreDwellSeconds);
+
+            setTier (++current, false);
+        }
+        else if (secondsUnderLimit >= restoreDwellSeconds && current > 0)
+        {
+            setTier (--current, true);
+        }
+        else if (secondsSinceChange > 4.0 * maxRestoreDwellSeconds)
+        {
+            restoreDwellSeconds = baseRestoreDwellSeconds;
+        }
+
+        return (Tier) current;
+    }
+
+    Tier getTier() const noexcept   { return (Tier) tier.load (std::memory_order_relaxed); }
+
+    /** Returns to full quality; call from prepareToPlay, not concurrently with update(). */
+    void reset() noexcept
+    {
+        smoothedLoad = 0.0f;
+        secondsOverLimit = secondsUnderLimit = 0.0;
+        secondsSinceChange = 0.0;
+        restoreDwellSeconds = baseRestoreDwellSeconds;
+        lastChangeWasRestore = false;
+        tier.store ((int) Tier::Full, std::memory_order_relaxed);
+    }
+
+private:
+    void setTier (int newTier, bool isRestore) noexcept
+    {
+        tier.store (newTier, std::memory_order_relaxed);
+        secondsOverLimit = secondsUnderLimit = 0.0;
+        secondsSinceChange = 0.0;
+        lastChangeWasRestore = isRestore;
+    }
+
+    static constexpr float degradeLoad = 0.7f;
+    static constexpr float restoreLoad = 0.35f;
+    static constexpr double attackSeconds = 0.01;
+    static constexpr double releaseSeconds = 0.25;
+    static constexpr double degradeDwellSeconds = 0.05;
+    static constexpr double baseRestoreDwellSeconds = 2.0;
+    static constexpr double maxRestoreDwellSeconds = 30.0;
+    static constexpr double quickRelapseSeconds = 5.0;
+
+    float smoothedLoad = 0.0f;
+    double secondsOverLimit = 0.0;
+    double secondsUnderLimit = 0.0;
+    double secondsSinceChange = 0.0;
+    double restoreDwellSeconds = baseRestoreDwellSeconds;
+    bool lastChangeWasRestore = false;
+
+    std::atomic<int> tier { (int) Tier::Full };
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// processBlock wall time measured against the block deadline (numSamples / sampleRate),
+// plus the time the audio thread spends waiting on the metrics lock.
+// The audio thread is the only writer. Everything is a relaxed atomic, so readers on
+// other threads never block it; a snapshot may straddle a block, which is fine for stats.
+class BlockTimingStats
+{
+public:
+    // Load buckets are 2% of the budget wide; the last one collects everything from 200% up.
+    static constexpr int numLoadBuckets = 101;
+    static constexpr float loadBucketWidth = 0.02f;
+
+    struct Snapshot
+    {
+        std::uint64_t totalBlocks = 0;
+        std::uint64_t blocksOverHalfBudget = 0;
+        std::uint64_t blocksOver80Percent = 0;
+        std::uint64_t blocksOverBudget = 0;
+        float p50Load = 0.0f;
+        float p95Load = 0.0f;
+        float p99Load = 0.0f;
+        float maxLoad = 0.0f;
+        double lastBudgetMs = 0.0;
+
+        std::uint64_t lockAcquisitions = 0;
+        std::uint64_t contendedLockWaits = 0;
+        double meanLockWaitUs = 0.0;
+        double maxLockWaitUs = 0.0;
+    };
+
+    /** Records the enclosing processBlock call when it goes out of scope. */
+    class ScopedBlockTimer
+    {
+    public:
+        ScopedBlockTimer (BlockTimingStats& s, int numSamplesIn, double sampleRateIn) noexcept
+            : stats (s), numSamples (numSamplesIn), sampleRate (sampleRateIn),
+              start (juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlockTimer()
+        {
+            stats.recordBlock (juce::Time::getHighResolutionTicks() - start, numSamples, sampleRate);
+        }
+
+    private:
+        BlockTimingStats& stats;
+        int numSamples;
+        double sampleRate;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlockTimer)
+    };
+
+    void recordBlock (juce::int64 elapsedTicks, int numSamples, double sampleRate) noexcept
+    {
+        if (resetRequested.exchange (false, std::memory_order_acquire))
+            clear();
+
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        const auto budgetSeconds = (double) numSamples / sampleRate;
+        const auto load = (float) (juce::Time::highResolutionTicksToSeconds (elapsedTicks) / budgetSeconds);
+        const auto bucket = juce::jlimit (0, numLoadBuckets - 1, (int) (load / loadBucketWidth));
+
+        increment (loadBuckets[(size_t) bucket]);
+        increment (totalBlocks);
+
+        if (load > 0.5f) increment (blocksOverHalfBudget);
+        if (load > 0.8f) increment (blocksOver80Percent);
+        if (load > 1.0f) increment (blocksOverBudget);
+
+        if (load > maxLoad.load (std::memory_order_relaxed))
+            maxLoad.store (load, std::memory_order_relaxed);
+
+        lastBudgetMs.store (budgetSeconds * 1000.0, std::memory_order_relaxed);
+        lastLoad.store (load, std::memory_order_relaxed);
+    }
+
+    void recordLockWait (juce::int64 waitedTicks) noexcept
+    {
+        increment (lockAcquisitions);
+        lockWaitTicks.store (lockWaitTicks.load (std::memory_order_relaxed) + waitedTicks, std::memory_order_relaxed);
+
+        if (waitedTicks > maxLockWaitTicks.load (std::memory_order_relaxed))
+            maxLockWaitTicks.store (waitedTicks, std::memory_order_relaxed);
+
+        // Anything beyond a few microseconds means the message thread was holding the lock.
+        if (juce::Time::highResolutionTicksToSeconds (waitedTicks) > 5.0e-6)
+            increment (contendedLockWaits);
+    }
+
+    /** Load of the most recent block as a fraction of its budget. */
+    float getLastLoad() const noexcept  { return lastLoad.load (std::memory_order_relaxed); }
+
+    /** Asks the audio thread to clear the statistics at the start of its next block. */
+    void requestReset() noexcept    { resetRequested.store (true, std::memory_order_release); }
+
+    Snapshot getSnapshot() const noexcept
+    {
+        Snapshot snapshot;
+        snapshot.totalBlocks          = totalBlocks.load (std::memory_order_relaxed);
+        snapshot.blocksOverHalfBudget = blocksOverHalfBudget.load (std::memory_order_relaxed);
+        snapshot.blocksOver80Percent  = blocksOver80Percent.load (std::memory_order_relaxed);
+        snapshot.blocksOverBudget     = blocksOverBudget.load (std::memory_order_relaxed);
+        snapshot.maxLoad              = maxLoad.load (std::memory_order_relaxed);
+        snapshot.lastBudgetMs         = lastBudgetMs.load (std::memory_order_relaxed);
+
+        std::array<std::uint32_t, numLoadBuckets> counts;
+        std::uint64_t counted = 0;
+        for (size_t i = 0; i < counts.size(); ++i)
+        {
+            counts[i] = loadBuckets[i].load (std::memory_order_relaxed);
+            counted += counts[i];
+        }
+
+        auto percentile = [&] (double p)
+        {
+            if (counted == 0)
+                return 0.0f;
+
+            const auto target = juce::jmax ((std::uint64_t) 1, (std::uint64_t) std::ceil (p * (double) counted));
+            std::uint64_t seen = 0;
+
+            for (size_t i = 0; i < counts.size(); ++i)
+            {
+                seen += counts[i];
+                if (seen >= target)
+                    return ((float) i + 0.5f) * loadBucketWidth;
+            }
+
+            return (float) numLoadBuckets * loadBucketWidth;
+        };
+
+        snapshot.p50Load = percentile (0.5);
+        snapshot.p95Load = percentile (0.95);
+        snapshot.p99Load = percentile (0.99);
+
+        snapshot.lockAcquisitions   = lockAcquisitions.load (std::memory_order_relaxed);
+        snapshot.contendedLockWaits = contendedLockWaits.load (std::memory_order_relaxed);
+        snapshot.maxLockWaitUs      = 1.0e6 * juce::Time::highResolutionTicksToSeconds (maxLockWaitTicks.load (std::memory_order_relaxed));
+
+        if (snapshot.lockAcquisitions > 0)
+            snapshot.meanLockWaitUs = 1.0e6 * juce::Time::highResolutionTicksToSeconds (lockWaitTicks.load (std::memory_order_relaxed))
+                                        / (double) snapshot.lockAcquisitions;
+
+        return snapshot;
+    }
+
+private:
+    template <typename Counter>
+    static void increment (std::atomic<Counter>& counter) noexcept
+    {
+        // Single writer, so a plain load/store pair avoids a locked read-modify-write.
+        counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept
+    {
+        for (auto& bucket : loadBuckets)
+            bucket.store (0, std::memory_order_relaxed);
+
+        totalBlocks.store (0, std::memory_order_relaxed);
+        blocksOverHalfBudget.store (0, std::memory_order_relaxed);
+        blocksOver80Percent.store (0, std::memory_order_relaxed);
+        blocksOverBudget.store (0, std::memory_order_relaxed);
+        maxLoad.store (0.0f, std::memory_order_relaxed);
+        lockAcquisitions.store (0, std::memory_order_relaxed);
+        contendedLockWaits.store (0, std::memory_order_relaxed);
+        lockWaitTicks.store (0, std::memory_order_relaxed);
+        maxLockWaitTicks.store (0, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint32_t>, numLoadBuckets> loadBuckets {};
+    std::atomic<std::uint64_t> totalBlocks { 0 };
+    std::atomic<std::uint64_t> blocksOverHalfBudget { 0 };
+    std::atomic<std::uint64_t> blocksOver80Percent { 0 };
+    std::atomic<std::uint64_t> blocksOverBudget { 0 };
+    std::atomic<float> maxLoad { 0.0f };
+    std::atomic<double> lastBudgetMs { 0.0 };
+    std::atomic<float> lastLoad { 0.0f };
+
+    std::atomic<std::uint64_t> lockAcquisitions { 0 };
+    std::atomic<std::uint64_t> contendedLockWaits { 0 };
+    std::atomic<juce::int64> lockWaitTicks { 0 };
+    std::atomic<juce::int64> maxLockWaitTicks { 0 };
+
+    std::atomic<bool> resetRequested { false };
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstdint>
+
+#include "TruePeakDetector.h"
+
+// Meter time constants. Attack and release are one-pole time constants in seconds
+// (0 = instant); the peak hold keeps the highest true peak for holdSeconds, then falls
+// at holdDecayDbPerSecond.
+struct MeterBallistics
+{
+    float attackSeconds = 0.005f;
+    float releaseSeconds = 0.65f;
+    float rmsIntegrationSeconds = 0.3f;
+    float holdSeconds = 1.5f;
+    float holdDecayDbPerSecond = 20.0f;
+
+    /** IEC 60268-10 Type I style: fast attack, about 20 dB fall in 1.5 s. */
+    static MeterBallistics ppm() noexcept { return {}; }
+
+    /** VU style: symmetric one-pole rise and fall with a 65 ms time constant, which reaches
+        99% of a step in 300 ms as a VU needle does. */
+    static MeterBallistics vu() noexcept  { return { 0.065f, 0.065f, 0.3f, 1.5f, 20.0f }; }
+};
+
+// Per-channel level metering run once per block on the audio thread: ballistic peak and
+// RMS envelopes, a timed peak hold, BS.1770 true peak, crest factor and over/clip counts.
+// The per-sample work is a min/max scan and a sum of squares; the 4x true-peak filter only
+// runs on blocks whose sample peak reaches truePeakGate, since quieter blocks cannot
+// produce an inter-sample over.
+class ChannelMeter
+{
+public:
+    static constexpr float truePeakGate = 0.5f;       // -6 dBFS
+    static constexpr float clipThreshold = 0.999f;
+    static constexpr int clipRunLength = 3;           // consecutive full-scale samples
+
+    struct Coefficients
+    {
+        float attack = 0.0f;
+        float release = 0.0f;
+        float rms = 0.0f;
+        float holdDecayPerSample = 1.0f;
+        int holdSamples = 0;
+
+        void update (const MeterBallistics& ballistics, double sampleRate) noexcept
+        {
+            auto onePole = [sampleRate] (float seconds)
+            {
+                return seconds > 0.0f ? (float) std::exp (-1.0 / ((double) seconds * sampleRate)) : 0.0f;
+            };
+
+            attack = onePole (ballistics.attackSeconds);
+            release = onePole (ballistics.releaseSeconds);
+            rms = onePole (ballistics.rmsIntegrationSeconds);
+            holdDecayPerSample = juce::Decibels::decibelsToGain (-ballistics.holdDecayDbPerSecond / (float) sampleRate);
+            holdSamples = (int) (ballistics.holdSeconds * sampleRate);
+        }
+    };
+
+    struct Readings
+    {
+        float rms = 0.0f;          // this block
+        float peak = 0.0f;         // this block
+        float truePeak = 0.0f;     // this block; below truePeakGate only the sample peak, a lower bound
+        float level = 0.0f;        // ballistic peak envelope
+        float rmsLevel = 0.0f;     // ballistic RMS
+        float peakHold = 0.0f;
+        float crestFactorDb = 0.0f;
+        std::uint32_t overs = 0;   // samples beyond full scale since the last reset
+        std::uint32_t clips = 0;   // runs of clipRunLength samples at full scale since the last reset
+    };
+
+    void reset() noexcept
+    {
+        truePeak.reset();
+        envelope = meanSquare = peakHold = 0.0f;
+        holdRemaining = clipRun = 0;
+        overs = clips = 0;
+    }
+
+    void resetCounters() noexcept
+    {
+        overs = clips = 0;
+        peakHold = 0.0f;
+        holdRemaining = 0;
+    }
+
+    /** Without perSample the envelopes take one closed-form step per block, which keeps the
+        time constants but not the shape within the block. The true peak is then gated. */
+    Readings process (const float* data, int numSamples, const Coefficients& coeffs, bool perSample) noexcept
+    {
+        Readings readings;
+
+        if (numSamples <= 0)
+            return fill (readings);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax (data, numSamples);
+        readings.peak = juce::jmax (-range.getStart(), range.getEnd());
+
+        double sumSquares = 0.0;
+        for (int i = 0; i < numSamples; ++i)
+            sumSquares += (double) data[i] * (double) data[i];
+
+        const auto blockMeanSquare = (float) (sumSquares / (double) numSamples);
+        readings.rms = std::sqrt (blockMeanSquare);
+
+        if (readings.peak >= clipThreshold)
+            countOversAndClips (data, numSamples);
+        else
+            clipRun = 0;
+
+        if (perSample || readings.peak >= truePeakGate)
+        {
+            readings.truePeak = juce::jmax (readings.peak, truePeak.process (data, numSamples));
+        }
+        else
+        {
+            readings.truePeak = readings.peak;
+            truePeak.prime (data, numSamples);
+        }
+
+        if (perSample)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = std::abs (data[i]);
+                envelope = input + (envelope - input) * (input > envelope ? coeffs.attack : coeffs.release);
+
+                const auto square = data[i] * data[i];
+                meanSquare = square + (meanSquare - square) * coeffs.rms;
+            }
+        }
+        else
+        {
+            const auto peakCoeff = readings.peak > envelope ? coeffs.attack : coeffs.release;
+            envelope = readings.peak + (envelope - readings.peak) * std::pow (peakCoeff, (float) numSamples);
+            meanSquare = blockMeanSquare + (meanSquare - blockMeanSquare) * std::pow (coeffs.rms, (float) numSamples);
+        }
+
+        if (readings.truePeak >= peakHold)
+        {
+            peakHold = readings.truePeak;
+            holdRemaining = coeffs.holdSamples;
+        }
+        else if (holdRemaining > 0)
+        {
+            holdRemaining = juce::jmax (0, holdRemaining - numSamples);
+        }
+        else
+        {
+            peakHold *= std::pow (coeffs.holdDecayPerSample, (float) numSamples);
+        }
+
+        return fill (readings);
+    }
+
+private:
+    Readings& fill (Readings& readings) const noexcept
+    {
+        readings.level = envelope;
+        readings.rmsLevel = std::sqrt (meanSquare);
+        readings.peakHold = peakHold;
+        readings.overs = overs;
+        readings.clips = clips;
+
+        if (readings.rmsLevel > 1.0e-5f)
+            readings.crestFactorDb = juce::jlimit (0.0f, 60.0f, juce::Decibels::gainToDecibels (envelope / readings.rmsLevel));
+
+        return readings;
+    }
+
+    void countOversAndClips (const float* data, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto magnitude = std::abs (data[i]);
+
+            if (magnitude > 1.0f)
+                ++overs;
+
+            if (magnitude >= clipThreshold)
+            {
+                if (++clipRun == clipRunLength)
+                    ++clips;
+            }
+            else
+            {
+                clipRun = 0;
+            }
+        }
+    }
+
+    TruePeakDetector truePeak;
+    float envelope = 0.0f;
+    float meanSquare = 0.0f;
+    float peakHold = 0.0f;
+    int holdRemaining = 0;
+    int clipRun = 0;
+    std::uint32_t overs = 0;
+    std::uint32_t clips = 0;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+// Zero-lag correlation between every pair of up to maxChannels speaker channels, from
+// exponentially weighted running cross-products. Samples are taken in short sub-blocks:
+// each pair's cross-product over a sub-block is a dot product kept in independent partial
+// sums, which the compiler can map onto vector lanes without reordering a single float sum
+// (not allowed under strict floating point), and the running sums decay once per sub-block,
+// so the cost stays linear in samples for all 136 pairs of a 16-channel layout. Audio
+// thread only; the processor copies the published values out alongside the speaker metrics.
+class CorrelationMatrix
+{
+public:
+    static constexpr int maxChannels = 16;
+    static constexpr int numPairs = maxChannels * (maxChannels + 1) / 2;   // including the diagonal
+    static constexpr int subBlockSize = 32;
+    static constexpr int numPartialSums = 8;
+
+    static_assert (subBlockSize % numPartialSums == 0, "sub-blocks must split evenly into the partial sums");
+
+    // Upper triangle, row-major: (a, b) with a <= b.
+    using Values = std::array<float, numPairs>;
+
+    static constexpr int pairIndex (int a, int b) noexcept
+    {
+        return a <= b ? a * maxChannels - a * (a - 1) / 2 + (b - a)
+                      : pairIndex (b, a);
+    }
+
+    void prepare (double sampleRate, double timeConstantSeconds = 0.2)
+    {
+        subBlockDecay = (float) std::exp (-(double) subBlockSize / (timeConstantSeconds * sampleRate));
+        crossProducts.fill (0.0f);
+        pending = 0;
+    }
+
+    /** channels[i] may be nullptr for a speaker with no input channel. */
+    void process (const float* const* channels, int numChannelsIn, int numSamples) noexcept
+    {
+        numChannels = juce::jlimit (0, maxChannels, numChannelsIn);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            const auto count = juce::jmin (subBlockSize - pending, numSamples - pos);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* dest = staging[(size_t) ch].data() + pending;
+
+                if (channels[ch] != nullptr)
+                    juce::FloatVectorOperations::copy (dest, channels[ch] + pos, count);
+                else
+                    juce::FloatVectorOperations::clear (dest, count);
+            }
+
+            pending += count;
+            pos += count;
+
+            if (pending == subBlockSize)
+            {
+                accumulateSubBlock();
+                pending = 0;
+            }
+        }
+    }
+
+    /** Writes the correlation coefficients (-1..1) of every pair; silent channels read 0. */
+    void getCorrelations (Values& dest) const noexcept
+    {
+        dest.fill (0.0f);
+
+        for (int a = 0; a < numChannels; ++a)
+        {
+            const auto energyA = crossProducts[(size_t) pairIndex (a, a)];
+
+            for (int b = a; b < numChannels; ++b)
+            {
+                const auto energyB = crossProducts[(size_t) pairIndex (b, b)];
+                const auto denominator = std::sqrt (energyA * energyB);
+
+                if (denominator > 1.0e-9f)
+                    dest[(size_t) pairIndex (a, b)] = juce::jlimit (-1.0f, 1.0f, crossProducts[(size_t) pairIndex (a, b)] / denominator);
+            }
+        }
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+
+private:
+    void accumulateSubBlock() noexcept
+    {
+        for (int a = 0; a < numChannels; ++a)
+        {
+            const auto* x = staging[(size_t) a].data();
+
+            for (int b = a; b < numChannels; ++b)
+            {
+                const auto* y = staging[(size_t) b].data();
+
+                float partial[numPartialSums] = {};
+                for (int i = 0; i < subBlockSize; i += numPartialSums)
+                    for (int lane = 0; lane < numPartialSums; ++lane)
+                        partial[lane] += x[i + lane] * y[i + lane];
+
+                float sum = 0.0f;
+                for (auto value : partial)
+                    sum += value;
+
+                auto& product = crossProducts[(size_t) pairIndex (a, b)];
+                product = product * subBlockDecay + sum;
+            }
+        }
+    }
+
+    std::array<std::array<float, subBlockSize>, maxChannels> staging {};
+    std::array<float, numPairs> crossProducts {};
+    float subBlockDecay = 0.99f;
+    int pending = 0;
+    int numChannels = 0;
+};
@@ -0,0 +1,196 @@
+#include "DelayEstimator.h"
+
+#include <cmath>
+
+DelayEstimator::DelayEstimator()
+    : juce::Thread ("AtmosViz delay estimator")
+{
+    jobs.resize (jobCapacity);
+    workspace.resize (2 * (size_t) (1 << maxFftOrder));
+
+    for (auto& state : pairStates)
+        state.average.resize (2 * maxBins);
+}
+
+DelayEstimator::~DelayEstimator()
+{
+    release();
+}
+
+void DelayEstimator::prepare (double sampleRate)
+{
+    currentSampleRate.store (sampleRate, std::memory_order_relaxed);
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::low);
+}
+
+void DelayEstimator::release()
+{
+    stopThread (1000);
+}
+
+void DelayEstimator::setPairs (const std::vector<Pair>& newPairs) noexcept
+{
+    const auto count = juce::jmin ((int) newPairs.size(), maxPairs);
+
+    // Bumping the generation makes the worker drop queued frames for the old pairs.
+    generation.store (generation.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    for (int i = 0; i < maxPairs; ++i)
+    {
+        const auto pair = i < count ? newPairs[(size_t) i] : Pair {};
+        published[(size_t) i].first.store (pair.first, std::memory_order_relaxed);
+        published[(size_t) i].second.store (pair.second, std::memory_order_relaxed);
+        published[(size_t) i].lagMs.store (0.0f, std::memory_order_relaxed);
+        published[(size_t) i].confidence.store (0.0f, std::memory_order_relaxed);
+    }
+
+    numPairs.store (count, std::memory_order_release);
+}
+
+void DelayEstimator::submit (int pairIndex, const float* spectrumA, const float* spectrumB, int fftOrder) noexcept
+{
+    if (pairIndex < 0 || pairIndex >= getNumPairs() || fftOrder > maxFftOrder || ! isThreadRunning())
+        return;
+
+    // A full queue means the worker is behind; dropping a frame only slows the averaging.
+    const auto scope = fifo.write (1);
+    if (scope.blockSize1 == 0)
+        return;
+
+    auto& job = jobs[(size_t) scope.startIndex1];
+    job.pairIndex = pairIndex;
+    job.generation = generation.load (std::memory_order_acquire);
+    job.fftOrder = fftOrder;
+
+    const auto numBins = (1 << fftOrder) / 2 + 1;
+    auto* cross = job.crossSpectrum.data();
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto ar = spectrumA[2 * bin], ai = spectrumA[2 * bin + 1];
+        const auto br = spectrumB[2 * bin], bi = spectrumB[2 * bin + 1];
+
+        // A * conj(B), normalised to unit magnitude (the phase transform).
+        const auto re = ar * br + ai * bi;
+        const auto im = ai * br - ar * bi;
+        const auto magnitude = std::sqrt (re * re + im * im);
+        const auto scale = magnitude > 1.0e-12f ? 1.0f / magnitude : 0.0f;
+
+        cross[2 * bin] = re * scale;
+        cross[2 * bin + 1] = im * scale;
+    }
+}
+
+DelayEstimator::Pair DelayEstimator::getPair (int pairIndex) const noexcept
+{
+    const auto& slot = published[(size_t) juce::jlimit (0, maxPairs - 1, pairIndex)];
+    return { slot.first.load (std::memory_order_relaxed), slot.second.load (std::memory_order_relaxed) };
+}
+
+DelayEstimator::Estimate DelayEstimator::getEstimate (int pairIndex) const noexcept
+{
+    const auto& slot = published[(size_t) juce::jlimit (0, maxPairs - 1, pairIndex)];
+
+    Estimate result;
+    result.pair = getPair (pairIndex);
+    result.lagMs = slot.lagMs.load (std::memory_order_relaxed);
+    result.confidence = slot.confidence.load (std::memory_order_relaxed);
+    return result;
+}
+
+void DelayEstimator::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const auto scope = fifo.read (fifo.getNumReady());
+
+            for (int i = 0; i < scope.blockSize1; ++i)
+                accumulate (jobs[(size_t) (scope.startIndex1 + i)]);
+
+            for (int i = 0; i < scope.blockSize2; ++i)
+                accumulate (jobs[(size_t) (scope.startIndex2 + i)]);
+        }
+
+        // Batched: however many frames arrived for a pair, it gets one inverse transform.
+        for (int pairIndex = 0; pairIndex < maxPairs; ++pairIndex)
+        {
+            auto& state = pairStates[(size_t) pairIndex];
+
+            if (state.dirty)
+            {
+                estimate (pairIndex, state);
+                state.dirty = false;
+            }
+        }
+
+        wait (20);
+    }
+}
+
+void DelayEstimator::accumulate (const Job& job)
+{
+    if (job.generation != generation.load (std::memory_order_acquire))
+        return;
+
+    auto& state = pairStates[(size_t) job.pairIndex];
+    const auto numFloats = 2 * ((1 << job.fftOrder) / 2 + 1);
+
+    if (state.generation != job.generation || state.fftOrder != job.fftOrder)
+    {
+        std::copy (job.crossSpectrum.begin(), job.crossSpectrum.begin() + numFloats, state.average.begin());
+        state.generation = job.generation;
+        state.fftOrder = job.fftOrder;
+    }
+    else
+    {
+        for (int i = 0; i < numFloats; ++i)
+            state.average[(size_t) i] += (job.crossSpectrum[(size_t) i] - state.average[(size_t) i]) * averagingWeight;
+    }
+
+    state.dirty = true;
+}
+
+void DelayEstimator::estimate (int pairIndex, PairState& state)
+{
+    auto& transform = inverseTransforms[(size_t) state.fftOrder];
+    if (transform == nullptr)
+        transform = std::make_unique<juce::dsp::FFT> (state.fftOrder);
+
+    const auto size = 1 << state.fftOrder;
+    const auto numFloats = 2 * (size / 2 + 1);
+
+    std::copy (state.average.begin(), state.average.begin() + numFloats, workspace.begin());
+    std::fill (workspace.begin() + numFloats, workspace.begin() + 2 * size, 0.0f);
+    transform->performRealOnlyInverseTransform (workspace.data());
+
+    // Lag tau sits at index tau for tau >= 0 and size + tau below zero.
+    const auto maxLag = size / 4;
+    auto valueAt = [&] (int lag) { return workspace[(size_t) ((lag + size) % size)]; };
+
+    int bestLag = 0;
+    float bestValue = valueAt (0);
+
+    for (int lag = -maxLag; lag <= maxLag; ++lag)
+    {
+        if (valueAt (lag) > bestValue)
+        {
+            bestValue = valueAt (lag);
+            bestLag = lag;
+        }
+    }
+
+    // Parabolic interpolation around the peak for a sub-sample lag.
+    const auto left = valueAt (bestLag - 1);
+    const auto right = valueAt (bestLag + 1);
+    const auto curvature = left - 2.0f * bestValue + right;
+    const auto offset = std::abs (curvature) > 1.0e-9f ? juce::jlimit (-0.5f, 0.5f, 0.5f * (left - right) / curvature) : 0.0f;
+
+    const auto lagMs = (float) (1000.0 * ((double) bestLag + (double) offset) / currentSampleRate.load (std::memory_order_relaxed));
+
+    auto& slot = published[(size_t) pairIndex];
+    slot.lagMs.store (lagMs, std::memory_order_relaxed);
+    slot.confidence.store (juce::jlimit (0.0f, 1.0f, bestValue), std::memory_order_relaxed);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// GCC-PHAT arrival-time offsets between selected speaker pairs.
+// The audio thread reuses the forward spectra the band analysis already computed: per pair
+// it forms the phase-transform weighted cross-spectrum and queues it. A background thread
+// averages the queued cross-spectra per pair, then runs one inverse transform per updated
+// pair per wake-up and publishes the lag and peak height (confidence, 0-1).
+// The search covers a quarter of the transform length either side, since the block
+// spectra are not zero-padded and larger lags would alias.
+class DelayEstimator : private juce::Thread
+{
+public:
+    static constexpr int maxPairs = 16;
+    static constexpr int maxFftOrder = 12;
+    static constexpr int maxBins = (1 << maxFftOrder) / 2 + 1;
+
+    struct Pair
+    {
+        int first = -1;
+        int second = -1;
+    };
+
+    struct Estimate
+    {
+        Pair pair;
+        float lagMs = 0.0f;         // > 0: the first channel arrives later than the second
+        float confidence = 0.0f;
+    };
+
+    DelayEstimator();
+    ~DelayEstimator() override;
+
+    /** Starts or stops the background thread; call from prepareToPlay / releaseResources. */
+    void prepare (double sampleRate);
+    void release();
+
+    /** Audio thread: replaces the pair list and forgets all estimates. */
+    void setPairs (const std::vector<Pair>& newPairs) noexcept;
+
+    /** Audio thread: queues one frame for a pair. Spectra are JUCE real-only forward
+        transforms of the same time window, (size / 2 + 1) interleaved complex bins. */
+    void submit (int pairIndex, const float* spectrumA, const float* spectrumB, int fftOrder) noexcept;
+
+    int getNumPairs() const noexcept        { return numPairs.load (std::memory_order_relaxed); }
+    Pair getPair (int pairIndex) const noexcept;
+    Estimate getEstimate (int pairIndex) const noexcept;
+
+private:
+    static constexpr int jobCapacity = 32;
+    static constexpr float averagingWeight = 0.15f;
+
+    struct Job
+    {
+        int pairIndex = 0;
+        int generation = 0;
+        int fftOrder = 0;
+        std::array<float, 2 * maxBins> crossSpectrum;
+    };
+
+    struct PairState
+    {
+        int generation = -1;
+        int fftOrder = 0;
+        bool dirty = false;
+        std::vector<float> average;
+    };
+
+    struct Published
+    {
+        std::atomic<int> first { -1 };
+        std::atomic<int> second { -1 };
+        std::atomic<float> lagMs { 0.0f };
+        std::atomic<float> confidence { 0.0f };
+    };
+
+    void run() override;
+    void accumulate (const Job& job);
+    void estimate (int pairIndex, PairState& state);
+
+    std::vector<Job> jobs;
+    juce::AbstractFifo fifo { jobCapacity };
+
+    std::array<PairState, maxPairs> pairStates;
+    std::array<std::unique_ptr<juce::dsp::FFT>, maxFftOrder + 1> inverseTransforms;
+    std::vector<float> workspace;
+
+    std::array<Published, maxPairs> published;
+    std::atomic<int> numPairs { 0 };
+    std::atomic<int> generation { 0 };
+    std::atomic<double> currentSampleRate { 48000.0 };
+
+    JUCE_DECLARE_NON_COPYABLE (DelayEstimator)
+};
@@ -0,0 +1,374 @@
+#include "FilePlayer.h"
+
+#include <cmath>
+
+FilePlayer::FilePlayer()
+    : juce::Thread ("AtmosViz file analysis")
+{
+    formats.registerBasicFormats();
+}
+
+FilePlayer::~FilePlayer()
+{
+    close();
+}
+
+bool FilePlayer::open (const juce::File& file)
+{
+    close();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+    auto* format = formats.findFormatForFileExtension (file.getFileExtension());
+
+    if (reader == nullptr || format == nullptr || reader->lengthInSamples <= 0)
+        return false;
+
+    const auto numChannels = (int) reader->numChannels;
+    if (numChannels > maxChannels)
+        return false;
+
+    // WAV channel masks cannot name wide or top-side speakers; those files, and files without
+    // a mask, get the usual layout for their channel count.
+    auto layout = reader->getChannelLayout();
+    if (layout.size() != numChannels || layout.isDiscreteLayout())
+        layout = AnalysisEngine::getDefaultLayoutForChannelCount (numChannels);
+
+    if (layout.size() != numChannels)
+        return false;
+
+    // One reader per thread: the audio callback and the analysis worker each read their own
+    // mapping of the file.
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> newAudioReader (format->createMemoryMappedReader (file));
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> newAnalysisReader (format->createMemoryMappedReader (file));
+
+    if (newAudioReader == nullptr || newAnalysisReader == nullptr
+        || ! newAudioReader->mapEntireFile() || ! newAnalysisReader->mapEntireFile())
+        return false;
+
+    const auto sampleRate = reader->sampleRate;
+    const auto length = reader->lengthInSamples;
+
+    currentFile = file;
+    samplesPerFrame = juce::jmax (1, juce::roundToInt (sampleRate / MetricsTimelineWriter::framesPerSecond));
+
+    channelNames.clear();
+    for (const auto& def : AnalysisEngine::buildSpeakerDefinitions (layout))
+        channelNames.add (def.displayName);
+
+    const auto numFrames = (size_t) ((length + samplesPerFrame - 1) / samplesPerFrame);
+    frames.assign (numFrames, {});
+    analysed.reset (new std::atomic<bool>[numFrames]);
+
+    for (size_t i = 0; i < numFrames; ++i)
+        analysed[i].store (false, std::memory_order_relaxed);
+
+    analysisReader = std::move (newAnalysisReader);
+    analysisBuffer.setSize (numChannels, samplesPerFrame);
+    nextAnalysisFrame = -1;
+
+    {
+        const juce::SpinLock::ScopedLockType lock (audioLock);
+        audioReader = std::move (newAudioReader);
+        fileLayout = layout;
+        numFileChannels = numChannels;
+        fileSampleRate = sampleRate;
+        lengthInSamples = length;
+        playPosition = 0;
+
+        for (auto& interpolator : interpolators)
+            interpolator.reset();
+    }
+
+    publishedPosition.store (0);
+    pendingSeek.store (-1);
+    playing.store (false);
+    loaded.store (true, std::memory_order_release);
+
+    startThread (juce::Thread::Priority::low);
+    return true;
+}
+
+void FilePlayer::close()
+{
+    stopThread (4000);
+
+    {
+        const juce::SpinLock::ScopedLockType lock (audioLock);
+        loaded.store (false, std::memory_order_release);
+        playing.store (false);
+        audioReader.reset();
+        lengthInSamples = 0;
+    }
+
+    analysisReader.reset();
+    engine.release();
+    frames.clear();
+    analysed.reset();
+    channelNames.clear();
+    currentFile = juce::File();
+}
+
+double FilePlayer::getPositionSeconds() const noexcept
+{
+    const auto pending = pendingSeek.load();
+    return (double) (pending >= 0 ? pending : publishedPosition.load()) / fileSampleRate;
+}
+
+void FilePlayer::setPositionSeconds (double seconds)
+{
+    if (! isOpen())
+        return;
+
+    pendingSeek.store (juce::jlimit ((juce::int64) 0, lengthInSamples, (juce::int64) (seconds * fileSampleRate)));
+    notify();
+}
+
+void FilePlayer::setPlaying (bool shouldPlay)
+{
+    if (shouldPlay && getPositionSeconds() >= getDurationSeconds())
+        setPositionSeconds (0.0);
+
+    playing.store (shouldPlay && isOpen());
+}
+
+bool FilePlayer::isFrameAnalysed (juce::int64 frameIndex) const noexcept
+{
+    return frameIndex >= 0 && frameIndex < getNumFrames() && analysed[(size_t) frameIndex].load (std::memory_order_acquire);
+}
+
+bool FilePlayer::advance (MetricsTimelineFrame& dest)
+{
+    if (! isOpen())
+        return false;
+
+    const auto frameIndex = juce::jlimit ((juce::int64) 0, getNumFrames() - 1,
+                                          (juce::int64) (getPositionSeconds() * fileSampleRate) / samplesPerFrame);
+
+    if (! isFrameAnalysed (frameIndex))
+    {
+        // Typically just after a seek: the worker moves over on its next check anyway, this
+        // only saves it waiting for the rest of its slice.
+        notify();
+        return false;
+    }
+
+    dest = frames[(size_t) frameIndex];
+    return true;
+}
+
+void FilePlayer::prepareToPlay (double newDeviceSampleRate, int maximumBlockSize)
+{
+    const juce::SpinLock::ScopedLockType lock (audioLock);
+
+    deviceSampleRate = newDeviceSampleRate;
+    scratch.setSize (maxChannels, (int) std::ceil (maximumBlockSize * maxResampleRatio) + 2);
+    output.setSize (maxChannels, maximumBlockSize);
+
+    for (auto& interpolator : interpolators)
+        interpolator.reset();
+}
+
+bool FilePlayer::renderNextBlock (juce::AudioBuffer<float>& buffer, const juce::AudioChannelSet& busLayout) noexcept
+{
+    if (! loaded.load (std::memory_order_acquire) || ! playing.load (std::memory_order_relaxed))
+        return false;
+
+    buffer.clear();
+
+    const juce::SpinLock::ScopedTryLockType lock (audioLock);
+
+    // Opening or closing a file: a block of silence.
+    if (! lock.isLocked() || audioReader == nullptr)
+        return true;
+
+    const auto seek = pendingSeek.exchange (-1);
+    if (seek >= 0)
+    {
+        playPosition = seek;
+
+        for (auto& interpolator : interpolators)
+            interpolator.reset();
+    }
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto ratio = fileSampleRate / deviceSampleRate;
+    const auto resample = std::abs (ratio - 1.0) > 1.0e-6;
+    const auto needed = resample ? (int) std::ceil (numSamples * ratio) + 2 : numSamples;
+
+    // Blocks beyond what prepareToPlay allowed for stay silent rather than allocate.
+    if (numSamples > output.getNumSamples() || needed > scratch.getNumSamples())
+        return true;
+
+    auto consumed = numSamples;
+
+    if (resample)
+    {
+        readWrapped (scratch, needed);
+
+        for (int ch = 0; ch < numFileChannels; ++ch)
+            consumed = interpolators[(size_t) ch].process (ratio, scratch.getReadPointer (ch), output.getWritePointer (ch), numSamples);
+    }
+    else
+    {
+        readWrapped (output, numSamples);
+    }
+
+    for (int ch = 0; ch < numFileChannels; ++ch)
+    {
+        // Matched by channel type; a channel the bus lacks goes to the bus channel in the same
+        // position if that one has no counterpart in the file, as the display matches them.
+        auto busChannel = busLayout.getChannelIndexForType (fileLayout.getTypeOfChannel (ch));
+        if (busChannel < 0 && fileLayout.getChannelIndexForType (busLayout.getTypeOfChannel (ch)) < 0)
+            busChannel = ch;
+
+        if (busChannel >= 0 && busChannel < buffer.getNumChannels())
+            buffer.copyFrom (busChannel, 0, output, ch, 0, numSamples);
+    }
+
+    playPosition += consumed;
+
+    if (playPosition >= lengthInSamples)
+    {
+        if (looping.load (std::memory_order_relaxed))
+        {
+            playPosition %= lengthInSamples;
+        }
+        else
+        {
+            playPosition = lengthInSamples;
+            playing.store (false, std::memory_order_relaxed);
+        }
+    }
+
+    publishedPosition.store (playPosition);
+    return true;
+}
+
+void FilePlayer::readWrapped (juce::AudioBuffer<float>& dest, int numSamples) noexcept
+{
+    std::array<float*, maxChannels> channels {};
+    auto position = playPosition;
+
+    for (int done = 0; done < numSamples;)
+    {
+        if (position >= lengthInSamples)
+        {
+            if (! looping.load (std::memory_order_relaxed))
+            {
+                dest.clear (done, numSamples - done);
+                return;
+            }
+
+            position = 0;
+        }
+
+        const auto count = (int) juce::jmin ((juce::int64) (numSamples - done), lengthInSamples - position);
+
+        for (int ch = 0; ch < numFileChannels; ++ch)
+            channels[(size_t) ch] = dest.getWritePointer (ch, done);
+
+        audioReader->read (channels.data(), numFileChannels, position, count);
+        done += count;
+        position += count;
+    }
+}
+
+void FilePlayer::run()
+{
+    const auto numFrames = getNumFrames();
+    const auto warmUpFrames = (juce::int64) std::ceil (warmUpSeconds * fileSampleRate / samplesPerFrame);
+
+    while (! threadShouldExit())
+    {
+        touchAhead();
+
+        const auto playheadFrame = juce::jlimit ((juce::int64) 0, numFrames - 1,
+                                                 (juce::int64) (getPositionSeconds() * fileSampleRate) / samplesPerFrame);
+        const auto target = findFrameToAnalyse (playheadFrame);
+
+        if (target < 0)
+        {
+            // Everything is cached; keep the pages ahead of the playhead warm.
+            wait (100);
+            continue;
+        }
+
+        // Carry on from where the engine is if that reaches the target within a warm-up's
+        // worth of frames; otherwise start over just before it.
+        if (nextAnalysisFrame < 0 || target < nextAnalysisFrame || target - nextAnalysisFrame > warmUpFrames)
+        {
+            nextAnalysisFrame = juce::jmax ((juce::int64) 0, target - warmUpFrames);
+            firstKeptFrame = nextAnalysisFrame == 0 ? 0 : target;
+            engine.prepare (fileSampleRate, fileLayout);
+        }
+
+        // A second of audio at a time, then look at the playhead again.
+        for (int i = 0; i < (int) MetricsTimelineWriter::framesPerSecond && nextAnalysisFrame < numFrames && ! threadShouldExit(); ++i)
+            analyseNextFrame();
+    }
+}
+
+juce::int64 FilePlayer::findFrameToAnalyse (juce::int64 playheadFrame) const noexcept
+{
+    // The first gap at or after the playhead, then from the start of the file, so a loop
+    // finds its beginning cached by the time it wraps.
+    const auto numFrames = getNumFrames();
+
+    for (auto frame = playheadFrame; frame < numFrames; ++frame)
+        if (! analysed[(size_t) frame].load (std::memory_order_relaxed))
+            return frame;
+
+    for (juce::int64 frame = 0; frame < playheadFrame; ++frame)
+        if (! analysed[(size_t) frame].load (std::memory_order_relaxed))
+            return frame;
+
+    return -1;
+}
+
+void FilePlayer::analyseNextFrame()
+{
+    const auto frameIndex = nextAnalysisFrame++;
+    const auto start = frameIndex * samplesPerFrame;
+    const auto numSamples = (int) juce::jmin ((juce::int64) samplesPerFrame, lengthInSamples - start);
+
+    if (numSamples != analysisBuffer.getNumSamples())
+        analysisBuffer.setSize (numFileChannels, numSamples, false, false, true);
+
+    analysisReader->read (analysisBuffer.getArrayOfWritePointers(), numFileChannels, start, numSamples);
+    engine.process (analysisBuffer, true, AnalysisGovernor::Tier::Full, blockResult);
+
+    // Onsets are not part of a frame; keep the queue from filling up.
+    OnsetEvent onset;
+    while (engine.popOnsetEvent (onset)) {}
+
+    if (frameIndex < firstKeptFrame || analysed[(size_t) frameIndex].load (std::memory_order_relaxed))
+        return;
+
+    const auto loudness = engine.getLoudnessMeter().getSnapshot();
+    auto& frame = frames[(size_t) frameIndex];
+    frame.samplePosition = start;
+    frame.momentaryLufs = loudness.momentaryLufs;
+    frame.shortTermLufs = loudness.shortTermLufs;
+    frame.numChannels = juce::jmin ((int) blockResult.metrics.size(), maxChannels);
+
+    for (int ch = 0; ch < frame.numChannels; ++ch)
+    {
+        const auto& metrics = blockResult.metrics[(size_t) ch];
+        frame.channels[(size_t) ch] = { metrics.rms, metrics.peak, metrics.bands.low, metrics.bands.mid, metrics.bands.high };
+    }
+
+    analysed[(size_t) frameIndex].store (true, std::memory_order_release);
+}
+
+void FilePlayer::touchAhead() noexcept
+{
+    // Reading a page the first time faults it in from disk; do that here rather than in the
+    // audio callback. One touch per page is enough.
+    const auto bytesPerFrame = juce::jmax (1, numFileChannels * (int) audioReader->bitsPerSample / 8);
+    const auto step = (juce::int64) juce::jmax (1, 4096 / bytesPerFrame);
+    const auto start = publishedPosition.load();
+    const auto end = juce::jmin (lengthInSamples, start + (juce::int64) (touchAheadSeconds * fileSampleRate));
+
+    for (auto sample = start; sample < end; sample += step)
+        audioReader->touchSample (sample);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "AnalysisEngine.h"
+#include "MetricsTimeline.h"
+
+// Plays a multichannel WAV/BWF/AIFF file through the standalone app and drives the view from
+// an analysis of it. The audio callback only copies (and, when the device runs at another
+// rate, resamples) from a memory-mapped reader and never analyses. A background worker runs
+// its own AnalysisEngine over the file ahead of the playhead, one timeline frame at a time,
+// into a cache holding a frame for every 40 ms of the file, and touches the mapped pages the
+// callback is about to read. Once analysed, a frame stays cached until the file is closed, so
+// seeking back and looping show metrics at once; a seek into an unanalysed stretch restarts
+// the worker there after a few seconds of warm-up for the loudness windows.
+class FilePlayer : public MetricsFrameSource,
+                   private juce::Thread
+{
+public:
+    FilePlayer();
+    ~FilePlayer() override;
+
+    /** Message thread. Fails for files that cannot be memory-mapped, have more than 16
+        channels or no layout can be assumed for. */
+    bool open (const juce::File& file);
+    void close();
+
+    bool isOpen() const noexcept override           { return loaded.load (std::memory_order_acquire); }
+    juce::File getFile() const                      { return currentFile; }
+    const juce::StringArray& getChannelNames() const noexcept override { return channelNames; }
+    const juce::AudioChannelSet& getFileLayout() const noexcept        { return fileLayout; }
+
+    double getDurationSeconds() const noexcept      { return (double) lengthInSamples / fileSampleRate; }
+    double getPositionSeconds() const noexcept;
+    void setPositionSeconds (double seconds);
+
+    void setPlaying (bool shouldPlay);
+    bool isPlaying() const noexcept                 { return playing.load (std::memory_order_relaxed); }
+    void setLooping (bool shouldLoop) noexcept      { looping.store (shouldLoop, std::memory_order_relaxed); }
+    bool isLooping() const noexcept                 { return looping.load (std::memory_order_relaxed); }
+
+    /** Analysed frames over the whole file, for drawing the cache coverage. */
+    juce::int64 getNumFrames() const noexcept       { return (juce::int64) frames.size(); }
+    bool isFrameAnalysed (juce::int64 frameIndex) const noexcept;
+
+    /** Message thread, once per display tick: the cached frame under the playhead. */
+    bool advance (MetricsTimelineFrame& dest) override;
+
+    /** Audio thread, from prepareToPlay. Allocates. */
+    void prepareToPlay (double deviceSampleRate, int maximumBlockSize);
+
+    /** Audio thread. While a file is playing, replaces the buffer with the file's channels at
+        the playhead, matched to the bus by channel type, and returns true; the processor then
+        leaves the block unanalysed. Returns false (and does nothing) when no file is open or
+        it is paused, so the live input is analysed as usual. */
+    bool renderNextBlock (juce::AudioBuffer<float>& buffer, const juce::AudioChannelSet& busLayout) noexcept;
+
+private:
+    static constexpr int maxChannels = MetricsTimelineFrame::maxChannels;
+    static constexpr double maxResampleRatio = 8.0;        // file rate / device rate
+    static constexpr double warmUpSeconds = 3.0;           // the short-term loudness window
+    static constexpr double touchAheadSeconds = 2.0;
+
+    void run() override;
+    juce::int64 findFrameToAnalyse (juce::int64 playheadFrame) const noexcept;
+    void analyseNextFrame();
+    void touchAhead() noexcept;
+    void readWrapped (juce::AudioBuffer<float>& dest, int numSamples) noexcept;
+
+    juce::AudioFormatManager formats;
+    juce::File currentFile;
+    juce::AudioChannelSet fileLayout;
+    juce::StringArray channelNames;
+    int numFileChannels = 0;
+    double fileSampleRate = 48000.0;
+    juce::int64 lengthInSamples = 0;
+    int samplesPerFrame = 1920;
+
+    // Audio thread, swapped by the message thread under audioLock.
+    juce::SpinLock audioLock;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> audioReader;
+    juce::AudioBuffer<float> scratch;    // file-rate input to the interpolators
+    juce::AudioBuffer<float> output;     // one block at the device rate, in file channel order
+    std::array<juce::LagrangeInterpolator, maxChannels> interpolators;
+    double deviceSampleRate = 48000.0;
+    juce::int64 playPosition = 0;
+
+    std::atomic<bool> loaded { false };
+    std::atomic<bool> playing { false };
+    std::atomic<bool> looping { false };
+    std::atomic<juce::int64> publishedPosition { 0 };
+    std::atomic<juce::int64> pendingSeek { -1 };
+
+    // Frame cache: written by the worker, read by the message thread once marked analysed.
+    std::vector<MetricsTimelineFrame> frames;
+    std::unique_ptr<std::atomic<bool>[]> analysed;
+
+    // Worker thread only.
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> analysisReader;
+    AnalysisEngine engine;
+    AnalysisEngine::BlockResult blockResult;
+    juce::AudioBuffer<float> analysisBuffer;
+    juce::int64 nextAnalysisFrame = -1;   // the frame the engine's state continues into
+    juce::int64 firstKeptFrame = 0;       // frames before this are warm-up and not cached
+
+    JUCE_DECLARE_NON_COPYABLE (FilePlayer)
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Monotonic allocator for temporaries that live for a single paint() call.
+// Allocation bumps a pointer inside one block; nothing is freed until reset(),
+// which rewinds the block. If a frame overflows the block, the overflow is
+// served from the heap and the block is regrown on reset so the next frame fits.
+// Not thread-safe: allocate on the message thread before handing data to workers.
+class FrameArena
+{
+public:
+    explicit FrameArena (size_t initialCapacity = 64 * 1024)
+    {
+        grow (initialCapacity);
+        overflowsThisFrame = 0;
+    }
+
+    void* allocate (size_t bytes, size_t alignment)
+    {
+        const auto base = reinterpret_cast<std::uintptr_t> (block.get());
+        const auto aligned = (base + offset + alignment - 1) & ~(std::uintptr_t) (alignment - 1);
+        const auto end = aligned - base + bytes;
+
+        bytesRequestedThisFrame += bytes + alignment;
+
+        if (end <= capacity)
+        {
+            offset = (size_t) end;
+            return reinterpret_cast<void*> (aligned);
+        }
+
+        overflowBlocks.emplace_back (new std::max_align_t[(bytes + alignment) / sizeof (std::max_align_t) + 1]);
+        ++overflowsThisFrame;
+
+        const auto overflowBase = reinterpret_cast<std::uintptr_t> (overflowBlocks.back().get());
+        return reinterpret_cast<void*> ((overflowBase + alignment - 1) & ~(std::uintptr_t) (alignment - 1));
+    }
+
+    void reset()
+    {
+        if (! overflowBlocks.empty())
+        {
+            overflowBlocks.clear();
+            grow (juce::jmax (capacity * 2, (size_t) juce::nextPowerOfTwo ((int) bytesRequestedThisFrame)));
+        }
+
+        overflowsLastFrame = overflowsThisFrame;
+        overflowsThisFrame = 0;
+        offset = 0;
+        bytesRequestedLastFrame = bytesRequestedThisFrame;
+        bytesRequestedThisFrame = 0;
+    }
+
+    /** Records other frame-scoped storage outgrowing what it kept (e.g. a growing path pool). */
+    void noteOverflow() noexcept                        { ++overflowsThisFrame; }
+
+    /** Times frame storage had to grow during the last completed frame: arena overflows and
+        regrowth, plus whatever was recorded through noteOverflow(). Zero once warmed up. This
+        is not every heap allocation of a frame; the JUCE renderer and stroker allocate too. */
+    int getOverflowsLastFrame() const noexcept          { return overflowsLastFrame; }
+
+    /** Bytes the last completed frame asked for, alignment padding included. */
+    size_t getBytesRequestedLastFrame() const noexcept  { return bytesRequestedLastFrame; }
+    size_t getCapacity() const noexcept                 { return capacity; }
+
+    /** Resets the arena when the enclosing frame scope ends. */
+    struct ScopedFrame
+    {
+        explicit ScopedFrame (FrameArena& a) noexcept : arena (a) {}
+        ~ScopedFrame() { arena.reset(); }
+
+        FrameArena& arena;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedFrame)
+    };
+
+private:
+    void grow (size_t newCapacity)
+    {
+        const auto words = (newCapacity + sizeof (std::max_align_t) - 1) / sizeof (std::max_align_t);
+        block.reset (new std::max_align_t[words]);
+        capacity = words * sizeof (std::max_align_t);
+        ++overflowsThisFrame;
+    }
+
+    std::unique_ptr<std::max_align_t[]> block;
+    std::vector<std::unique_ptr<std::max_align_t[]>> overflowBlocks;
+    size_t capacity = 0;
+    size_t offset = 0;
+    size_t bytesRequestedThisFrame = 0;
+    size_t bytesRequestedLastFrame = 0;
+    int overflowsThisFrame = 0;
+    int overflowsLastFrame = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameArena)
+};
+
+// STL allocator that draws from a FrameArena; deallocate is a no-op because the
+// whole arena is rewound at the end of the frame.
+template <typename T>
+struct FrameAllocator
+{
+    using value_type = T;
+
+    explicit FrameAllocator (FrameArena& a) noexcept : arena (&a) {}
+
+    template <typename U>
+    FrameAllocator (const FrameAllocator<U>& other) noexcept : arena (other.arena) {}
+
+    T* allocate (size_t n)                 { return static_cast<T*> (arena->allocate (n * sizeof (T), alignof (T))); }
+    void deallocate (T*, size_t) noexcept  {}
+
+    template <typename U>
+    bool operator== (const FrameAllocator<U>& other) const noexcept { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!= (const FrameAllocator<U>& other) const noexcept { return arena != other.arena; }
+
+    FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,482 @@
+#include "FrameExporter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AnalysisEngine.h"
+#include "PluginEditor.h"
+
+FrameExporter::FrameExporter()
+    : juce::Thread ("AtmosViz frame export")
+{
+}
+
+FrameExporter::~FrameExporter()
+{
+    stop();
+}
+
+bool FrameExporter::start (AtmosVizAudioProcessor& processor, const SpeakerVisualizerComponent& viewToMatch,
+                           const juce::File& source, const Settings& newSettings)
+{
+    stop();
+
+    settings = newSettings;
+    stopRequested = false;
+    failed = false;
+    finished = false;
+
+    {
+        const juce::ScopedLock lock (messageLock);
+        errorMessage.clear();
+    }
+
+    const auto reject = [this] (const juce::String& message)
+    {
+        fail (message);
+        return false;
+    };
+
+    if (settings.width < 16 || settings.height < 16 || settings.framesPerSecond <= 0.0)
+        return reject ("Invalid size or frame rate");
+
+    if (! (settings.writePng || settings.writeRaw))
+        return reject ("Choose PNG, RGBA or both");
+
+    channelNames.clear();
+    sourceFrames.clear();
+    sourceFramesReady = 0;
+    audioReader.reset();
+
+    if (source.hasFileExtension ("avtl"))
+    {
+        MetricsTimelineReader reader (source);
+
+        if (! reader.isValid() || reader.getNumFrames() <= 0)
+            return reject ("Not a timeline file");
+
+        // A few megabytes even for hours; the workers then share it without locking.
+        sourceFrames.resize ((size_t) reader.getNumFrames());
+
+        for (juce::int64 i = 0; i < reader.getNumFrames(); ++i)
+            if (! reader.readFrame (i, sourceFrames[(size_t) i]))
+                return reject ("Damaged timeline file");
+
+        channelNames = reader.getChannelNames();
+        sourceSampleRate = reader.getSampleRate();
+        sourceEndSample = sourceFrames.back().samplePosition + juce::roundToInt (reader.getSampleRate() / reader.getFrameRate());
+        sourceFramesReady = reader.getNumFrames();
+    }
+    else
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        audioReader.reset (formats.createReaderFor (source));
+
+        if (audioReader == nullptr || audioReader->lengthInSamples <= 0)
+            return reject ("Cannot read this file");
+
+        const auto numChannels = (int) audioReader->numChannels;
+        if (numChannels > MetricsTimelineFrame::maxChannels)
+            return reject (juce::String (numChannels) + " channels; at most " + juce::String (MetricsTimelineFrame::maxChannels) + " are supported");
+
+        // Unlabelled files get the usual layout for their channel count, as in the file player.
+        audioLayout = audioReader->getChannelLayout();
+        if (audioLayout.size() != numChannels || audioLayout.isDiscreteLayout())
+            audioLayout = AnalysisEngine::getDefaultLayoutForChannelCount (numChannels);
+
+        if (audioLayout.size() != numChannels)
+            return reject ("No known layout has " + juce::String (numChannels) + " channels");
+
+        for (const auto& def : AnalysisEngine::buildSpeakerDefinitions (audioLayout))
+            channelNames.add (def.displayName);
+
+        samplesPerFrame = juce::jmax (1, juce::roundToInt (audioReader->sampleRate / MetricsTimelineWriter::framesPerSecond));
+        sourceFrames.resize ((size_t) ((audioReader->lengthInSamples + samplesPerFrame - 1) / samplesPerFrame));
+
+        // Stamped now so the workers can look frames up before they are analysed.
+        for (size_t i = 0; i < sourceFrames.size(); ++i)
+            sourceFrames[i].samplePosition = (juce::int64) i * samplesPerFrame;
+
+        sourceSampleRate = audioReader->sampleRate;
+        sourceEndSample = audioReader->lengthInSamples;
+    }
+
+    if (! settings.outputDirectory.createDirectory())
+        return reject ("Cannot create " + settings.outputDirectory.getFullPathName());
+
+    const auto durationSeconds = (double) (sourceEndSample - sourceFrames.front().samplePosition) / sourceSampleRate;
+    totalFrames = juce::jmax ((juce::int64) 1, (juce::int64) std::floor (durationSeconds * settings.framesPerSecond));
+
+    const auto numRuns = (totalFrames + framesPerRun - 1) / framesPerRun;
+    const auto numWorkers = (int) juce::jlimit ((juce::int64) 1, (juce::int64) juce::SystemStats::getNumCpus(), numRuns);
+
+    workers.clear();
+    workers.resize ((size_t) numWorkers);
+
+    for (auto& worker : workers)
+    {
+        worker.view = std::make_unique<SpeakerVisualizerComponent> (processor);
+        worker.view->setBounds (0, 0, settings.width, settings.height);
+        worker.view->prepareForExport (viewToMatch);
+
+        // Software images are plain memory owned by one worker. Native ones can be backed by a
+        // graphics device that is not meant to be drawn into from several threads at once.
+        worker.image = juce::Image (juce::Image::ARGB, settings.width, settings.height, true, juce::SoftwareImageType());
+    }
+
+    nextRun = 0;
+    framesDone = 0;
+    queuedRawFrames.clear();
+    queuedRawBytes = 0;
+    nextRawFrame = 0;
+    startTimeMs = juce::Time::getMillisecondCounterHiRes();
+    elapsedMs = 0.0;
+
+    startThread();
+    return true;
+}
+
+void FrameExporter::stop()
+{
+    stopRequested = true;
+    rawFrameQueued.signal();
+    rawFrameWritten.signal();
+    stopThread (10000);
+
+    workers.clear();
+    audioReader.reset();
+}
+
+juce::String FrameExporter::getErrorMessage() const
+{
+    const juce::ScopedLock lock (messageLock);
+    return errorMessage;
+}
+
+double FrameExporter::getSpeedFactor() const noexcept
+{
+    const auto elapsed = isRunning() ? juce::Time::getMillisecondCounterHiRes() - startTimeMs : elapsedMs.load();
+    return elapsed > 0.0 ? (double) getFramesDone() / settings.framesPerSecond / (elapsed * 0.001) : 0.0;
+}
+
+void FrameExporter::run()
+{
+    if (settings.writeRaw && ! openRawOutput())
+        fail ("Cannot write " + settings.outputDirectory.getChildFile ("frames.rgba").getFullPathName());
+
+    if (! shouldStop())
+    {
+        juce::ThreadPool pool ((int) workers.size());
+
+        for (auto& worker : workers)
+            pool.addJob ([this, &worker] { renderRuns (worker); });
+
+        // The analysis stays well ahead of the rendering, which only waits at the very start.
+        if (audioReader != nullptr)
+            analyseAudio();
+
+        while (pool.getNumJobs() > 0)
+        {
+            if (threadShouldExit())
+                stopRequested = true;
+
+            writeQueuedRawFrames();
+            rawFrameQueued.wait (50);
+        }
+
+        writeQueuedRawFrames();
+    }
+
+    rawFile.reset();
+
+    if (rawPipe != nullptr)
+    {
+        std::fclose (rawPipe);
+        rawPipe = nullptr;
+    }
+
+    for (auto& worker : workers)
+        worker.image = {};
+
+    elapsedMs = juce::Time::getMillisecondCounterHiRes() - startTimeMs;
+    finished = ! stopRequested.load();
+}
+
+bool FrameExporter::openRawOutput()
+{
+    const auto file = settings.outputDirectory.getChildFile ("frames.rgba");
+
+    auto stream = std::make_unique<juce::FileOutputStream> (file);
+
+    if (stream->openedOk())
+    {
+        stream->setPosition (0);
+        stream->truncate();
+        rawFile = std::move (stream);
+        return true;
+    }
+
+    // JUCE's file streams need to seek, which a named pipe (mkfifo frames.rgba) cannot; those
+    // are opened with stdio, which waits here until the encoder opens the other end.
+    rawPipe = std::fopen (file.getFullPathName().toRawUTF8(), "wb");
+    return rawPipe != nullptr;
+}
+
+void FrameExporter::analyseAudio()
+{
+    AnalysisEngine engine;
+    AnalysisEngine::BlockResult blockResult;
+    engine.prepare (audioReader->sampleRate, audioLayout);
+
+    const auto numChannels = (int) audioReader->numChannels;
+    juce::AudioBuffer<float> buffer (numChannels, samplesPerFrame);
+
+    for (size_t index = 0; index < sourceFrames.size() && ! shouldStop(); ++index)
+    {
+        const auto start = (juce::int64) index * samplesPerFrame;
+        const auto numSamples = (int) juce::jmin ((juce::int64) samplesPerFrame, audioReader->lengthInSamples - start);
+
+        if (numSamples != buffer.getNumSamples())
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+        if (! audioReader->read (buffer.getArrayOfWritePointers(), numChannels, start, numSamples))
+        {
+            fail ("Read error at " + juce::String ((double) start / audioReader->sampleRate, 1) + " s");
+            return;
+        }
+
+        engine.process (buffer, true, AnalysisGovernor::Tier::Full, blockResult);
+
+        // Onsets are not part of a frame; keep the queue from filling up.
+        OnsetEvent onset;
+        while (engine.popOnsetEvent (onset)) {}
+
+        const auto loudness = engine.getLoudnessMeter().getSnapshot();
+        auto& frame = sourceFrames[index];
+        frame.momentaryLufs = loudness.momentaryLufs;
+        frame.shortTermLufs = loudness.shortTermLufs;
+        frame.numChannels = juce::jmin ((int) blockResult.metrics.size(), MetricsTimelineFrame::maxChannels);
+
+        for (int ch = 0; ch < frame.numChannels; ++ch)
+        {
+            const auto& metrics = blockResult.metrics[(size_t) ch];
+            frame.channels[(size_t) ch] = { metrics.rms, metrics.peak, metrics.bands.low, metrics.bands.mid, metrics.bands.high };
+        }
+
+        sourceFramesReady.store ((juce::int64) index + 1, std::memory_order_release);
+
+        // A pipe's frames would otherwise wait for the end of the analysis.
+        if (index % (size_t) MetricsTimelineWriter::framesPerSecond == 0)
+            writeQueuedRawFrames();
+    }
+}
+
+bool FrameExporter::waitForSourceFrames (juce::int64 count) const
+{
+    while (sourceFramesReady.load (std::memory_order_acquire) < count)
+    {
+        if (shouldStop())
+            return false;
+
+        juce::Thread::sleep (5);
+    }
+
+    return true;
+}
+
+juce::int64 FrameExporter::findSourceFrame (juce::int64 samplePosition) const noexcept
+{
+    // The last frame starting at or before samplePosition, as MetricsTimelineReader::findFrame.
+    const auto it = std::upper_bound (sourceFrames.begin(), sourceFrames.end(), samplePosition,
+                                      [] (juce::int64 position, const MetricsTimelineFrame& frame) { return position < frame.samplePosition; });
+    return juce::jmax ((juce::int64) 0, (juce::int64) (it - sourceFrames.begin()) - 1);
+}
+
+void FrameExporter::interpolateFrame (double samplePosition, juce::int64 index, MetricsTimelineFrame& dest) const noexcept
+{
+    // Blending towards the next frame by where samplePosition falls between their start
+    // positions keeps exports faster than the source's frame rate moving smoothly instead of
+    // repeating frames.
+    const auto last = (juce::int64) sourceFrames.size() - 1;
+    const auto& next = sourceFrames[(size_t) juce::jmin (last, index + 1)];
+
+    dest = sourceFrames[(size_t) index];
+
+    const auto span = (double) (next.samplePosition - dest.samplePosition);
+    if (span <= 0.0)
+        return;
+
+    const auto t = (float) juce::jlimit (0.0, 1.0, (samplePosition - (double) dest.samplePosition) / span);
+
+    for (int ch = 0; ch < juce::jmin (dest.numChannels, next.numChannels); ++ch)
+    {
+        auto& channel = dest.channels[(size_t) ch];
+        const auto& other = next.channels[(size_t) ch];
+        channel.rms  += t * (other.rms  - channel.rms);
+        channel.peak += t * (other.peak - channel.peak);
+        channel.low  += t * (other.low  - channel.low);
+        channel.mid  += t * (other.mid  - channel.mid);
+        channel.high += t * (other.high - channel.high);
+    }
+}
+
+void FrameExporter::renderRuns (Worker& worker)
+{
+    MetricsTimelineFrame frame;
+
+    while (! shouldStop())
+    {
+        const auto first = nextRun.fetch_add (1) * framesPerRun;
+        if (first >= totalFrames)
+            return;
+
+        const auto end = juce::jmin (totalFrames, first + framesPerRun);
+
+        for (auto index = juce::jmax ((juce::int64) 0, first - warmUpFrames); index < end; ++index)
+        {
+            const auto samplePosition = (double) sourceFrames.front().samplePosition
+                                      + (double) index / settings.framesPerSecond * sourceSampleRate;
+            const auto sourceIndex = findSourceFrame ((juce::int64) samplePosition);
+            const auto needed = juce::jmin ((juce::int64) sourceFrames.size(), sourceIndex + 2);
+
+            if (shouldStop() || ! waitForSourceFrames (needed))
+                return;
+
+            interpolateFrame (samplePosition, sourceIndex, frame);
+
+            {
+                juce::Graphics g (worker.image);
+                worker.view->renderExportFrame (frame, channelNames, g);
+            }
+
+            // Warm-up frames only bring the view's state up to date.
+            if (index < first)
+                continue;
+
+            if (settings.writePng && ! writePng (index, worker.image))
+            {
+                fail ("Cannot write frames to " + settings.outputDirectory.getFullPathName());
+                return;
+            }
+
+            if (settings.writeRaw)
+                queueRawFrame (index, worker.image);
+
+            ++framesDone;
+        }
+    }
+}
+
+bool FrameExporter::writePng (juce::int64 frameIndex, const juce::Image& image) const
+{
+    const auto file = settings.outputDirectory.getChildFile ("frame_" + juce::String (frameIndex).paddedLeft ('0', 6) + ".png");
+    file.deleteFile();
+
+    juce::FileOutputStream stream (file);
+    juce::PNGImageFormat png;
+    return stream.openedOk() && png.writeImageToStream (image, stream);
+}
+
+void FrameExporter::queueRawFrame (juce::int64 frameIndex, const juce::Image& image)
+{
+    // Encoders expect RGBA bytes with straight alpha; the image holds premultiplied pixels in
+    // the platform's byte order.
+    juce::MemoryBlock rgba ((size_t) image.getWidth() * (size_t) image.getHeight() * 4);
+    auto* dest = static_cast<juce::uint8*> (rgba.getData());
+    const juce::Image::BitmapData pixels (image, juce::Image::BitmapData::readOnly);
+
+    for (int y = 0; y < pixels.height; ++y)
+    {
+        const auto* row = reinterpret_cast<const juce::PixelARGB*> (pixels.getLinePointer (y));
+
+        for (int x = 0; x < pixels.width; ++x)
+        {
+            auto pixel = row[x];
+            pixel.unpremultiply();
+            *dest++ = pixel.getRed();
+            *dest++ = pixel.getGreen();
+            *dest++ = pixel.getBlue();
+            *dest++ = pixel.getAlpha();
+        }
+    }
+
+    if (rawFile != nullptr)
+    {
+        const juce::ScopedLock lock (rawLock);
+
+        if (! rawFile->setPosition (frameIndex * (juce::int64) rgba.getSize()) || ! rawFile->write (rgba.getData(), rgba.getSize()))
+            fail ("Cannot write " + rawFile->getFile().getFullPathName());
+
+        return;
+    }
+
+    // The worker holding the next frame always gets in, so the queue drains whatever its size;
+    // workers further ahead wait while it is full.
+    for (;;)
+    {
+        {
+            const juce::ScopedLock lock (rawLock);
+
+            if (frameIndex == nextRawFrame || queuedRawBytes + rgba.getSize() <= maxQueuedRawBytes)
+            {
+                queuedRawBytes += rgba.getSize();
+                queuedRawFrames.emplace (frameIndex, std::move (rgba));
+                break;
+            }
+        }
+
+        if (shouldStop())
+            return;
+
+        rawFrameWritten.wait (20);
+    }
+
+    rawFrameQueued.signal();
+}
+
+void FrameExporter::writeQueuedRawFrames()
+{
+    if (rawPipe == nullptr)
+        return;
+
+    for (;;)
+    {
+        juce::MemoryBlock rgba;
+
+        {
+            const juce::ScopedLock lock (rawLock);
+            const auto next = queuedRawFrames.find (nextRawFrame);
+
+            if (next == queuedRawFrames.end())
+                return;
+
+            rgba = std::move (next->second);
+            queuedRawFrames.erase (next);
+        }
+
+        const auto written = std::fwrite (rgba.getData(), 1, rgba.getSize(), rawPipe) == rgba.getSize();
+
+        {
+            const juce::ScopedLock lock (rawLock);
+            queuedRawBytes -= rgba.getSize();
+            ++nextRawFrame;
+        }
+
+        rawFrameWritten.signal();
+
+        if (! written)
+        {
+            fail ("The encoder stopped reading frames.rgba");
+            return;
+        }
+    }
+}
+
+void FrameExporter::fail (const juce::String& message)
+{
+    const juce::ScopedLock lock (messageLock);
+
+    if (! failed.exchange (true))
+        errorMessage = message;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "MetricsTimeline.h"
+
+class AtmosVizAudioProcessor;
+class SpeakerVisualizerComponent;
+
+// Renders the view offscreen to an image sequence, as fast as the cores allow rather than in
+// real time. The frames come from a recorded timeline, or from an audio file that is analysed
+// while the export runs. Each worker of a thread pool owns a copy of the visualizer and a
+// software image to paint it into, and renders a run of consecutive frames at a time, so the
+// view's frame-to-frame state (the decaying colour normalisers) carries over as it does on
+// screen; every run starts a few frames early to let that state settle. The workers write
+// PNG frames themselves, and raw frames straight into a file at their offsets. A named pipe
+// to an encoder needs the frames in order: the coordinating thread writes those from a
+// queue, and workers running ahead wait while too much of it is held.
+class FrameExporter : private juce::Thread
+{
+public:
+    struct Settings
+    {
+        int width = 1920;
+        int height = 1080;
+        double framesPerSecond = 30.0;
+        bool writePng = true;        // frame_000000.png, frame_000001.png, ...
+        bool writeRaw = false;       // frames.rgba: 8-bit RGBA rows, top to bottom, frame after frame
+        juce::File outputDirectory;
+    };
+
+    FrameExporter();
+    ~FrameExporter() override;
+
+    /** Message thread. Opens the source (a .avtl timeline or an audio file), builds one copy of
+        viewToMatch per worker and starts exporting in the background. Returns false, with
+        getErrorMessage() saying why, when nothing was started. */
+    bool start (AtmosVizAudioProcessor& processor, const SpeakerVisualizerComponent& viewToMatch,
+                const juce::File& source, const Settings& newSettings);
+
+    /** Message thread: stops the export if it is still running, keeping the frames already
+        written, and frees the offscreen views. */
+    void stop();
+
+    bool isRunning() const noexcept                 { return isThreadRunning(); }
+    bool wasSuccessful() const noexcept             { return ! isRunning() && finished.load() && ! failed.load(); }
+    juce::String getErrorMessage() const;
+
+    juce::int64 getFramesDone() const noexcept      { return framesDone.load (std::memory_order_relaxed); }
+    juce::int64 getTotalFrames() const noexcept     { return totalFrames; }
+
+    /** Seconds of output rendered per second of wall-clock time. */
+    double getSpeedFactor() const noexcept;
+
+private:
+    static constexpr int warmUpFrames = 16;                          // 0.85^16: what is left of older peaks
+    static constexpr int framesPerRun = 150;
+    static constexpr size_t maxQueuedRawBytes = (size_t) 512 << 20;
+
+    struct Worker
+    {
+        std::unique_ptr<SpeakerVisualizerComponent> view;
+        juce::Image image;
+    };
+
+    void run() override;
+    bool openRawOutput();
+    void renderRuns (Worker& worker);
+    void analyseAudio();
+    bool waitForSourceFrames (juce::int64 count) const;
+    juce::int64 findSourceFrame (juce::int64 samplePosition) const noexcept;
+    void interpolateFrame (double samplePosition, juce::int64 index, MetricsTimelineFrame& dest) const noexcept;
+    bool writePng (juce::int64 frameIndex, const juce::Image& image) const;
+    void queueRawFrame (juce::int64 frameIndex, const juce::Image& image);
+    void writeQueuedRawFrames();
+    void fail (const juce::String& message);
+    bool shouldStop() const noexcept                { return stopRequested.load (std::memory_order_relaxed) || failed.load (std::memory_order_relaxed); }
+
+    Settings settings;
+    std::vector<Worker> workers;
+    juce::StringArray channelNames;
+
+    // Source frames, written once each before sourceFramesReady passes them. Output frames
+    // are placed by time on the frames' own sample clock, so gaps left by dropped frames
+    // stay gaps; every samplePosition is known from the start.
+    std::vector<MetricsTimelineFrame> sourceFrames;
+    std::atomic<juce::int64> sourceFramesReady { 0 };
+    double sourceSampleRate = 48000.0;
+    juce::int64 sourceEndSample = 0;   // one past the last frame's span
+
+    // Audio sources only: analysed by the coordinating thread while the workers render.
+    std::unique_ptr<juce::AudioFormatReader> audioReader;
+    juce::AudioChannelSet audioLayout;
+    int samplesPerFrame = 1920;
+
+    juce::int64 totalFrames = 0;
+    std::atomic<juce::int64> nextRun { 0 };
+    std::atomic<juce::int64> framesDone { 0 };
+    double startTimeMs = 0.0;
+    std::atomic<double> elapsedMs { 0.0 };
+
+    // Raw stream. A file takes each frame at its offset as soon as it is rendered; a named
+    // pipe only in order, so frames wait in the queue for the ones before them.
+    std::unique_ptr<juce::FileOutputStream> rawFile;
+    std::FILE* rawPipe = nullptr;
+    juce::CriticalSection rawLock;
+    std::map<juce::int64, juce::MemoryBlock> queuedRawFrames;
+    size_t queuedRawBytes = 0;
+    juce::int64 nextRawFrame = 0;
+    juce::WaitableEvent rawFrameQueued, rawFrameWritten;
+
+    std::atomic<bool> stopRequested { false };
+    std::atomic<bool> failed { false };
+    std::atomic<bool> finished { false };
+    juce::CriticalSection messageLock;
+    juce::String errorMessage;
+
+    JUCE_DECLARE_NON_COPYABLE (FrameExporter)
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Per-stage frame timing for the visualizer. Each stage keeps a rolling window of
+// samples folded into a log-spaced histogram, so adding a sample and reading a
+// percentile are both constant time regardless of window length.
+class FrameProfiler
+{
+public:
+    enum class Stage
+    {
+        Room,
+        Gizmo,
+        Projections,
+        ModeDraw,
+        Markers,
+        Frame
+    };
+
+    static constexpr int numStages = 6;
+    static constexpr int windowSize = 240;
+
+    struct Counters
+    {
+        int cellsEvaluated = 0;
+        int cellsDrawn = 0;
+    };
+
+    /** Times the enclosing scope and records it against a stage. */
+    class ScopedStage
+    {
+    public:
+        ScopedStage (FrameProfiler& p, Stage s) noexcept
+            : profiler (p), stage (s), start (juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedStage()
+        {
+            profiler.addSample (stage, juce::Time::getHighResolutionTicks() - start);
+        }
+
+    private:
+        FrameProfiler& profiler;
+        Stage stage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    void beginFrame() noexcept
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        frameStarts[(size_t) frameStartIndex] = now;
+        frameStartIndex = (frameStartIndex + 1) % windowSize;
+        frameStartCount = juce::jmin (frameStartCount + 1, windowSize);
+
+        lastCounters = currentCounters;
+        currentCounters = {};
+    }
+
+    void addSample (Stage stage, juce::int64 ticks) noexcept
+    {
+        const auto ms = 1000.0 * juce::Time::highResolutionTicksToSeconds (ticks);
+        histograms[(size_t) stage].add (ms);
+    }
+
+    /** Returns the approximate percentile (0-1) of a stage in milliseconds. */
+    double getPercentileMs (Stage stage, float percentile) const noexcept
+    {
+        return histograms[(size_t) stage].percentile (percentile);
+    }
+
+    double getFramesPerSecond() const noexcept
+    {
+        if (frameStartCount < 2)
+            return 0.0;
+
+        const auto newest = frameStarts[(size_t) ((frameStartIndex + windowSize - 1) % windowSize)];
+        const auto oldest = frameStarts[(size_t) ((frameStartIndex + windowSize - frameStartCount) % windowSize)];
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (newest - oldest);
+        return seconds > 0.0 ? (double) (frameStartCount - 1) / seconds : 0.0;
+    }
+
+    Counters& counters() noexcept                        { return currentCounters; }
+    const Counters& getLastFrameCounters() const noexcept { return lastCounters; }
+
+    static const char* getStageName (Stage stage) noexcept
+    {
+        static constexpr std::array<const char*, numStages> names { "Room", "Gizmo", "Projection", "Mode", "Markers", "Frame" };
+        return names[(size_t) stage];
+    }
+
+private:
+    struct RollingHistogram
+    {
+        // Four buckets per octave from 10 us upwards (about 19% resolution).
+        static constexpr int numBuckets = 80;
+        static constexpr double baseMs = 0.01;
+        static constexpr double bucketsPerOctave = 4.0;
+
+        void add (double ms) noexcept
+        {
+            const auto bucket = (std::uint8_t) juce::jlimit (0, numBuckets - 1,
+                                                             (int) (std::log2 (juce::jmax (ms, baseMs) / baseMs) * bucketsPerOctave));
+
+            if (count == windowSize)
+                --counts[(size_t) samples[(size_t) writeIndex]];
+            else
+                ++count;
+
+            samples[(size_t) writeIndex] = bucket;
+            ++counts[(size_t) bucket];
+            writeIndex = (writeIndex + 1) % windowSize;
+        }
+
+        double percentile (float p) const noexcept
+        {
+            if (count == 0)
+                return 0.0;
+
+            const auto target = juce::jlimit (1, count, (int) std::ceil (p * (float) count));
+            int seen = 0;
+
+            for (int bucket = 0; bucket < numBuckets; ++bucket)
+            {
+                seen += counts[(size_t) bucket];
+                if (seen >= target)
+                    return baseMs * std::exp2 (((double) bucket + 0.5) / bucketsPerOctave);
+            }
+
+            return baseMs * std::exp2 ((double) numBuckets / bucketsPerOctave);
+        }
+
+        std::array<int, numBuckets> counts {};
+        std::array<std::uint8_t, windowSize> samples {};
+        int writeIndex = 0;
+        int count = 0;
+    };
+
+    std::array<RollingHistogram, numStages> histograms;
+    std::array<juce::int64, windowSize> frameStarts {};
+    int frameStartIndex = 0;
+    int frameStartCount = 0;
+    Counters currentCounters;
+    Counters lastCounters;
+};
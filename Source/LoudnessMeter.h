@@ -0,0 +1,333 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// ITU-R BS.1770-4 loudness for up to maxChannels speaker channels: momentary (400 ms),
+// short-term (3 s) and gated integrated programme loudness, plus each channel's weighted
+// momentary contribution.
+// Channels are K-weighted with two biquads whose states are laid out channel-major, so the
+// inner loop runs across channels and vectorises. Mean squares are collected per 100 ms
+// sub-block; the momentary and short-term windows are running sums over a ring of
+// sub-blocks, and integrated loudness uses a 0.1 LU histogram of the 75%-overlapped gating
+// blocks, so every step is constant time regardless of programme length.
+// process() runs on the audio thread; getSnapshot() may be called from any thread.
+class LoudnessMeter
+{
+public:
+    static constexpr int maxChannels = 16;
+    static constexpr float silenceLufs = -200.0f;
+
+    struct Snapshot
+    {
+        float momentaryLufs = silenceLufs;
+        float shortTermLufs = silenceLufs;
+        float integratedLufs = silenceLufs;
+        int numChannels = 0;
+        std::array<float, maxChannels> channelMomentaryLufs {};
+    };
+
+    LoudnessMeter()
+    {
+        computeKWeighting (48000.0);
+        clear();
+    }
+
+    /** BS.1770-4 position weighting: +1.5 dB for surrounds at ear level between 60 and 120
+        degrees azimuth, 0 dB elsewhere including height channels, and LFE excluded. */
+    static float channelWeightFor (float azimuthDegrees, float elevationDegrees, bool isLfe) noexcept
+    {
+        if (isLfe)
+            return 0.0f;
+
+        const auto azimuth = std::abs (azimuthDegrees);
+        return (elevationDegrees < 30.0f && azimuth >= 60.0f && azimuth <= 120.0f) ? 1.41f : 1.0f;
+    }
+
+    /** Call before processing starts, never concurrently with process(). */
+    void prepare (double sampleRate)
+    {
+        computeKWeighting (sampleRate);
+        samplesPerSubBlock = juce::jmax (1, juce::roundToInt (sampleRate / 10.0));
+        clear();
+    }
+
+    void setChannelWeights (const float* newWeights, int numChannelsIn) noexcept
+    {
+        numChannels = juce::jlimit (0, maxChannels, numChannelsIn);
+        weights.fill (0.0f);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            weights[(size_t) ch] = newWeights[ch];
+
+        published.numChannels.store (numChannels, std::memory_order_relaxed);
+    }
+
+    /** channels[i] may be nullptr for a speaker with no input channel; it reads as silence. */
+    void process (const float* const* channels, int numSamples) noexcept
+    {
+        if (resetRequested.exchange (false, std::memory_order_acquire))
+            clear();
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            const auto count = juce::jmin (numSamples - pos, samplesPerSubBlock - subBlockFill);
+
+            for (int i = pos; i < pos + count; ++i)
+            {
+                std::array<double, maxChannels> input {};
+                for (int ch = 0; ch < numChannels; ++ch)
+                    input[(size_t) ch] = channels[ch] != nullptr ? (double) channels[ch][i] : 0.0;
+
+                // Transposed direct form II; both stages advance for every channel at once.
+                for (int ch = 0; ch < maxChannels; ++ch)
+                {
+                    const auto x = input[(size_t) ch];
+                    const auto y1 = shelf.b0 * x + shelfZ1[(size_t) ch];
+                    shelfZ1[(size_t) ch] = shelf.b1 * x - shelf.a1 * y1 + shelfZ2[(size_t) ch];
+                    shelfZ2[(size_t) ch] = shelf.b2 * x - shelf.a2 * y1;
+
+                    const auto y2 = highPass.b0 * y1 + highPassZ1[(size_t) ch];
+                    highPassZ1[(size_t) ch] = highPass.b1 * y1 - highPass.a1 * y2 + highPassZ2[(size_t) ch];
+                    highPassZ2[(size_t) ch] = highPass.b2 * y1 - highPass.a2 * y2;
+
+                    subBlockSquares[(size_t) ch] += y2 * y2;
+                }
+            }
+
+            pos += count;
+            subBlockFill += count;
+
+            if (subBlockFill == samplesPerSubBlock)
+                finishSubBlock();
+        }
+    }
+
+    /** Clears all windows and the integrated measurement at the start of the next block. */
+    void requestReset() noexcept    { resetRequested.store (true, std::memory_order_release); }
+
+    Snapshot getSnapshot() const noexcept
+    {
+        Snapshot snapshot;
+        snapshot.momentaryLufs = published.momentary.load (std::memory_order_relaxed);
+        snapshot.shortTermLufs = published.shortTerm.load (std::memory_order_relaxed);
+        snapshot.integratedLufs = published.integrated.load (std::memory_order_relaxed);
+        snapshot.numChannels = published.numChannels.load (std::memory_order_relaxed);
+
+        for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+            snapshot.channelMomentaryLufs[ch] = published.channelMomentary[ch].load (std::memory_order_relaxed);
+
+        return snapshot;
+    }
+
+private:
+    static constexpr int momentarySubBlocks = 4;
+    static constexpr int shortTermSubBlocks = 30;
+    static constexpr float absoluteGateLufs = -70.0f;
+    static constexpr float relativeGateLu = -10.0f;
+    static constexpr float histogramTopLufs = 5.0f;
+    static constexpr int histogramBinsPerLu = 10;
+    static constexpr int numHistogramBins = (int) ((histogramTopLufs - absoluteGateLufs) * histogramBinsPerLu);
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    static float toLufs (double power) noexcept
+    {
+        return power > 1.0e-20 ? (float) (-0.691 + 10.0 * std::log10 (power)) : silenceLufs;
+    }
+
+    void computeKWeighting (double sampleRate) noexcept
+    {
+        // Stage 1: high shelf modelling the acoustic effect of the head.
+        {
+            const auto f0 = 1681.974450955533;
+            const auto gainDb = 3.999843853973347;
+            const auto q = 0.7071752369554196;
+
+            const auto k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto vh = std::pow (10.0, gainDb / 20.0);
+            const auto vb = std::pow (vh, 0.4996667741545416);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            shelf.b0 = (vh + vb * k / q + k * k) / a0;
+            shelf.b1 = 2.0 * (k * k - vh) / a0;
+            shelf.b2 = (vh - vb * k / q + k * k) / a0;
+            shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+            shelf.a2 = (1.0 - k / q + k * k) / a0;
+        }
+
+        // Stage 2: the RLB high-pass.
+        {
+            const auto f0 = 38.13547087602444;
+            const auto q = 0.5003270373238773;
+
+            const auto k = std::tan (juce::MathConstants<double>::pi * f0 / sampleRate);
+            const auto a0 = 1.0 + k / q + k * k;
+
+            highPass.b0 = 1.0;
+            highPass.b1 = -2.0;
+            highPass.b2 = 1.0;
+            highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+            highPass.a2 = (1.0 - k / q + k * k) / a0;
+        }
+    }
+
+    void finishSubBlock() noexcept
+    {
+        const auto slot = (size_t) (subBlockIndex % shortTermSubBlocks);
+        const auto momentarySlot = (size_t) (subBlockIndex % momentarySubBlocks);
+        double programPower = 0.0;
+
+        for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+        {
+            const auto power = (double) weights[ch] * subBlockSquares[ch] / (double) samplesPerSubBlock;
+            subBlockSquares[ch] = 0.0;
+            programPower += power;
+
+            channelMomentarySum[ch] += power - channelRing[momentarySlot][ch];
+            channelRing[momentarySlot][ch] = power;
+        }
+
+        // The momentary window's oldest sub-block is 4 back; the short-term window's is the
+        // one being overwritten.
+        momentarySum += programPower - programRing[(size_t) ((subBlockIndex + shortTermSubBlocks - momentarySubBlocks) % shortTermSubBlocks)];
+        shortTermSum += programPower - programRing[slot];
+        programRing[slot] = programPower;
+
+        ++subBlockIndex;
+        subBlockFill = 0;
+
+        // Running sums drift with rounding; rebuild them exactly once per short-term window.
+        if (slot == shortTermSubBlocks - 1)
+            recomputeRunningSums();
+
+        const auto momentaryPower = juce::jmax (0.0, momentarySum) / momentarySubBlocks;
+        const auto shortTermPower = juce::jmax (0.0, shortTermSum) / shortTermSubBlocks;
+
+        if (subBlockIndex >= momentarySubBlocks)
+            addGatingBlock (momentaryPower);
+
+        published.momentary.store (toLufs (momentaryPower), std::memory_order_relaxed);
+        published.shortTerm.store (subBlockIndex >= shortTermSubBlocks ? toLufs (shortTermPower) : silenceLufs,
+                                   std::memory_order_relaxed);
+
+        for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+            published.channelMomentary[ch].store (toLufs (juce::jmax (0.0, channelMomentarySum[ch]) / momentarySubBlocks),
+                                                  std::memory_order_relaxed);
+    }
+
+    void recomputeRunningSums() noexcept
+    {
+        shortTermSum = 0.0;
+        for (auto power : programRing)
+            shortTermSum += power;
+
+        momentarySum = 0.0;
+        for (int back = 1; back <= momentarySubBlocks; ++back)
+            momentarySum += programRing[(size_t) ((subBlockIndex - back + shortTermSubBlocks) % shortTermSubBlocks)];
+
+        channelMomentarySum.fill (0.0);
+        for (const auto& row : channelRing)
+            for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+                channelMomentarySum[ch] += row[ch];
+    }
+
+    void addGatingBlock (double power) noexcept
+    {
+        const auto lufs = toLufs (power);
+        if (lufs <= absoluteGateLufs)
+            return;
+
+        const auto bin = juce::jlimit (0, numHistogramBins - 1, (int) ((lufs - absoluteGateLufs) * histogramBinsPerLu));
+        ++histogramCounts[(size_t) bin];
+        histogramPower[(size_t) bin] += power;
+        gatedPowerSum += power;
+        ++gatedBlockCount;
+
+        // Relative gate from the mean of everything above the absolute gate, then the mean
+        // of the blocks above it. The threshold is resolved to the histogram bin.
+        const auto relativeGate = toLufs (gatedPowerSum / (double) gatedBlockCount) + relativeGateLu;
+        const auto firstBin = juce::jlimit (0, numHistogramBins,
+                                            (int) std::ceil ((relativeGate - absoluteGateLufs) * histogramBinsPerLu));
+
+        double sum = 0.0;
+        std::uint64_t count = 0;
+
+        for (auto b = (size_t) firstBin; b < (size_t) numHistogramBins; ++b)
+        {
+            sum += histogramPower[b];
+            count += histogramCounts[b];
+        }
+
+        published.integrated.store (count > 0 ? toLufs (sum / (double) count) : silenceLufs, std::memory_order_relaxed);
+    }
+
+    void clear() noexcept
+    {
+        shelfZ1.fill (0.0);
+        shelfZ2.fill (0.0);
+        highPassZ1.fill (0.0);
+        highPassZ2.fill (0.0);
+        subBlockSquares.fill (0.0);
+
+        for (auto& row : channelRing)
+            row.fill (0.0);
+
+        channelMomentarySum.fill (0.0);
+        programRing.fill (0.0);
+        momentarySum = shortTermSum = 0.0;
+        subBlockFill = 0;
+        subBlockIndex = 0;
+
+        histogramCounts.fill (0);
+        histogramPower.fill (0.0);
+        gatedPowerSum = 0.0;
+        gatedBlockCount = 0;
+
+        published.momentary.store (silenceLufs, std::memory_order_relaxed);
+        published.shortTerm.store (silenceLufs, std::memory_order_relaxed);
+        published.integrated.store (silenceLufs, std::memory_order_relaxed);
+
+        for (auto& value : published.channelMomentary)
+            value.store (silenceLufs, std::memory_order_relaxed);
+    }
+
+    Biquad shelf, highPass;
+    std::array<float, maxChannels> weights {};
+    int numChannels = 0;
+
+    std::array<double, maxChannels> shelfZ1 {}, shelfZ2 {}, highPassZ1 {}, highPassZ2 {};
+    std::array<double, maxChannels> subBlockSquares {};
+    int samplesPerSubBlock = 4800;
+    int subBlockFill = 0;
+    std::int64_t subBlockIndex = 0;
+
+    std::array<std::array<double, maxChannels>, momentarySubBlocks> channelRing {};
+    std::array<double, maxChannels> channelMomentarySum {};
+    std::array<double, shortTermSubBlocks> programRing {};
+    double momentarySum = 0.0;
+    double shortTermSum = 0.0;
+
+    std::array<std::uint32_t, numHistogramBins> histogramCounts {};
+    std::array<double, numHistogramBins> histogramPower {};
+    double gatedPowerSum = 0.0;
+    std::uint64_t gatedBlockCount = 0;
+
+    struct Published
+    {
+        std::atomic<float> momentary { silenceLufs };
+        std::atomic<float> shortTerm { silenceLufs };
+        std::atomic<float> integrated { silenceLufs };
+        std::atomic<int> numChannels { 0 };
+        std::array<std::atomic<float>, maxChannels> channelMomentary {};
+    };
+
+    Published published;
+    std::atomic<bool> resetRequested { false };
+};
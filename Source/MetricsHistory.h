@@ -0,0 +1,96 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+// Ring of the most recent per-block metrics frames. One writer (the audio thread) and any
+// number of readers, none of which ever block: each slot carries a sequence number that is
+// odd while the writer is inside it, and a reader that sees it change while copying knows
+// the slot was overwritten under it. Frames are numbered from 0 since construction, so a
+// reader keeps its own cursor and can drain everything published since its last visit, or
+// look a few seconds back.
+template <typename Metrics>
+class MetricsHistory
+{
+public:
+    static constexpr int maxChannels = 16;
+
+    struct Frame
+    {
+        juce::int64 hostSamplePosition = -1;   // host timeline at the block start; -1 when the host gives none
+        juce::int64 samplePosition = 0;        // processor sample clock at the block start
+        double timestampMs = 0.0;              // Time::getMillisecondCounterHiRes() when published
+        int numSamples = 0;
+        int numChannels = 0;
+        std::array<Metrics, maxChannels> channels {};
+    };
+
+    /** capacity is rounded up to a power of two. */
+    explicit MetricsHistory (int capacity)
+        : size (juce::nextPowerOfTwo (juce::jmax (2, capacity))),
+          slots (std::make_unique<Slot[]> ((size_t) size))
+    {
+    }
+
+    /** Writer only. */
+    void push (const Frame& frame) noexcept
+    {
+        const auto index = written.load (std::memory_order_relaxed);
+        auto& slot = slots[(size_t) (index & (size - 1))];
+        const auto sequence = slot.sequence.load (std::memory_order_relaxed);
+
+        slot.sequence.store (sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+        slot.frame = frame;
+        slot.sequence.store (sequence + 2, std::memory_order_release);
+
+        written.store (index + 1, std::memory_order_release);
+    }
+
+    /** Number of frames published so far; the newest is getNumWritten() - 1. */
+    juce::int64 getNumWritten() const noexcept     { return written.load (std::memory_order_acquire); }
+
+    /** The oldest frame number that can still be read. */
+    juce::int64 getOldestAvailable() const noexcept
+    {
+        // One slot of margin: the writer may already be inside the oldest one.
+        return juce::jmax ((juce::int64) 0, getNumWritten() - size + 1);
+    }
+
+    int getCapacity() const noexcept               { return size; }
+
+    /** Copies frame frameNumber into dest. Returns false if it has not been published yet
+        or has already been overwritten. */
+    bool read (juce::int64 frameNumber, Frame& dest) const noexcept
+    {
+        if (frameNumber < getOldestAvailable() || frameNumber >= getNumWritten())
+            return false;
+
+        const auto& slot = slots[(size_t) (frameNumber & (size - 1))];
+        const auto before = slot.sequence.load (std::memory_order_acquire);
+        if ((before & 1u) != 0)
+            return false;
+
+        dest = slot.frame;
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+        const auto after = slot.sequence.load (std::memory_order_relaxed);
+
+        return before == after && frameNumber >= getOldestAvailable();
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence { 0 };
+        Frame frame;
+    };
+
+    const int size;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<juce::int64> written { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (MetricsHistory)
+};
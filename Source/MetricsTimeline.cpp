@@ -0,0 +1,487 @@
+#include "MetricsTimeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr int fileVersion = 1;
+    constexpr int headerColumns = 4;        // sample position, host position, momentary, short-term
+    constexpr int columnsPerChannel = 5;    // rms, peak, low, mid, high
+    constexpr size_t chunkHeaderSize = 4 + 4 + 8 + 8 + 4;
+    constexpr juce::int64 levelFloor = -1200;
+
+    int numColumnsFor (int numChannels) noexcept
+    {
+        return headerColumns + columnsPerChannel * numChannels;
+    }
+
+    juce::int64 quantiseLevel (float value) noexcept
+    {
+        if (value <= 1.0e-6f)
+            return levelFloor;
+
+        return (juce::int64) std::lround (juce::jlimit (-120.0f, 60.0f, 20.0f * std::log10 (value)) * 10.0f);
+    }
+
+    float dequantiseLevel (juce::int64 value) noexcept
+    {
+        return value <= levelFloor ? 0.0f : std::pow (10.0f, (float) value / 200.0f);
+    }
+
+    juce::int64 quantiseLoudness (float lufs) noexcept
+    {
+        return (juce::int64) std::lround (juce::jlimit (-120.0f, 30.0f, lufs) * 10.0f);
+    }
+
+    void writeVarint (juce::MemoryOutputStream& out, juce::int64 value)
+    {
+        // Zigzag keeps small negative deltas small.
+        auto encoded = ((juce::uint64) value << 1) ^ (juce::uint64) (value >> 63);
+
+        while (encoded >= 0x80)
+        {
+            out.writeByte ((char) ((encoded & 0x7f) | 0x80));
+            encoded >>= 7;
+        }
+
+        out.writeByte ((char) encoded);
+    }
+
+    bool readVarint (const juce::uint8*& data, const juce::uint8* end, juce::int64& value) noexcept
+    {
+        juce::uint64 encoded = 0;
+
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (data == end)
+                return false;
+
+            const auto byte = *data++;
+            encoded |= (juce::uint64) (byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+            {
+                value = (juce::int64) (encoded >> 1) ^ -(juce::int64) (encoded & 1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    T readLittleEndian (const juce::uint8* data) noexcept
+    {
+        T value {};
+        std::memcpy (&value, data, sizeof (T));
+        return value;   // both supported targets are little endian
+    }
+}
+
+//==============================================================================
+void MetricsTimelineFrameBuilder::prepare (double sampleRate, double framesPerSecond) noexcept
+{
+    samplesPerFrame = juce::jmax (1, juce::roundToInt (sampleRate / framesPerSecond));
+    reset();
+}
+
+void MetricsTimelineFrameBuilder::reset() noexcept
+{
+    pendingSamples = 0;
+    recordedSamples = 0;
+}
+
+void MetricsTimelineFrameBuilder::fold (const MetricsTimelineFrame& block, int offsetInBlock, int numSamples) noexcept
+{
+    if (pendingSamples == 0)
+    {
+        pending.samplePosition = recordedSamples;
+        pending.hostSamplePosition = block.hostSamplePosition >= 0 ? block.hostSamplePosition + offsetInBlock : -1;
+        pending.numChannels = block.numChannels;
+        pending.channels = {};
+        rmsPowerSums = {};
+    }
+
+    const auto weight = (float) numSamples;
+    const auto channelsToFold = juce::jmin (pending.numChannels, block.numChannels);
+
+    for (int ch = 0; ch < channelsToFold; ++ch)
+    {
+        const auto& in = block.channels[(size_t) ch];
+        auto& out = pending.channels[(size_t) ch];
+
+        out.peak = juce::jmax (out.peak, in.peak);
+        rmsPowerSums[(size_t) ch] += (double) in.rms * in.rms * weight;
+        out.low += in.low * weight;
+        out.mid += in.mid * weight;
+        out.high += in.high * weight;
+    }
+
+    pending.momentaryLufs = block.momentaryLufs;
+    pending.shortTermLufs = block.shortTermLufs;
+    pendingSamples += numSamples;
+    recordedSamples += numSamples;
+}
+
+const MetricsTimelineFrame& MetricsTimelineFrameBuilder::finishFrame() noexcept
+{
+    const auto total = (float) pendingSamples;
+    for (int ch = 0; ch < pending.numChannels; ++ch)
+    {
+        auto& out = pending.channels[(size_t) ch];
+        out.rms = (float) std::sqrt (rmsPowerSums[(size_t) ch] / total);
+        out.low /= total;
+        out.mid /= total;
+        out.high /= total;
+    }
+
+    pendingSamples = 0;
+    return pending;
+}
+
+//==============================================================================
+MetricsTimelineWriter::~MetricsTimelineWriter()
+{
+    close();
+}
+
+bool MetricsTimelineWriter::open (const juce::File& file, double sampleRate, const juce::StringArray& channelNames)
+{
+    close();
+
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+
+    auto newStream = std::make_unique<juce::FileOutputStream> (file);
+    if (! newStream->openedOk())
+        return false;
+
+    stream = std::move (newStream);
+    currentFile = file;
+    numChannels = juce::jmin (channelNames.size(), MetricsTimelineFrame::maxChannels);
+
+    stream->write ("AVTL", 4);
+    stream->writeInt (fileVersion);
+    stream->writeDouble (sampleRate);
+    stream->writeDouble (framesPerSecond);
+    stream->writeInt (numChannels);
+    stream->writeInt (framesPerChunk);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        stream->writeString (channelNames[ch]);
+
+    columns.assign ((size_t) numColumnsFor (numChannels), {});
+    for (auto& column : columns)
+        column.reserve (framesPerChunk);
+    framesInChunk = 0;
+
+    return true;
+}
+
+void MetricsTimelineWriter::close()
+{
+    if (stream == nullptr)
+        return;
+
+    if (framesInChunk > 0)
+        writeChunk();
+
+    stream->flush();
+    stream.reset();
+}
+
+void MetricsTimelineWriter::append (const MetricsTimelineFrame& frame)
+{
+    if (framesInChunk == 0)
+        chunkFirstSample = frame.samplePosition;
+
+    chunkLastSample = frame.samplePosition;
+
+    size_t column = 0;
+    columns[column++].push_back (frame.samplePosition);
+    columns[column++].push_back (frame.hostSamplePosition);
+    columns[column++].push_back (quantiseLoudness (frame.momentaryLufs));
+    columns[column++].push_back (quantiseLoudness (frame.shortTermLufs));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        // A layout change mid-recording leaves missing channels silent.
+        const auto values = ch < frame.numChannels ? frame.channels[(size_t) ch] : MetricsTimelineFrame::Channel {};
+        columns[column++].push_back (quantiseLevel (values.rms));
+        columns[column++].push_back (quantiseLevel (values.peak));
+        columns[column++].push_back (quantiseLevel (values.low));
+        columns[column++].push_back (quantiseLevel (values.mid));
+        columns[column++].push_back (quantiseLevel (values.high));
+    }
+
+    if (++framesInChunk == framesPerChunk)
+        writeChunk();
+}
+
+void MetricsTimelineWriter::writeChunk()
+{
+    juce::MemoryOutputStream payload;
+
+    for (auto& column : columns)
+    {
+        juce::int64 previous = 0;
+        for (const auto value : column)
+        {
+            writeVarint (payload, value - previous);
+            previous = value;
+        }
+
+        column.clear();
+    }
+
+    stream->write ("AVCK", 4);
+    stream->writeInt (framesInChunk);
+    stream->writeInt64 (chunkFirstSample);
+    stream->writeInt64 (chunkLastSample);
+    stream->writeInt ((int) payload.getDataSize());
+    stream->write (payload.getData(), payload.getDataSize());
+
+    // Flushed per chunk, so a crash loses at most the chunk being built.
+    stream->flush();
+    framesInChunk = 0;
+}
+
+//==============================================================================
+MetricsTimelineRecorder::MetricsTimelineRecorder()
+    : juce::Thread ("AtmosViz timeline writer")
+{
+    queue.resize (queueCapacity);
+}
+
+MetricsTimelineRecorder::~MetricsTimelineRecorder()
+{
+    stop();
+}
+
+bool MetricsTimelineRecorder::start (const juce::File& file, double sampleRate, const juce::StringArray& channelNames)
+{
+    stop();
+
+    if (! writer.open (file, sampleRate, channelNames))
+        return false;
+
+    // Frames the audio thread queued after the last stop() drained belong to no recording.
+    {
+        const auto stale = fifo.read (fifo.getNumReady());
+        juce::ignoreUnused (stale);
+    }
+
+    // The audio thread may still be in addBlock() for the last recording; it prepares its
+    // builder itself when it sees the new generation.
+    recordingSampleRate.store (sampleRate, std::memory_order_relaxed);
+    droppedFrames.store (0, std::memory_order_relaxed);
+
+    startThread (juce::Thread::Priority::low);
+    generation.fetch_add (1, std::memory_order_release);
+    recording.store (true, std::memory_order_release);
+    return true;
+}
+
+void MetricsTimelineRecorder::stop()
+{
+    recording.store (false, std::memory_order_release);
+    stopThread (2000);
+
+    if (! writer.isOpen())
+        return;
+
+    drainQueue();
+    writer.close();
+}
+
+void MetricsTimelineRecorder::addBlock (const MetricsTimelineFrame& block, int numSamples) noexcept
+{
+    if (! recording.load (std::memory_order_acquire))
+        return;
+
+    const auto currentGeneration = generation.load (std::memory_order_acquire);
+    if (currentGeneration != seenGeneration)
+    {
+        builder.prepare (recordingSampleRate.load (std::memory_order_relaxed), framesPerSecond);
+        seenGeneration = currentGeneration;
+    }
+
+    builder.addBlock (block, numSamples, [this] (const MetricsTimelineFrame& frame)
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 == 0)
+        {
+            droppedFrames.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+
+        queue[(size_t) scope.startIndex1] = frame;
+    });
+}
+
+void MetricsTimelineRecorder::run()
+{
+    while (! threadShouldExit())
+    {
+        drainQueue();
+        wait (100);
+    }
+}
+
+void MetricsTimelineRecorder::drainQueue()
+{
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        writer.append (queue[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        writer.append (queue[(size_t) (scope.startIndex2 + i)]);
+}
+
+//==============================================================================
+MetricsTimelineReader::MetricsTimelineReader (const juce::File& file)
+    : mapping (std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly))
+{
+    const auto* data = static_cast<const juce::uint8*> (mapping->getData());
+    const auto size = mapping->getSize();
+
+    if (data == nullptr || size < 4 || std::memcmp (data, "AVTL", 4) != 0)
+        return;
+
+    juce::MemoryInputStream header (data, size, false);
+    header.setPosition (4);
+
+    if (header.readInt() != fileVersion)
+        return;
+
+    sampleRate = header.readDouble();
+    frameRate = header.readDouble();
+    numChannels = header.readInt();
+    framesPerChunk = header.readInt();
+
+    if (sampleRate <= 0.0 || frameRate <= 0.0 || numChannels < 0 || numChannels > MetricsTimelineFrame::maxChannels
+        || framesPerChunk <= 0 || framesPerChunk > 65536)
+        return;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelNames.add (header.readString());
+
+    // Only the chunk headers are touched here; payloads are decoded on demand.
+    auto offset = (size_t) header.getPosition();
+
+    while (offset + chunkHeaderSize <= size && std::memcmp (data + offset, "AVCK", 4) == 0)
+    {
+        ChunkInfo chunk;
+        chunk.numFrames = readLittleEndian<juce::int32> (data + offset + 4);
+        chunk.firstSample = readLittleEndian<juce::int64> (data + offset + 8);
+        chunk.lastSample = readLittleEndian<juce::int64> (data + offset + 16);
+        chunk.payloadSize = (size_t) readLittleEndian<juce::uint32> (data + offset + 24);
+        chunk.payloadOffset = offset + chunkHeaderSize;
+        chunk.firstFrame = numFrames;
+
+        // A chunk cut short by a crash ends the readable part of the file.
+        if (chunk.numFrames <= 0 || chunk.numFrames > framesPerChunk || chunk.payloadOffset + chunk.payloadSize > size)
+            break;
+
+        chunks.push_back (chunk);
+        numFrames += chunk.numFrames;
+        offset = chunk.payloadOffset + chunk.payloadSize;
+    }
+
+    decoded.resize ((size_t) numColumnsFor (numChannels) * (size_t) framesPerChunk);
+    valid = true;
+}
+
+int MetricsTimelineReader::findChunk (juce::int64 frameIndex) const noexcept
+{
+    const auto it = std::upper_bound (chunks.begin(), chunks.end(), frameIndex,
+                                      [] (juce::int64 index, const ChunkInfo& chunk) { return index < chunk.firstFrame; });
+    return (int) (it - chunks.begin()) - 1;
+}
+
+juce::int64 MetricsTimelineReader::findFrame (juce::int64 samplePosition)
+{
+    if (chunks.empty())
+        return 0;
+
+    const auto it = std::upper_bound (chunks.begin(), chunks.end(), samplePosition,
+                                      [] (juce::int64 position, const ChunkInfo& chunk) { return position < chunk.firstSample; });
+    const auto chunkIndex = juce::jmax (0, (int) (it - chunks.begin()) - 1);
+
+    if (! decodeChunk (chunkIndex))
+        return 0;
+
+    // Column 0 is the sample position.
+    const auto& chunk = chunks[(size_t) chunkIndex];
+    const auto* positions = decoded.data();
+    const auto frame = std::upper_bound (positions, positions + chunk.numFrames, samplePosition) - positions;
+
+    return chunk.firstFrame + juce::jmax ((juce::int64) 0, (juce::int64) frame - 1);
+}
+
+bool MetricsTimelineReader::readFrame (juce::int64 frameIndex, MetricsTimelineFrame& dest)
+{
+    if (frameIndex < 0 || frameIndex >= numFrames)
+        return false;
+
+    const auto chunkIndex = findChunk (frameIndex);
+    if (chunkIndex < 0 || ! decodeChunk (chunkIndex))
+        return false;
+
+    const auto frame = (size_t) (frameIndex - chunks[(size_t) chunkIndex].firstFrame);
+    auto column = [this, frame] (int index) { return decoded[(size_t) index * (size_t) framesPerChunk + frame]; };
+
+    dest.samplePosition = column (0);
+    dest.hostSamplePosition = column (1);
+    dest.momentaryLufs = (float) column (2) / 10.0f;
+    dest.shortTermLufs = (float) column (3) / 10.0f;
+    dest.numChannels = numChannels;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto base = headerColumns + columnsPerChannel * ch;
+        auto& values = dest.channels[(size_t) ch];
+        values.rms = dequantiseLevel (column (base));
+        values.peak = dequantiseLevel (column (base + 1));
+        values.low = dequantiseLevel (column (base + 2));
+        values.mid = dequantiseLevel (column (base + 3));
+        values.high = dequantiseLevel (column (base + 4));
+    }
+
+    return true;
+}
+
+bool MetricsTimelineReader::decodeChunk (int chunkIndex)
+{
+    if (chunkIndex == decodedChunk)
+        return true;
+
+    const auto& chunk = chunks[(size_t) chunkIndex];
+    const auto* data = static_cast<const juce::uint8*> (mapping->getData()) + chunk.payloadOffset;
+    const auto* end = data + chunk.payloadSize;
+
+    for (int columnIndex = 0; columnIndex < numColumnsFor (numChannels); ++columnIndex)
+    {
+        auto* column = decoded.data() + (size_t) columnIndex * (size_t) framesPerChunk;
+        juce::int64 value = 0;
+
+        for (int frame = 0; frame < chunk.numFrames; ++frame)
+        {
+            juce::int64 delta = 0;
+            if (! readVarint (data, end, delta))
+            {
+                decodedChunk = -1;
+                return false;
+            }
+
+            value += delta;
+            column[frame] = value;
+        }
+    }
+
+    decodedChunk = chunkIndex;
+    return true;
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Recording of the metrics stream for a whole pass, and random access to it afterwards.
+//
+// File layout (little endian):
+//   header  "AVTL", version, sample rate, frame rate, channel count, frames per chunk,
+//           then one null-terminated UTF-8 name per channel
+//   chunks  "AVCK", frame count, first and last recording sample position, payload size,
+//           then the payload: one column per value, each a run of zigzag varint deltas
+//           between consecutive frames of the chunk
+// Levels are stored as 0.1 dB steps and loudness as 0.1 LU steps, so consecutive frames
+// usually differ by a byte. Every chunk decodes on its own; the reader indexes the chunk
+// headers when it opens the file, which also recovers a file whose recording never stopped
+// cleanly up to its last complete chunk.
+
+struct MetricsTimelineFrame
+{
+    static constexpr int maxChannels = 16;
+
+    struct Channel
+    {
+        float rms = 0.0f;
+        float peak = 0.0f;
+        float low = 0.0f;
+        float mid = 0.0f;
+        float high = 0.0f;
+    };
+
+    juce::int64 samplePosition = 0;        // recording clock: samples since the recording started
+    juce::int64 hostSamplePosition = -1;   // host timeline; -1 when unknown
+    float momentaryLufs = -120.0f;
+    float shortTermLufs = -120.0f;
+    int numChannels = 0;
+    std::array<Channel, maxChannels> channels {};
+};
+
+// Anything that can drive the display from stored frames in place of the live stream: a
+// recorded timeline, or the standalone file player's analysis cache. Message thread only.
+class MetricsFrameSource
+{
+public:
+    virtual ~MetricsFrameSource() = default;
+
+    virtual bool isOpen() const noexcept = 0;
+
+    /** One name per frame channel, matched against the speakers' display names. */
+    virtual const juce::StringArray& getChannelNames() const noexcept = 0;
+
+    /** Called once per display tick; copies the frame to show now. */
+    virtual bool advance (MetricsTimelineFrame& dest) = 0;
+};
+
+// Folds per-block metrics into frames of a fixed length. A block is split at frame
+// boundaries, so one block can complete several frames and its remainder starts the next.
+// Peaks are the maximum over the frame (a block's peak counts in every frame it touches);
+// RMS and bands are power and magnitude means weighted by the samples each block puts in
+// the frame. Frames are stamped with the builder's own sample clock, which starts at 0 on
+// reset() and stays monotonic when the source prepares again. Realtime safe.
+class MetricsTimelineFrameBuilder
+{
+public:
+    void prepare (double sampleRate, double framesPerSecond) noexcept;
+    void reset() noexcept;
+
+    /** Folds a block in and calls onFrame (const MetricsTimelineFrame&) for each frame it
+        completes, in order. The block's samplePosition is ignored. */
+    template <typename FrameCallback>
+    void addBlock (const MetricsTimelineFrame& block, int numSamples, FrameCallback&& onFrame)
+    {
+        for (int offset = 0; offset < numSamples;)
+        {
+            const auto count = juce::jmin (numSamples - offset, samplesPerFrame - pendingSamples);
+            fold (block, offset, count);
+            offset += count;
+
+            if (pendingSamples == samplesPerFrame)
+                onFrame (finishFrame());
+        }
+    }
+
+    /** Completes the partial frame, if any, from the samples it has so far; for the end of
+        a pass, where no more blocks will come to fill it. */
+    template <typename FrameCallback>
+    void flush (FrameCallback&& onFrame)
+    {
+        if (pendingSamples > 0)
+            onFrame (finishFrame());
+    }
+
+    int getSamplesPerFrame() const noexcept                  { return samplesPerFrame; }
+
+private:
+    void fold (const MetricsTimelineFrame& block, int offsetInBlock, int numSamples) noexcept;
+    const MetricsTimelineFrame& finishFrame() noexcept;
+
+    MetricsTimelineFrame pending;
+    std::array<double, MetricsTimelineFrame::maxChannels> rmsPowerSums {};
+    int pendingSamples = 0;
+    juce::int64 recordedSamples = 0;
+    int samplesPerFrame = 1920;
+};
+
+// Writes finished frames to a timeline file, one compressed chunk per framesPerChunk frames.
+// Single threaded: the recorder calls it from its writer thread, the batch analyser directly.
+class MetricsTimelineWriter
+{
+public:
+    static constexpr double framesPerSecond = 25.0;
+    static constexpr int framesPerChunk = 256;
+
+    ~MetricsTimelineWriter();
+
+    bool open (const juce::File& file, double sampleRate, const juce::StringArray& channelNames);
+    void append (const MetricsTimelineFrame& frame);
+
+    /** Writes the partial chunk, if any, and closes the file. */
+    void close();
+
+    bool isOpen() const noexcept                    { return stream != nullptr; }
+    juce::File getFile() const                      { return currentFile; }
+
+private:
+    void writeChunk();
+
+    juce::File currentFile;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    int numChannels = 0;
+    std::vector<std::vector<juce::int64>> columns;   // quantised values of the chunk being built
+    int framesInChunk = 0;
+    juce::int64 chunkFirstSample = 0;
+    juce::int64 chunkLastSample = 0;
+};
+
+// Records the live metrics stream: the audio thread builds frames and queues them, and a
+// background thread writes them out.
+class MetricsTimelineRecorder : private juce::Thread
+{
+public:
+    static constexpr double framesPerSecond = MetricsTimelineWriter::framesPerSecond;
+    static constexpr int framesPerChunk = MetricsTimelineWriter::framesPerChunk;
+
+    MetricsTimelineRecorder();
+    ~MetricsTimelineRecorder() override;
+
+    /** Message thread: creates the file and starts recording. */
+    bool start (const juce::File& file, double sampleRate, const juce::StringArray& channelNames);
+
+    /** Message thread: writes what is queued and closes the file. */
+    void stop();
+
+    bool isRecording() const noexcept               { return recording.load (std::memory_order_acquire); }
+    juce::File getFile() const                      { return writer.getFile(); }
+    int getDroppedFrames() const noexcept           { return droppedFrames.load (std::memory_order_relaxed); }
+
+    /** Audio thread, only while recording: folds one block in and queues each frame it
+        completes. The frame clock restarts with every recording. */
+    void addBlock (const MetricsTimelineFrame& block, int numSamples) noexcept;
+
+private:
+    static constexpr int queueCapacity = 128;
+
+    void run() override;
+    void drainQueue();
+
+    std::vector<MetricsTimelineFrame> queue;
+    juce::AbstractFifo fifo { queueCapacity };
+    std::atomic<bool> recording { false };
+    std::atomic<int> generation { 0 };   // bumped by start(), so the audio side drops a stale partial frame
+    std::atomic<double> recordingSampleRate { 48000.0 };   // published with the generation
+    std::atomic<int> droppedFrames { 0 };
+
+    // Audio thread only.
+    MetricsTimelineFrameBuilder builder;
+    int seenGeneration = -1;
+
+    // Writer thread, and the message thread while stopped.
+    MetricsTimelineWriter writer;
+
+    JUCE_DECLARE_NON_COPYABLE (MetricsTimelineRecorder)
+};
+
+class MetricsTimelineReader
+{
+public:
+    explicit MetricsTimelineReader (const juce::File& file);
+
+    bool isValid() const noexcept                   { return valid; }
+    double getSampleRate() const noexcept           { return sampleRate; }
+    double getFrameRate() const noexcept            { return frameRate; }
+    int getNumChannels() const noexcept             { return numChannels; }
+    const juce::StringArray& getChannelNames() const noexcept { return channelNames; }
+    juce::int64 getNumFrames() const noexcept       { return numFrames; }
+    double getDurationSeconds() const noexcept      { return (double) numFrames / frameRate; }
+
+    /** Index of the last frame starting at or before samplePosition on the recording
+        clock, by binary search over the chunks and then over the frame. */
+    juce::int64 findFrame (juce::int64 samplePosition);
+
+    /** Decodes one frame; consecutive reads within a chunk reuse the decoded chunk. */
+    bool readFrame (juce::int64 frameIndex, MetricsTimelineFrame& dest);
+
+private:
+    struct ChunkInfo
+    {
+        size_t payloadOffset = 0;
+        size_t payloadSize = 0;
+        juce::int64 firstFrame = 0;
+        int numFrames = 0;
+        juce::int64 firstSample = 0;
+        juce::int64 lastSample = 0;
+    };
+
+    int findChunk (juce::int64 frameIndex) const noexcept;
+    bool decodeChunk (int chunkIndex);
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    bool valid = false;
+    double sampleRate = 48000.0;
+    double frameRate = MetricsTimelineRecorder::framesPerSecond;
+    int numChannels = 0;
+    int framesPerChunk = MetricsTimelineRecorder::framesPerChunk;
+    juce::StringArray channelNames;
+    std::vector<ChunkInfo> chunks;
+    juce::int64 numFrames = 0;
+
+    int decodedChunk = -1;
+    std::vector<juce::int64> decoded;   // column-major: column * framesPerChunk + frame
+
+    JUCE_DECLARE_NON_COPYABLE (MetricsTimelineReader)
+};
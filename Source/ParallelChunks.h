@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Runs a loop over [0, numItems) in chunks on a thread pool, with the calling thread working
+// alongside. The pool jobs are created once and queued again for every loop, and the loop
+// body is called through a plain function pointer, so running a loop allocates nothing of its
+// own. One loop at a time: run() returns once every chunk is done and the jobs are back.
+class ParallelChunks
+{
+public:
+    explicit ParallelChunks (int numThreads)
+        : pool (numThreads)
+    {
+        for (int i = 0; i < numThreads; ++i)
+            jobs.push_back (std::make_unique<ChunkJob> (*this));
+    }
+
+    ~ParallelChunks()
+    {
+        pool.removeAllJobs (true, -1);
+    }
+
+    template <typename Work>
+    void run (int numItems, Work& work)
+    {
+        invoke = [] (void* target, int start, int end) { (*static_cast<Work*> (target)) (start, end); };
+        context = &work;
+        runLoop (numItems);
+    }
+
+private:
+    struct ChunkJob : public juce::ThreadPoolJob
+    {
+        explicit ChunkJob (ParallelChunks& ownerToServe)
+            : juce::ThreadPoolJob ("Render chunks"), owner (ownerToServe) {}
+
+        JobStatus runJob() override
+        {
+            owner.runChunks();
+            return jobHasFinished;
+        }
+
+        ParallelChunks& owner;
+    };
+
+    void runLoop (int numItems)
+    {
+        const int numWorkers = juce::jmin ((int) jobs.size(), numItems - 1);
+
+        if (numWorkers <= 0)
+        {
+            invoke (context, 0, juce::jmax (0, numItems));
+            return;
+        }
+
+        loopItems = numItems;
+        numChunks = juce::jmin (numItems, (numWorkers + 1) * 4);
+        nextChunk = 0;
+
+        for (int i = 0; i < numWorkers; ++i)
+            pool.addJob (jobs[(size_t) i].get(), false);
+
+        runChunks();
+
+        // A job is only free to queue again once the pool has let go of it, which happens
+        // just after its last chunk.
+        for (int i = 0; i < numWorkers; ++i)
+            pool.waitForJobToFinish (jobs[(size_t) i].get(), -1);
+    }
+
+    void runChunks()
+    {
+        for (;;)
+        {
+            const int chunk = nextChunk.fetch_add (1);
+            if (chunk >= numChunks)
+                return;
+
+            const int start = (int) ((juce::int64) loopItems * chunk / numChunks);
+            const int end   = (int) ((juce::int64) loopItems * (chunk + 1) / numChunks);
+            invoke (context, start, end);
+        }
+    }
+
+    std::vector<std::unique_ptr<ChunkJob>> jobs;
+    juce::ThreadPool pool;
+
+    void (*invoke) (void*, int, int) = nullptr;
+    void* context = nullptr;
+    int loopItems = 0;
+    int numChunks = 0;
+    std::atomic<int> nextChunk { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelChunks)
+};
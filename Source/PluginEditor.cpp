@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
 
@@ -53,12 +54,73 @@ namespace
         { CameraPreset::InsideRight,  {  180.0f,   0.0f,   0.0f, insideOrbitBaseDistance,  true  } },
         { CameraPreset::InsideTop,    {    0.0f, -90.0f, -90.0f, insideTopBaseDistance,    true  } }
     } };
+
+    constexpr float heatmapMinDistance = 0.65f;
+    constexpr float sliceCeilingInset  = 0.05f;
+    constexpr int   sliceInsideTiles   = 8;
+    constexpr std::array<float, 5> slicePixelsPerMetre { 12.0f, 18.0f, 24.0f, 32.0f, 40.0f };
+
+    constexpr float bandBrightnessMin = 0.25f;
+    constexpr float bandBrightnessMax = 1.2f;
+    constexpr juce::uint32 bandShareNeutralArgb = 0xff383d47;
+
+    constexpr std::array<int, 5> volumeLateralCells  { 10, 14, 18, 24, 30 };
+    constexpr std::array<int, 5> volumeVerticalCells {  6,  8, 10, 13, 16 };
+    constexpr int    volumeTileSize       = 16;
+    constexpr float  volumeBaseSamples    = 72.0f;
+    constexpr float  volumeExtinction     = 2.2f;
+    constexpr float  volumeOpaqueAlpha    = 0.97f;
+    constexpr double volumeFrameBudgetMs  = 12.0;
+
+    // -6 / -12 / -18 dB of the tracked heatmap maximum, outermost shell last.
+    constexpr std::array<float, 3> isoThresholds   { 0.501f, 0.251f, 0.126f };
+    constexpr std::array<float, 3> isoColourRatios { 0.9f, 0.6f, 0.3f };
+    constexpr std::array<float, 3> isoAlphas       { 0.6f, 0.38f, 0.22f };
+    constexpr std::uint32_t isoInvalidMask = 0xffffffffu;
+
+    // Each grid cell is split into six tetrahedra around the 0-7 diagonal; corner bit 0 is +x
+    // (depth), bit 1 is +y (height), bit 2 is +z (width).
+    constexpr std::array<std::array<int, 4>, 6> isoCellTetrahedra { {
+        { 0, 1, 3, 7 }, { 0, 3, 2, 7 }, { 0, 2, 6, 7 }, { 0, 6, 4, 7 }, { 0, 4, 5, 7 }, { 0, 5, 1, 7 }
+    } };
+
+    struct VolumeQualityStep
+    {
+        int pixelDivisor;
+        float stepScale;
+    };
+
+    // Ordered from finest to coarsest; the renderer walks this table to stay inside its budget.
+    constexpr std::array<VolumeQualityStep, 6> volumeQualitySteps { {
+        { 2, 1.0f }, { 3, 1.0f }, { 3, 1.5f }, { 4, 1.5f }, { 4, 2.0f }, { 6, 2.5f }
+    } };
+
+    // Splits [0, numItems) into chunks and runs them on the pool, with the calling
+    // thread working alongside; without a pool the whole range runs here.
+    template <typename Work>
+    void parallelForChunks (ParallelChunks* pool, int numItems, Work&& work)
+    {
+        if (numItems <= 0)
+            return;
+
+        if (pool == nullptr)
+        {
+            work (0, numItems);
+            return;
+        }
+
+        pool->run (numItems, work);
+    }
+
+    constexpr const char* recordIdleTooltip = "Record every speaker's levels, bands and loudness to a timeline file";
 }
 
 SpeakerVisualizerComponent::SpeakerVisualizerComponent (AtmosVizAudioProcessor& p)
     : processor (p), roomDimensions (processor.getRoomDimensions())
 {
     syncSpeakersWithDefinitions();
+    rebuildColourLuts();
+    buildShapeTemplates();
 
     const auto widthHalf  = roomDimensions.width * 0.5f;
     const auto depthHalf  = roomDimensions.depth * 0.5f;
@@ -93,6 +155,8 @@ SpeakerVisualizerComponent::SpeakerVisualizerComponent (AtmosVizAudioProcessor&
     setCameraPreset (CameraPreset::OutsideHome);
     captureUserState();
 
+    renderPool = std::make_unique<ParallelChunks> (juce::jmax (1, juce::SystemStats::getNumCpus() - 1));
+
     setMouseCursor (juce::MouseCursor::DraggingHandCursor);
     startTimerHz (30);
 }
@@ -107,21 +171,155 @@ void SpeakerVisualizerComponent::refreshMetrics()
 {
     syncSpeakersWithDefinitions();
 
-    AtmosVizAudioProcessor::SpeakerMetricsArray latest;
-    processor.copyLatestMetrics (latest);
+    if (replaySource != nullptr && replaySource->isOpen())
+    {
+        applyReplayFrame();
+        return;
+    }
+
+    analysisTier = processor.getAnalysisTier();
+    processor.copyLatestCorrelations (correlations);
+    processor.copyLatestEnergyVectors (energyVectors);
+
+    // Drain every block published since the last tick. The newest frame gives the display
+    // state; instantaneous peaks are the maximum over all of them, so a transient between
+    // two ticks still reaches the markers. With no new frames the last state is kept.
+    const auto& history = processor.getMetricsHistory();
+    const auto newest = history.getNumWritten();
+    if (historyCursor < 0)
+        historyCursor = newest - 1;
+    historyCursor = juce::jlimit (history.getOldestAvailable(), newest, historyCursor);
+    bool firstFrame = true;
+
+    for (; historyCursor < newest; ++historyCursor)
+    {
+        if (! history.read (historyCursor, historyFrame))
+            continue;
+
+        for (size_t i = 0; i < speakers.size(); ++i)
+        {
+            auto& metrics = speakers[i].metrics;
+            const auto incoming = i < (size_t) historyFrame.numChannels ? historyFrame.channels[i]
+                                                                        : AtmosVizAudioProcessor::SpeakerMetrics {};
+            const auto peak = firstFrame ? incoming.peak : juce::jmax (metrics.peak, incoming.peak);
+            const auto truePeak = firstFrame ? incoming.truePeak : juce::jmax (metrics.truePeak, incoming.truePeak);
+
+            metrics = incoming;
+            metrics.peak = peak;
+            metrics.truePeak = truePeak;
+        }
+
+        firstFrame = false;
+    }
+
+    for (auto& speaker : speakers)
+        speaker.transientFlash *= 0.8f;
+
+    OnsetEvent onset;
+    while (processor.popOnsetEvent (onset))
+    {
+        if ((size_t) onset.channel < speakers.size())
+            speakers[(size_t) onset.channel].transientFlash = juce::jmax (speakers[(size_t) onset.channel].transientFlash,
+                                                                          0.4f + 0.6f * onset.strength);
+    }
+}
+
+void SpeakerVisualizerComponent::setReplaySource (MetricsFrameSource* source)
+{
+    replaySource = source;
+
+    // Pick up the live stream from its newest block again instead of draining what piled up.
+    historyCursor = -1;
+
+    for (auto& speaker : speakers)
+        speaker.transientFlash = 0.0f;
 
-    if (latest.size() < speakers.size())
-        latest.resize (speakers.size());
+    repaint();
+}
+
+void SpeakerVisualizerComponent::applyReplayFrame()
+{
+    OnsetEvent onset;
+    while (processor.popOnsetEvent (onset)) {}
+
+    if (replaySource->advance (replayFrame))
+        applyStoredFrame (replayFrame, replaySource->getChannelNames());
+}
+
+void SpeakerVisualizerComponent::applyStoredFrame (const MetricsTimelineFrame& frame, const juce::StringArray& names)
+{
+    // Stored frames keep levels and bands only: correlations, energy vectors and onsets are
+    // not recorded, so phantom links and flashes stay off during replay.
+    analysisTier = AnalysisGovernor::Tier::Full;
+    correlations = {};
+    energyVectors = {};
 
     for (size_t i = 0; i < speakers.size(); ++i)
     {
-        if (i < latest.size())
-            speakers[i].metrics = latest[i];
-        else
-            speakers[i].metrics = {};
+        auto& speaker = speakers[i];
+        speaker.transientFlash = 0.0f;
+
+        // Match channels by name so a recording still lines up after the layout changed;
+        // names it does not know fall back to the channel in the same position.
+        auto channel = names.indexOf (speaker.definition.displayName);
+        if (channel < 0)
+            channel = (int) i;
+
+        AtmosVizAudioProcessor::SpeakerMetrics metrics;
+
+        if (channel >= 0 && channel < frame.numChannels)
+        {
+            const auto& recorded = frame.channels[(size_t) channel];
+            metrics.rms = metrics.rmsLevel = recorded.rms;
+            metrics.peak = metrics.truePeak = metrics.level = metrics.peakHold = recorded.peak;
+            metrics.bands = { recorded.low, recorded.mid, recorded.high };
+        }
+
+        speaker.metrics = metrics;
     }
 }
 
+void SpeakerVisualizerComponent::prepareForExport (const SpeakerVisualizerComponent& viewToMatch)
+{
+    stopTimer();
+    exporting = true;
+    profilerOverlayVisible = false;
+
+    // Export renders whole frames on several workers side by side; splitting each frame over
+    // a pool of its own as well would only oversubscribe the cores.
+    renderPool.reset();
+    volumeQuality = 0;
+
+    setVisualizationMode (viewToMatch.visualizationMode);
+    setVisualizationScaleAdjustment (viewToMatch.visualizationScaleSliderValue);
+    setBandColourWeights (viewToMatch.bandColourWeights);
+    setHeatmapDensity (viewToMatch.heatmapDensityLevel);
+    setSlicePlane (viewToMatch.slicePlane);
+    setSliceOffset (viewToMatch.sliceOffset);
+    setPhantomLinksVisible (viewToMatch.phantomLinksVisible);
+
+    // The camera as it is now, including a drag that has not been stored as the user preset.
+    currentPreset = viewToMatch.currentPreset;
+    outsideUserState = viewToMatch.outsideUserState;
+    insideUserState = viewToMatch.insideUserState;
+    cameraInside = viewToMatch.cameraInside;
+    yaw = viewToMatch.yaw;
+    pitch = viewToMatch.pitch;
+    roll = viewToMatch.roll;
+    cameraBaseDistance = viewToMatch.cameraBaseDistance;
+    zoomFactor = viewToMatch.zoomFactor;
+    applyZoomFactorToCamera();
+}
+
+void SpeakerVisualizerComponent::renderExportFrame (const MetricsTimelineFrame& frame, const juce::StringArray& channelNames,
+                                                    juce::Graphics& g)
+{
+    jassert (exporting);
+
+    applyStoredFrame (frame, channelNames);
+    paint (g);
+}
+
 void SpeakerVisualizerComponent::syncSpeakersWithDefinitions()
 {
     const auto& defs = processor.getSpeakerDefinitions();
@@ -149,6 +347,8 @@ void SpeakerVisualizerComponent::syncSpeakersWithDefinitions()
     for (const auto& def : defs)
         speakers.push_back ({ def, {}, {}, {}, 0.0f });
 
+    labelSprites.clear();
+    labelLayoutAnchors.clear();
     updateHeatmapCache();
 }
 
@@ -645,8 +845,8 @@ void SpeakerVisualizerComponent::drawRoom (juce::Graphics& g)
         juce::Point<float> end;
     };
 
-    std::vector<EdgeProjection> hiddenEdges;
-    std::vector<EdgeProjection> visibleEdges;
+    FrameVector<EdgeProjection> hiddenEdges { FrameAllocator<EdgeProjection> (frameArena) };
+    FrameVector<EdgeProjection> visibleEdges { FrameAllocator<EdgeProjection> (frameArena) };
     hiddenEdges.reserve (roomEdges.size());
     visibleEdges.reserve (roomEdges.size());
 
@@ -776,6 +976,7 @@ void SpeakerVisualizerComponent::setBandColourWeights (BandColourWeights weights
         return;
 
     bandColourWeights = weights;
+    rebuildColourLuts();
     repaint();
 }
 
@@ -790,6 +991,41 @@ void SpeakerVisualizerComponent::setHeatmapDensity (int level)
     repaint();
 }
 
+void SpeakerVisualizerComponent::setSlicePlane (SlicePlane plane)
+{
+    if (plane == slicePlane)
+        return;
+
+    slicePlane = plane;
+    sliceOffset = getSliceOffsetRange().clipValue (sliceOffset);
+    cachedSliceMaxLevel = 0.0f;
+    repaint();
+}
+
+void SpeakerVisualizerComponent::setSliceOffset (float metres)
+{
+    const auto clamped = getSliceOffsetRange().clipValue (metres);
+    if (std::abs (clamped - sliceOffset) < 1.0e-4f)
+        return;
+
+    sliceOffset = clamped;
+    repaint();
+}
+
+juce::Range<float> SpeakerVisualizerComponent::getSliceOffsetRange() const noexcept
+{
+    const auto ceilingY = roomDimensions.height - roomDimensions.earHeight;
+
+    switch (slicePlane)
+    {
+        case SlicePlane::EarHeight:       return { -roomDimensions.earHeight, ceilingY };
+        case SlicePlane::Ceiling:         return { -roomDimensions.height + sliceCeilingInset, 0.0f };
+        case SlicePlane::VerticalSection: return { -roomDimensions.width * 0.5f, roomDimensions.width * 0.5f };
+    }
+
+    return { 0.0f, 0.0f };
+}
+
 void SpeakerVisualizerComponent::setCameraPreset (CameraPreset preset)
 {
     currentPreset = preset;
@@ -908,6 +1144,30 @@ juce::Colour SpeakerVisualizerComponent::colourForBands (const AtmosVizAudioProc
 }
 
 juce::Colour SpeakerVisualizerComponent::colourFromShares (float lowShare, float midShare, float highShare, float brightness) const
+{
+    return juce::Colour (packedColourFromShares (lowShare, midShare, highShare, brightness));
+}
+
+juce::uint32 SpeakerVisualizerComponent::packedColourFromShares (float lowShare, float midShare, float highShare, float brightness) const noexcept
+{
+    lowShare  = std::max (0.0f, lowShare);
+    midShare  = std::max (0.0f, midShare);
+    highShare = std::max (0.0f, highShare);
+
+    const auto sum = lowShare + midShare + highShare;
+    if (sum <= 1.0e-6f || bandShareLut.empty())
+        return bandShareNeutralArgb;
+
+    const auto shareScale = (float) bandShareSteps / sum;
+    const auto lowIndex = juce::jlimit (0, bandShareSteps, juce::roundToInt (lowShare * shareScale));
+    const auto midIndex = juce::jlimit (0, bandShareSteps - lowIndex, juce::roundToInt (midShare * shareScale));
+    const auto brightnessIndex = juce::roundToInt ((juce::jlimit (bandBrightnessMin, bandBrightnessMax, brightness) - bandBrightnessMin)
+                                                   / (bandBrightnessMax - bandBrightnessMin) * (float) (bandBrightnessSteps - 1));
+
+    return bandShareLut[(size_t) ((brightnessIndex * (bandShareSteps + 1) + midIndex) * (bandShareSteps + 1) + lowIndex)];
+}
+
+juce::Colour SpeakerVisualizerComponent::computeColourFromShares (float lowShare, float midShare, float highShare, float brightness) const
 {
     const auto lowWeight  = std::max (0.0f, bandColourWeights.low);
     const auto midWeight  = std::max (0.0f, bandColourWeights.mid);
@@ -940,6 +1200,61 @@ juce::Colour SpeakerVisualizerComponent::colourFromShares (float lowShare, float
     return juce::Colour::fromFloatRGBA (mix.x, mix.y, mix.z, 1.0f);
 }
 
+void SpeakerVisualizerComponent::rebuildColourLuts()
+{
+    // The band-share table covers the low/mid plane of the share simplex (high is the
+    // remainder) at each brightness step; cells past the simplex edge are never read.
+    constexpr int shareSide = bandShareSteps + 1;
+    bandShareLut.resize ((size_t) (shareSide * shareSide * bandBrightnessSteps));
+
+    for (int b = 0; b < bandBrightnessSteps; ++b)
+    {
+        const auto brightness = juce::jmap ((float) b, 0.0f, (float) (bandBrightnessSteps - 1), bandBrightnessMin, bandBrightnessMax);
+
+        for (int m = 0; m < shareSide; ++m)
+        {
+            for (int l = 0; l < shareSide; ++l)
+            {
+                const auto lowShare = (float) l / (float) bandShareSteps;
+                const auto midShare = (float) m / (float) bandShareSteps;
+                const auto highShare = std::max (0.0f, 1.0f - lowShare - midShare);
+                bandShareLut[(size_t) ((b * shareSide + m) * shareSide + l)]
+                    = computeColourFromShares (lowShare, midShare, highShare, brightness).getARGB();
+            }
+        }
+    }
+
+    for (int i = 0; i < heatmapRampSize; ++i)
+    {
+        const auto ratio = (float) i / (float) (heatmapRampSize - 1);
+
+        float lowShare = 0.0f;
+        float midShare = 0.0f;
+        float highShare = 0.0f;
+
+        if (ratio < 0.5f)
+        {
+            const auto t = ratio / 0.5f;
+            lowShare = 1.0f - t;
+            midShare = t;
+        }
+        else
+        {
+            const auto t = (ratio - 0.5f) / 0.5f;
+            midShare = 1.0f - t;
+            highShare = t;
+        }
+
+        const auto brightness = juce::jlimit (0.35f, 1.0f, 0.45f + ratio * 0.5f);
+        const auto colour = computeColourFromShares (lowShare, midShare, highShare, brightness);
+        heatmapRampLut[(size_t) i] = colour.getARGB();
+
+        // Slice rasters fade low levels out so the room stays visible through the plane.
+        const auto sliceAlpha = juce::jlimit (0.12f, 0.75f, 0.12f + ratio * 0.7f);
+        sliceRampLut[(size_t) i] = colour.withAlpha (sliceAlpha).getPixelARGB().getNativeARGB();
+    }
+}
+
 juce::Colour SpeakerVisualizerComponent::colourForBandMix (float lowShare, float midShare, float highShare) const
 {
     const auto sum = std::max (1.0e-6f, std::abs (lowShare) + std::abs (midShare) + std::abs (highShare));
@@ -951,78 +1266,304 @@ juce::Colour SpeakerVisualizerComponent::colourForBandMix (float lowShare, float
 
 juce::Colour SpeakerVisualizerComponent::colourForHeatmapRatio (float ratio) const
 {
-    ratio = juce::jlimit (0.0f, 1.0f, ratio);
+    return juce::Colour (packedColourForHeatmapRatio (ratio));
+}
+
+juce::uint32 SpeakerVisualizerComponent::packedColourForHeatmapRatio (float ratio) const noexcept
+{
+    const auto index = juce::jlimit (0, heatmapRampSize - 1, (int) (ratio * (float) (heatmapRampSize - 1) + 0.5f));
+    return heatmapRampLut[(size_t) index];
+}
 
-    float lowShare = 0.0f;
-    float midShare = 0.0f;
-    float highShare = 0.0f;
+void SpeakerVisualizerComponent::paint (juce::Graphics& g)
+{
+    // Render-path temporaries come from the frame arena, which rewinds when this scope ends.
+    const FrameArena::ScopedFrame frameScope (frameArena);
+    scratchPathsInUse = 0;
+    profiler.beginFrame();
 
-    if (ratio < 0.5f)
+    auto timed = [this] (FrameProfiler::Stage stage, auto&& drawStage)
     {
-        const auto t = ratio / 0.5f;
-        lowShare = 1.0f - t;
-        midShare = t;
-    }
-    else
+        const FrameProfiler::ScopedStage timer (profiler, stage);
+        drawStage();
+    };
+
     {
-        const auto t = (ratio - 0.5f) / 0.5f;
-        midShare = 1.0f - t;
-        highShare = t;
+        const FrameProfiler::ScopedStage frameTimer (profiler, FrameProfiler::Stage::Frame);
+
+        g.fillAll (juce::Colours::black);
+
+        timed (FrameProfiler::Stage::Room,  [&] { drawRoom (g); });
+        timed (FrameProfiler::Stage::Gizmo, [&] { drawGizmo (g); });
+
+        DrawOrder drawOrder { FrameAllocator<const DisplaySpeaker*> (frameArena) };
+
+        timed (FrameProfiler::Stage::Projections, [&]
+        {
+            updateProjections();
+
+            drawOrder.reserve (speakers.size());
+            for (const auto& speaker : speakers)
+                drawOrder.push_back (&speaker);
+
+            std::sort (drawOrder.begin(), drawOrder.end(),
+                       [] (const DisplaySpeaker* a, const DisplaySpeaker* b) { return a->depth > b->depth; });
+
+            if (cameraInside)
+            {
+                const auto newEnd = std::remove_if (drawOrder.begin(), drawOrder.end(),
+                                                    [] (const DisplaySpeaker* speakerPtr)
+                                                    {
+                                                        return speakerPtr->depth < -insideNearPlane;
+                                                    });
+                drawOrder.erase (newEnd, drawOrder.end());
+            }
+        });
+
+        timed (FrameProfiler::Stage::ModeDraw, [&]
+        {
+            switch (visualizationMode)
+            {
+                case VisualizationMode::DirectionalLobes:
+                    drawDirectionalLobes (g, drawOrder);
+                    break;
+                case VisualizationMode::LayeredLobes:
+                    drawLayeredLobes (g, drawOrder);
+                    break;
+                case VisualizationMode::DirectivityBalloon:
+                    drawDirectivityBalloons (g, drawOrder);
+                    break;
+                case VisualizationMode::RadiationHeatmap:
+                    drawRadiationHeatmap (g);
+                    break;
+                case VisualizationMode::TemporalTrail:
+                    drawTemporalTrails (g, drawOrder);
+                    break;
+                case VisualizationMode::SliceHeatmap:
+                    drawSliceHeatmap (g);
+                    break;
+                case VisualizationMode::VolumetricField:
+                    drawVolumetricField (g);
+                    break;
+                case VisualizationMode::Isosurface:
+                    drawIsosurfaces (g);
+                    break;
+            }
+
+            if (phantomLinksVisible)
+            {
+                drawPhantomLinks (g, drawOrder);
+                drawEnergyVectors (g);
+            }
+        });
+
+        timed (FrameProfiler::Stage::Markers, [&] { drawSpeakerBaseMarkers (g, drawOrder); });
     }
 
-    const auto brightness = juce::jlimit (0.35f, 1.0f, 0.45f + ratio * 0.5f);
-    return colourFromShares (lowShare, midShare, highShare, brightness);
+    if (analysisTier != AnalysisGovernor::Tier::Full)
+        drawAnalysisTierBadge (g);
+
+    if (profilerOverlayVisible)
+        drawProfilerOverlay (g);
 }
 
-void SpeakerVisualizerComponent::paint (juce::Graphics& g)
+void SpeakerVisualizerComponent::setProfilerOverlayVisible (bool shouldBeVisible)
 {
-    g.fillAll (juce::Colours::black);
+    if (profilerOverlayVisible == shouldBeVisible)
+        return;
 
-    drawRoom (g);
-    drawGizmo (g);
-    updateProjections();
+    profilerOverlayVisible = shouldBeVisible;
+    repaint();
+}
 
-    DrawOrder drawOrder;
-    drawOrder.reserve (speakers.size());
-    for (const auto& speaker : speakers)
-        drawOrder.push_back (&speaker);
+void SpeakerVisualizerComponent::drawProfilerOverlay (juce::Graphics& g)
+{
+    static constexpr std::array<FrameProfiler::Stage, FrameProfiler::numStages> stages {
+        FrameProfiler::Stage::Frame, FrameProfiler::Stage::Room, FrameProfiler::Stage::Gizmo,
+        FrameProfiler::Stage::Projections, FrameProfiler::Stage::ModeDraw, FrameProfiler::Stage::Markers
+    };
 
-    std::sort (drawOrder.begin(), drawOrder.end(),
-               [] (const DisplaySpeaker* a, const DisplaySpeaker* b) { return a->depth > b->depth; });
+    constexpr float lineHeight = 14.0f;
+    const auto& counters = profiler.getLastFrameCounters();
+    const auto panel = juce::Rectangle<float> (8.0f, 8.0f, 250.0f, lineHeight * (float) (stages.size() + 4) + 8.0f);
 
-    if (cameraInside)
+    g.setColour (juce::Colours::black.withAlpha (0.72f));
+    g.fillRoundedRectangle (panel, 4.0f);
+
+    g.setFont (juce::Font (11.0f));
+    auto row = panel.reduced (6.0f, 4.0f).withHeight (lineHeight);
+
+    auto drawRow = [&] (const juce::String& text, juce::Colour colour)
+    {
+        g.setColour (colour);
+        g.drawText (text, row, juce::Justification::centredLeft, false);
+        row.translate (0.0f, lineHeight);
+    };
+
+    drawRow (juce::String (profiler.getFramesPerSecond(), 1) + " fps   (p50 / p95 / p99 ms)", juce::Colours::white);
+
+    for (auto stage : stages)
     {
-        const auto newEnd = std::remove_if (drawOrder.begin(), drawOrder.end(),
-                                            [] (const DisplaySpeaker* speakerPtr)
-                                            {
-                                                return speakerPtr->depth < -insideNearPlane;
-                                            });
-        drawOrder.erase (newEnd, drawOrder.end());
+        drawRow (juce::String (FrameProfiler::getStageName (stage)).paddedRight (' ', 11)
+                     + juce::String (profiler.getPercentileMs (stage, 0.5f), 2) + " / "
+                     + juce::String (profiler.getPercentileMs (stage, 0.95f), 2) + " / "
+                     + juce::String (profiler.getPercentileMs (stage, 0.99f), 2),
+                 stage == FrameProfiler::Stage::Frame ? juce::Colours::white : juce::Colours::lightgrey);
     }
 
-    switch (visualizationMode)
+    drawRow ("Cells evaluated " + juce::String (counters.cellsEvaluated)
+                 + ", drawn " + juce::String (counters.cellsDrawn),
+             juce::Colours::lightgrey);
+
+    const auto overflows = frameArena.getOverflowsLastFrame();
+    drawRow ("Arena overflows/frame " + juce::String (overflows),
+             overflows > 0 ? juce::Colours::orange : juce::Colours::lightgrey);
+}
+
+
+void SpeakerVisualizerComponent::setPhantomLinksVisible (bool shouldBeVisible)
+{
+    if (phantomLinksVisible == shouldBeVisible)
+        return;
+
+    phantomLinksVisible = shouldBeVisible;
+    repaint();
+}
+
+void SpeakerVisualizerComponent::drawPhantomLinks (juce::Graphics& g, const DrawOrder& order)
+{
+    // Strongly correlated pairs form a phantom image between the speakers; anti-correlated
+    // pairs collapse or comb instead, so they are drawn as a warning.
+    constexpr float threshold = 0.5f;
+
+    std::array<const DisplaySpeaker*, CorrelationMatrix::maxChannels> visible {};
+    for (const auto* speakerPtr : order)
     {
-        case VisualizationMode::DirectionalLobes:
-            drawDirectionalLobes (g, drawOrder);
-            break;
-        case VisualizationMode::LayeredLobes:
-            drawLayeredLobes (g, drawOrder);
-            break;
-        case VisualizationMode::DirectivityBalloon:
-            drawDirectivityBalloons (g, drawOrder);
-            break;
-        case VisualizationMode::RadiationHeatmap:
-            drawRadiationHeatmap (g);
-            break;
-        case VisualizationMode::TemporalTrail:
-            drawTemporalTrails (g, drawOrder);
-            break;
+        const auto index = (size_t) (speakerPtr - speakers.data());
+        if (index < visible.size() && ! speakerPtr->definition.isLfe)
+            visible[index] = speakerPtr;
+    }
+
+    for (int a = 0; a < CorrelationMatrix::maxChannels; ++a)
+    {
+        if (visible[(size_t) a] == nullptr)
+            continue;
+
+        for (int b = a + 1; b < CorrelationMatrix::maxChannels; ++b)
+        {
+            if (visible[(size_t) b] == nullptr)
+                continue;
+
+            const auto r = correlations[(size_t) CorrelationMatrix::pairIndex (a, b)];
+            if (std::abs (r) < threshold)
+                continue;
+
+            const auto& first = *visible[(size_t) a];
+            const auto& second = *visible[(size_t) b];
+            const auto activity = juce::jlimit (0.0f, 1.0f, 2.0f * std::max (visualLevelForSpeaker (first), visualLevelForSpeaker (second)));
+            const auto strength = (std::abs (r) - threshold) / (1.0f - threshold) * activity;
+            if (strength < 0.02f)
+                continue;
+
+            const auto colour = r > 0.0f ? juce::Colours::white : juce::Colours::orangered;
+            const juce::Line<float> link (first.projected, second.projected);
+
+            g.setColour (colour.withAlpha (0.15f + 0.55f * strength));
+            g.drawLine (link, 1.0f + 3.0f * strength);
+
+            if (r > 0.0f)
+            {
+                // Energy panning: the image sits towards the louder speaker.
+                const auto energyA = first.metrics.rmsLevel * first.metrics.rmsLevel;
+                const auto energyB = second.metrics.rmsLevel * second.metrics.rmsLevel;
+                const auto t = energyA + energyB > 1.0e-9f ? energyB / (energyA + energyB) : 0.5f;
+                const auto radius = 3.0f + 5.0f * strength;
+
+                g.setColour (colour.withAlpha (0.35f + 0.5f * strength));
+                g.fillEllipse (juce::Rectangle<float> (radius * 2.0f, radius * 2.0f).withCentre (link.getPointAlongLineProportionally (t)));
+            }
+        }
     }
+}
+
+void SpeakerVisualizerComponent::drawEnergyVectors (juce::Graphics& g)
+{
+    // One marker per band at the perceived source direction, placed on the room boundary
+    // and sized by the spread angle (acos rE) projected at that distance.
+    static constexpr std::array<const char*, 3> bandNames { "Low", "Mid", "High" };
+    static const std::array<juce::Colour, 3> bandColours {
+        juce::Colour::fromFloatRGBA (0.35f, 0.55f, 0.95f, 1.0f),
+        juce::Colour::fromFloatRGBA (0.35f, 0.85f, 0.45f, 1.0f),
+        juce::Colour::fromFloatRGBA (0.98f, 0.45f, 0.35f, 1.0f)
+    };
+
+    float totalEnergy = 0.0f;
+    for (const auto& vector : energyVectors)
+        totalEnergy += vector.energy;
+
+    if (totalEnergy <= 1.0e-9f)
+        return;
+
+    const juce::Vector3D<float> origin;
+    g.setFont (juce::Font (10.0f));
+
+    for (size_t band = 0; band < energyVectors.size(); ++band)
+    {
+        const auto& vector = energyVectors[band];
+        const auto share = vector.energy / totalEnergy;
+        if (share < 0.05f || vector.magnitude < 1.0e-3f)
+            continue;
+
+        const auto direction = vector.direction;
+        auto distance = distanceToRoomBoundary (origin, direction);
+        if (! std::isfinite (distance))
+            continue;
+        distance *= 0.85f;
+
+        const auto projected = projectPoint (direction * distance);
+        if (cameraInside && projected.depth <= insideNearPlane)
+            continue;
 
-    drawSpeakerBaseMarkers (g, drawOrder);
+        // Any vector perpendicular to the direction will do for measuring the spread.
+        auto perpendicular = direction ^ juce::Vector3D<float> (0.0f, 1.0f, 0.0f);
+        if (perpendicular.length() < 1.0e-3f)
+            perpendicular = direction ^ juce::Vector3D<float> (1.0f, 0.0f, 0.0f);
+        perpendicular = perpendicular.normalised();
+
+        const auto spread = juce::degreesToRadians (vector.spreadDegrees);
+        const auto edge = projectPoint ((direction * std::cos (spread) + perpendicular * std::sin (spread)) * distance);
+        const auto radius = juce::jlimit (4.0f, 160.0f, projected.screen.getDistanceFrom (edge.screen));
+
+        const auto colour = bandColours[band];
+        const auto area = juce::Rectangle<float> (radius * 2.0f, radius * 2.0f).withCentre (projected.screen);
+
+        g.setColour (colour.withAlpha (0.08f + 0.22f * share));
+        g.fillEllipse (area);
+        g.setColour (colour.withAlpha (0.35f + 0.5f * share));
+        g.drawEllipse (area, 1.5f);
+        g.fillEllipse (juce::Rectangle<float> (6.0f, 6.0f).withCentre (projected.screen));
+        g.drawText (bandNames[band], juce::Rectangle<float> (40.0f, 12.0f).withCentre (projected.screen.translated (0.0f, -10.0f)),
+                    juce::Justification::centred, false);
+    }
 }
 
+void SpeakerVisualizerComponent::drawAnalysisTierBadge (juce::Graphics& g)
+{
+    // The audio thread is shedding analysis work, so band colours lag or are held.
+    const auto text = juce::String ("Analysis: ") + AnalysisGovernor::getTierDescription (analysisTier)
+                    + " - band colours approximate";
+
+    const auto font = juce::Font (11.0f);
+    const auto width = font.getStringWidthFloat (text) + 16.0f;
+    const auto badge = juce::Rectangle<float> (8.0f, (float) getHeight() - 28.0f, width, 20.0f);
 
+    g.setColour (juce::Colours::black.withAlpha (0.72f));
+    g.fillRoundedRectangle (badge, 4.0f);
+
+    g.setColour (analysisTier == AnalysisGovernor::Tier::LevelsOnly ? juce::Colours::orangered : juce::Colours::orange);
+    g.setFont (font);
+    g.drawText (text, badge, juce::Justification::centred, false);
+}
 
 float SpeakerVisualizerComponent::distanceToRoomBoundary (const juce::Vector3D<float>& position,
                                                                   const juce::Vector3D<float>& direction) const
@@ -1058,6 +1599,43 @@ float SpeakerVisualizerComponent::distanceToRoomBoundary (const juce::Vector3D<f
     return juce::jmax (eps, closest);
 }
 
+bool SpeakerVisualizerComponent::intersectRoomBounds (const juce::Vector3D<float>& origin,
+                                                      const juce::Vector3D<float>& direction,
+                                                      float& entry,
+                                                      float& exit) const noexcept
+{
+    constexpr float eps = 1.0e-5f;
+    const float depthHalf  = roomDimensions.depth * 0.5f;
+    const float widthHalf  = roomDimensions.width * 0.5f;
+    const float floorY     = -roomDimensions.earHeight;
+    const float ceilingY   = roomDimensions.height - roomDimensions.earHeight;
+
+    entry = -std::numeric_limits<float>::infinity();
+    exit  =  std::numeric_limits<float>::infinity();
+
+    auto clipSlab = [&] (float start, float dir, float minBound, float maxBound)
+    {
+        if (std::abs (dir) < eps)
+            return start >= minBound && start <= maxBound;
+
+        auto t0 = (minBound - start) / dir;
+        auto t1 = (maxBound - start) / dir;
+        if (t0 > t1)
+            std::swap (t0, t1);
+
+        entry = std::max (entry, t0);
+        exit  = std::min (exit, t1);
+        return true;
+    };
+
+    if (! clipSlab (origin.x, direction.x, -depthHalf, depthHalf)
+        || ! clipSlab (origin.y, direction.y, floorY, ceilingY)
+        || ! clipSlab (origin.z, direction.z, -widthHalf, widthHalf))
+        return false;
+
+    return exit > std::max (entry, 0.0f);
+}
+
 void SpeakerVisualizerComponent::updateMaxReach (DisplaySpeaker& speaker) const
 {
     const auto& def = speaker.definition;
@@ -1098,7 +1676,8 @@ void SpeakerVisualizerComponent::updateMaxReach (DisplaySpeaker& speaker) const
 
 float SpeakerVisualizerComponent::visualLevelForSpeaker (const DisplaySpeaker& speaker) const
 {
-    return juce::jlimit (0.0f, 1.0f, std::max (speaker.metrics.peak, speaker.metrics.rms));
+    // Ballistic envelopes rather than raw block values, so lobes rise fast and fall smoothly.
+    return juce::jlimit (0.0f, 1.0f, std::max (speaker.metrics.level, speaker.metrics.rmsLevel));
 }
 
 float SpeakerVisualizerComponent::reachForLevel (const DisplaySpeaker& speaker, float level, float shaping) const
@@ -1134,21 +1713,14 @@ void SpeakerVisualizerComponent::drawDirectionalLobes (juce::Graphics& g, const
         const auto spread = juce::jlimit (12.0f, reach * 0.45f, reach * 0.85f);
         const auto tail   = juce::jlimit (4.0f, reach * 0.22f, reach * 0.35f);
 
-        const auto orientation = dir2D * reach;
-        const auto perp        = juce::Point<float> (-dir2D.y, dir2D.x) * spread;
-        const auto tailPoint   = speaker.projected - dir2D * tail;
-
-        juce::Path lobe;
-        lobe.startNewSubPath (tailPoint - perp * 0.35f);
-        lobe.lineTo           (tailPoint + perp * 0.35f);
-        lobe.lineTo           (speaker.projected + orientation);
-        lobe.closeSubPath();
+        const auto tailPoint = speaker.projected - dir2D * tail;
+        const auto transform = rotationTransform (tailPoint, dir2D, tail + reach, spread * 0.35f);
 
         g.setColour (colour.withAlpha (0.4f));
-        g.fillPath (lobe);
+        g.fillPath (lobeTemplate, transform);
 
         g.setColour (colour.withAlpha (0.22f));
-        g.strokePath (lobe, juce::PathStrokeType (juce::jmax (1.4f, spread * 0.06f)));
+        strokeTemplate (g, lobeTemplate, transform, juce::jmax (1.4f, spread * 0.06f));
     }
 }
 
@@ -1177,29 +1749,24 @@ void SpeakerVisualizerComponent::drawLayeredLobes (juce::Graphics& g, const Draw
         if (baseReach < 1.5f)
             continue;
 
-        const auto tail = speaker.projected - dir2D * juce::jlimit (3.0f, baseReach * 0.18f, baseReach * 0.3f);
+        const auto tailLength = juce::jlimit (3.0f, baseReach * 0.18f, baseReach * 0.3f);
+        const auto tail = speaker.projected - dir2D * tailLength;
 
         for (size_t layer = 0; layer < reachMultipliers.size(); ++layer)
         {
             const auto reach = baseReach * reachMultipliers[layer];
             const auto spread = juce::jlimit (8.0f, reach * spreadFactors[layer], reach * 1.1f);
 
-            juce::Path lobe;
-            const auto orientation = dir2D * reach;
-            const auto perp        = juce::Point<float> (-dir2D.y, dir2D.x) * spread;
-
-            lobe.startNewSubPath (tail - perp * 0.42f);
-            lobe.lineTo           (tail + perp * 0.42f);
-            lobe.lineTo           (speaker.projected + orientation);
-            lobe.closeSubPath();
+            const auto transform = rotationTransform (tail, dir2D, tailLength + reach, spread);
+            const auto& lobe = layeredLobeTemplate;
 
             const auto alpha = juce::jlimit (0.05f, 0.7f, alphaFactors[layer] + level * 0.28f);
 
             g.setColour (baseColour.withAlpha (alpha));
-            g.fillPath (lobe);
+            g.fillPath (lobe, transform);
 
             g.setColour (baseColour.withAlpha (alpha * 0.55f));
-            g.strokePath (lobe, juce::PathStrokeType (juce::jmax (1.2f, spread * 0.045f)));
+            strokeTemplate (g, lobe, transform, juce::jmax (1.2f, spread * 0.045f));
         }
     }
 }
@@ -1209,9 +1776,6 @@ void SpeakerVisualizerComponent::drawDirectivityBalloons (juce::Graphics& g, con
     static constexpr std::array<float, 3> shellScales { 0.55f, 0.85f, 1.0f };
     static constexpr std::array<float, 3> shellAlphas { 0.26f, 0.18f, 0.12f };
 
-    juce::Path unitCircle;
-    unitCircle.addEllipse (-0.5f, -0.5f, 1.0f, 1.0f);
-
     for (const auto* speakerPtr : order)
     {
         const auto& speaker = *speakerPtr;
@@ -1239,16 +1803,15 @@ void SpeakerVisualizerComponent::drawDirectivityBalloons (juce::Graphics& g, con
                                                                 : dir2D * (major * 0.18f);
             const auto centre = speaker.projected + centreOffset;
 
-            juce::Path shell (unitCircle);
             const auto orientation2D = speaker.definition.isLfe ? juce::Point<float> { 0.0f, -1.0f } : dir2D;
-            shell.applyTransform (rotationTransform (centre, orientation2D, major, minor));
+            const auto transform = rotationTransform (centre, orientation2D, major, minor);
 
             const auto alpha = juce::jlimit (0.05f, 0.6f, shellAlphas[i] + level * 0.25f);
             g.setColour (colour.withAlpha (alpha));
-            g.fillPath (shell);
+            g.fillPath (balloonTemplate, transform);
 
             g.setColour (colour.withAlpha (alpha * 0.7f));
-            g.strokePath (shell, juce::PathStrokeType (juce::jmax (1.0f, minor * 0.012f)));
+            strokeTemplate (g, balloonTemplate, transform, juce::jmax (1.0f, minor * 0.012f));
         }
     }
 }
@@ -1258,49 +1821,22 @@ void SpeakerVisualizerComponent::drawRadiationHeatmap (juce::Graphics& g)
     if (heatmapPoints.empty())
         return;
 
-    std::vector<float> levels (heatmapPoints.size(), 0.0f);
+    collectFieldSources();
+
+    FrameVector<float> levels (heatmapPoints.size(), 0.0f, FrameAllocator<float> (frameArena));
     float frameMax = 0.0f;
 
     for (size_t i = 0; i < heatmapPoints.size(); ++i)
     {
-        const auto& point = heatmapPoints[i];
-        float level = 0.0f;
-
-        for (const auto& speaker : speakers)
-        {
-            const auto amplitude = juce::jlimit (0.0f, 1.0f, speaker.metrics.rms);
-            if (amplitude <= 1.0e-4f)
-                continue;
-
-            auto delta = point - speaker.definition.position;
-            auto distance = delta.length();
-            distance = std::max (distance, 0.65f);
-
-            float directivity = 1.0f;
-            if (! speaker.definition.isLfe)
-            {
-                auto ray = delta;
-                auto rayLen = ray.length();
-                if (rayLen > 1.0e-4f)
-                {
-                    ray /= rayLen;
-                    auto aim = speaker.definition.aimDirection;
-                    const auto aimLen = aim.length();
-                    if (aimLen > 1.0e-4f)
-                        aim /= aimLen;
-                    directivity = std::max (0.0f, aim.x * ray.x + aim.y * ray.y + aim.z * ray.z);
-                }
-            }
-
-            level += amplitude * directivity / (distance * distance);
-        }
-
+        const auto level = evaluateFieldLevel (heatmapPoints[i]);
         levels[i] = level;
         frameMax = std::max (frameMax, level);
     }
 
     cachedHeatmapMaxLevel = juce::jmax (cachedHeatmapMaxLevel * 0.85f, frameMax);
     const auto normaliser = juce::jmax (0.12f, cachedHeatmapMaxLevel);
+    auto& counters = profiler.counters();
+    counters.cellsEvaluated += (int) heatmapPoints.size();
 
     for (size_t i = 0; i < heatmapPoints.size(); ++i)
     {
@@ -1316,6 +1852,7 @@ void SpeakerVisualizerComponent::drawRadiationHeatmap (juce::Graphics& g)
         const auto colour = colourForLevel (level, normaliser);
         const auto size = juce::jmap (normalised, 0.0f, 1.0f, 4.0f, 18.0f * visualizationScale);
 
+        ++counters.cellsDrawn;
         g.setColour (colour.withAlpha (juce::jlimit (0.08f, 0.6f, normalised * 0.8f)));
         g.fillEllipse (projected.screen.x - size * 0.5f,
                        projected.screen.y - size * 0.5f,
@@ -1324,543 +1861,2565 @@ void SpeakerVisualizerComponent::drawRadiationHeatmap (juce::Graphics& g)
     }
 }
 
-void SpeakerVisualizerComponent::drawTemporalTrails (juce::Graphics& g, const DrawOrder& order)
+void SpeakerVisualizerComponent::drawIsosurfaces (juce::Graphics& g)
 {
-    for (const auto* speakerPtr : order)
-    {
-        const auto& speaker = *speakerPtr;
-
-        if (speaker.trail.size() < 2)
+    if (heatmapPoints.empty())
+        return;
+
+    collectFieldSources();
+
+    isoLevels.resize (heatmapPoints.size());
+    float frameMax = 0.0f;
+
+    for (size_t i = 0; i < heatmapPoints.size(); ++i)
+    {
+        isoLevels[i] = evaluateFieldLevel (heatmapPoints[i]);
+        frameMax = std::max (frameMax, isoLevels[i]);
+    }
+
+    cachedHeatmapMaxLevel = juce::jmax (cachedHeatmapMaxLevel * 0.85f, frameMax);
+    updateIsosurfaceMesh (juce::jmax (0.12f, cachedHeatmapMaxLevel));
+    profiler.counters().cellsEvaluated += (int) heatmapPoints.size();
+
+    if (isoMesh.empty())
+        return;
+
+    const auto bounds = getLocalBounds().toFloat();
+    const auto forward = computeCameraOrientation().forward;
+    const auto cameraPosition = cameraInside ? computeInsideProjectionParameters (bounds).cameraPosition
+                                             : forward * (-cameraDistance);
+
+    struct ProjectedTriangle
+    {
+        std::array<juce::Point<float>, 3> screen;
+        float shade = 1.0f;
+    };
+
+    FrameVector<ProjectedTriangle> projected (isoMesh.size(), ProjectedTriangle {}, FrameAllocator<ProjectedTriangle> (frameArena));
+    isoDrawOrder.clear();
+
+    for (size_t i = 0; i < isoMesh.size(); ++i)
+    {
+        const auto& triangle = isoMesh[i];
+        float depthSum = 0.0f;
+        bool visible = true;
+
+        for (size_t v = 0; v < 3; ++v)
+        {
+            const auto point = projectPoint (triangle.vertices[v]);
+            if (cameraInside && point.depth <= insideNearPlane)
+            {
+                visible = false;
+                break;
+            }
+
+            projected[i].screen[v] = point.screen;
+            depthSum += point.depth;
+        }
+
+        if (! visible)
             continue;
 
-        const auto colour = colourForBands (speaker.metrics.bands, speaker.definition.isLfe);
-        const auto thickness = speaker.definition.isLfe ? 2.0f : 2.4f;
+        const auto& a = triangle.vertices[0];
+        auto normal = (triangle.vertices[1] - a) ^ (triangle.vertices[2] - a);
+        const auto normalLength = normal.length();
+        if (normalLength <= 1.0e-6f)
+            continue;
 
-        for (size_t i = 1; i < speaker.trail.size(); ++i)
+        normal = normal / normalLength;
+        const auto view = cameraInside ? (a - cameraPosition).normalised() : forward;
+        projected[i].shade = 0.35f + 0.65f * std::abs (normal * view);
+
+        isoDrawOrder.emplace_back (depthSum, (int) i);
+    }
+
+    profiler.counters().cellsDrawn += (int) isoDrawOrder.size();
+
+    // Painter's order: farthest triangles first so nearer shells blend over them.
+    std::sort (isoDrawOrder.begin(), isoDrawOrder.end(),
+               [] (const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    std::array<juce::Colour, isoThresholds.size()> layerColours;
+    for (size_t layer = 0; layer < isoThresholds.size(); ++layer)
+        layerColours[layer] = colourForHeatmapRatio (isoColourRatios[layer]);
+
+    auto& path = acquireScratchPath();
+    for (const auto& entry : isoDrawOrder)
+    {
+        const auto& triangle = isoMesh[(size_t) entry.second];
+        const auto& screen = projected[(size_t) entry.second];
+        const auto layer = (size_t) triangle.layer;
+
+        path.clear();
+        path.addTriangle (screen.screen[0], screen.screen[1], screen.screen[2]);
+
+        g.setColour (layerColours[layer].withMultipliedBrightness (screen.shade).withAlpha (isoAlphas[layer]));
+        g.fillPath (path);
+    }
+}
+
+void SpeakerVisualizerComponent::updateIsosurfaceMesh (float normaliser)
+{
+    const auto nx = heatmapGridDims[0];
+    const auto ny = heatmapGridDims[1];
+    const auto nz = heatmapGridDims[2];
+    if (nx < 2 || ny < 2 || nz < 2 || isoLevels.size() != heatmapPoints.size())
+        return;
+
+    const auto cellsX = nx - 1;
+    const auto cellsZ = nz - 1;
+    const auto numCells = (size_t) (cellsX * (ny - 1) * cellsZ);
+
+    if (isoCellMasks.size() != numCells)
+    {
+        isoCellMasks.assign (numCells, isoInvalidMask);
+        isoMesh.clear();
+    }
+
+    isoDirtyCells.assign (numCells, 0);
+
+    auto pointIndex = [nx, nz] (int x, int y, int z) noexcept
+    {
+        return ((size_t) y * (size_t) nz + (size_t) z) * (size_t) nx + (size_t) x;
+    };
+
+    std::array<float, isoThresholds.size()> thresholds;
+    for (size_t layer = 0; layer < isoThresholds.size(); ++layer)
+        thresholds[layer] = isoThresholds[layer] * normaliser;
+
+    // A cell only needs new triangles when one of its corners crossed a threshold; the
+    // corner inside/outside bits for every layer are packed into one mask per cell. The
+    // triangles keep the grid edges they cut, and every vertex is re-interpolated each frame
+    // so the surface still follows levels (and a tracked maximum) that move within a cell.
+    bool anyDirty = false;
+    for (int y = 0; y < ny - 1; ++y)
+    {
+        for (int z = 0; z < cellsZ; ++z)
         {
-            const auto t = static_cast<float> (i) / static_cast<float> (speaker.trail.size() - 1);
-            g.setColour (colour.withAlpha (juce::jlimit (0.05f, 0.65f, t * 0.65f)));
-            g.drawLine (juce::Line<float> (speaker.trail[i - 1], speaker.trail[i]), thickness);
+            for (int x = 0; x < cellsX; ++x)
+            {
+                std::uint32_t mask = 0;
+                for (int corner = 0; corner < 8; ++corner)
+                {
+                    const auto level = isoLevels[pointIndex (x + (corner & 1), y + ((corner >> 1) & 1), z + ((corner >> 2) & 1))];
+                    for (size_t layer = 0; layer < thresholds.size(); ++layer)
+                        if (level >= thresholds[layer])
+                            mask |= 1u << (layer * 8 + (size_t) corner);
+                }
+
+                const auto cell = (size_t) ((y * cellsZ + z) * cellsX + x);
+                if (isoCellMasks[cell] != mask)
+                {
+                    isoCellMasks[cell] = mask;
+                    isoDirtyCells[cell] = 1;
+                    anyDirty = true;
+                }
+            }
         }
+    }
 
-        if (! speaker.definition.isLfe)
+    auto interpolateVertices = [this, &thresholds]
+    {
+        for (auto& triangle : isoMesh)
         {
-            auto dir2D = speaker.orientation2D;
-            auto len = dir2D.getDistanceFromOrigin();
-            if (len <= 1.0e-4f)
-                continue;
-            dir2D /= len;
+            const auto iso = thresholds[(size_t) triangle.layer];
 
-            const auto level  = visualLevelForSpeaker (speaker);
-            const auto reach  = reachForLevel (speaker, level, 0.6f);
-            g.setColour (colour.withAlpha (0.55f));
-            g.drawLine (juce::Line<float> (speaker.projected,
-                                           speaker.projected + dir2D * juce::jlimit (20.0f, reach, reach * 1.05f)),
-                        2.2f);
+            for (size_t v = 0; v < 3; ++v)
+            {
+                const auto [from, to] = triangle.edges[v];
+                const auto delta = isoLevels[to] - isoLevels[from];
+                const auto t = std::abs (delta) > 1.0e-9f ? juce::jlimit (0.0f, 1.0f, (iso - isoLevels[from]) / delta) : 0.5f;
+                triangle.vertices[v] = heatmapPoints[from] + (heatmapPoints[to] - heatmapPoints[from]) * t;
+            }
+        }
+    };
+
+    if (! anyDirty)
+    {
+        interpolateVertices();
+        return;
+    }
+
+    isoMesh.erase (std::remove_if (isoMesh.begin(), isoMesh.end(),
+                                   [this] (const IsoTriangle& triangle) { return isoDirtyCells[(size_t) triangle.cell] != 0; }),
+                   isoMesh.end());
+
+    for (int y = 0; y < ny - 1; ++y)
+    {
+        for (int z = 0; z < cellsZ; ++z)
+        {
+            for (int x = 0; x < cellsX; ++x)
+            {
+                const auto cell = (y * cellsZ + z) * cellsX + x;
+                if (isoDirtyCells[(size_t) cell] == 0)
+                    continue;
+
+                std::array<size_t, 8> corners;
+                for (int corner = 0; corner < 8; ++corner)
+                    corners[(size_t) corner] = pointIndex (x + (corner & 1), y + ((corner >> 1) & 1), z + ((corner >> 2) & 1));
+
+                for (size_t layer = 0; layer < thresholds.size(); ++layer)
+                {
+                    const auto layerMask = (isoCellMasks[(size_t) cell] >> (layer * 8)) & 0xffu;
+                    if (layerMask == 0 || layerMask == 0xffu)
+                        continue;
+
+                    using Edge = std::pair<size_t, size_t>;
+                    auto crossing = [&corners] (int from, int to)
+                    {
+                        return Edge { corners[(size_t) from], corners[(size_t) to] };
+                    };
+
+                    auto emit = [&] (const Edge& a, const Edge& b, const Edge& c)
+                    {
+                        isoMesh.push_back ({ {}, { a, b, c }, cell, (int) layer });
+                    };
+
+                    for (const auto& tetrahedron : isoCellTetrahedra)
+                    {
+                        std::array<int, 4> inside {}, outside {};
+                        int numInside = 0, numOutside = 0;
+
+                        for (auto corner : tetrahedron)
+                        {
+                            if ((layerMask >> corner) & 1u)
+                                inside[(size_t) numInside++] = corner;
+                            else
+                                outside[(size_t) numOutside++] = corner;
+                        }
+
+                        if (numInside == 1)
+                            emit (crossing (inside[0], outside[0]), crossing (inside[0], outside[1]), crossing (inside[0], outside[2]));
+                        else if (numInside == 3)
+                            emit (crossing (outside[0], inside[0]), crossing (outside[0], inside[1]), crossing (outside[0], inside[2]));
+                        else if (numInside == 2)
+                        {
+                            const auto a = crossing (inside[0], outside[0]);
+                            const auto b = crossing (inside[0], outside[1]);
+                            const auto c = crossing (inside[1], outside[1]);
+                            const auto d = crossing (inside[1], outside[0]);
+                            emit (a, b, c);
+                            emit (a, c, d);
+                        }
+                    }
+                }
+            }
         }
     }
+
+    interpolateVertices();
 }
 
-void SpeakerVisualizerComponent::drawSpeakerBaseMarkers (juce::Graphics& g, const DrawOrder& order)
+void SpeakerVisualizerComponent::collectFieldSources()
 {
-    for (const auto* speakerPtr : order)
-    {
-        const auto& speaker = *speakerPtr;
-        const auto colour = colourForBands (speaker.metrics.bands, speaker.definition.isLfe);
-        const auto level  = visualLevelForSpeaker (speaker);
-        const auto size   = juce::jlimit (20.0f, 65.0f, 26.0f + level * 135.0f);
-        const auto baseDiameter = size * 0.45f * juce::jlimit (0.6f, 1.5f, std::pow (visualizationScale, 0.25f));
+    fieldSources.clear();
+    fieldSources.reserve (speakers.size());
 
-        g.setColour (colour.withAlpha (0.95f));
-        g.fillEllipse (speaker.projected.x - baseDiameter * 0.5f,
-                       speaker.projected.y - baseDiameter * 0.5f,
-                       baseDiameter,
-                       baseDiameter);
+    for (const auto& speaker : speakers)
+    {
+        const auto amplitude = juce::jlimit (0.0f, 1.0f, speaker.metrics.rms);
+        if (amplitude <= 1.0e-4f)
+            continue;
 
-        g.setColour (juce::Colours::white.withAlpha (0.5f));
-        g.drawEllipse (speaker.projected.x - baseDiameter * 0.5f,
-                       speaker.projected.y - baseDiameter * 0.5f,
-                       baseDiameter,
-                       baseDiameter,
-                       1.4f);
+        FieldSource source;
+        source.position = speaker.definition.position;
+        source.amplitude = amplitude;
+        source.omnidirectional = speaker.definition.isLfe;
 
-        const auto labelBounds = juce::Rectangle<float> (speaker.projected.x - 70.0f,
-                                                         speaker.projected.y + baseDiameter * 0.75f,
-                                                         140.0f,
-                                                         18.0f).toNearestInt();
+        auto aim = speaker.definition.aimDirection;
+        const auto aimLen = aim.length();
+        if (aimLen > 1.0e-4f)
+            aim /= aimLen;
+        source.aim = aim;
 
-        g.setColour (juce::Colours::white);
-        g.drawFittedText (speaker.definition.displayName, labelBounds, juce::Justification::centred, 1);
+        fieldSources.push_back (source);
     }
 }
 
-void SpeakerVisualizerComponent::updateHeatmapCache()
+float SpeakerVisualizerComponent::evaluateFieldLevel (const juce::Vector3D<float>& point) const noexcept
 {
-    heatmapPoints.clear();
+    float level = 0.0f;
 
-    static constexpr std::array<int, 5> lateralSteps { 5, 7, 9, 11, 13 };
-    static constexpr std::array<int, 5> verticalSteps { 3, 5, 7, 9, 11 };
+    for (const auto& source : fieldSources)
+    {
+        const auto delta = point - source.position;
+        const auto rayLen = delta.length();
+        const auto distance = std::max (rayLen, heatmapMinDistance);
 
-    const auto index = juce::jlimit (0, (int) lateralSteps.size() - 1, heatmapDensityLevel - 1);
-    const int depthSteps = lateralSteps[(size_t) index];
-    const int widthSteps = lateralSteps[(size_t) index];
-    const int heightSteps = verticalSteps[(size_t) index];
+        float directivity = 1.0f;
+        if (! source.omnidirectional && rayLen > 1.0e-4f)
+        {
+            const auto& aim = source.aim;
+            directivity = std::max (0.0f, (aim.x * delta.x + aim.y * delta.y + aim.z * delta.z) / rayLen);
+        }
+
+        level += source.amplitude * directivity / (distance * distance);
+    }
+
+    return level;
+}
 
+SpeakerVisualizerComponent::SliceGeometry SpeakerVisualizerComponent::computeSliceGeometry() const noexcept
+{
     const auto depthHalf = roomDimensions.depth * 0.5f;
     const auto widthHalf = roomDimensions.width * 0.5f;
-    const auto floorY = -roomDimensions.earHeight;
-    const auto ceilingY = roomDimensions.height - roomDimensions.earHeight;
+    const auto floorY    = -roomDimensions.earHeight;
+    const auto ceilingY  = roomDimensions.height - roomDimensions.earHeight;
+    const auto offset    = getSliceOffsetRange().clipValue (sliceOffset);
 
-    heatmapPoints.reserve (depthSteps * widthSteps * heightSteps);
+    SliceGeometry geometry;
 
-    for (int y = 0; y < heightSteps; ++y)
+    if (slicePlane == SlicePlane::VerticalSection)
     {
-        const auto fy = juce::jmap ((float) y, 0.0f, (float) (heightSteps - 1), floorY + 0.12f, ceilingY - 0.12f);
+        // Front wall on the left, ceiling at the top, looking at the room from the right.
+        geometry.origin = {  depthHalf, ceilingY, offset };
+        geometry.uAxis  = { -roomDimensions.depth, 0.0f, 0.0f };
+        geometry.vAxis  = {  0.0f, floorY - ceilingY, 0.0f };
+        return geometry;
+    }
 
-        for (int z = 0; z < widthSteps; ++z)
+    const auto y = slicePlane == SlicePlane::Ceiling ? ceilingY - sliceCeilingInset + offset
+                                                     : offset;
+
+    // Plan view: front wall at the top, left wall on the left.
+    geometry.origin = { depthHalf, juce::jlimit (floorY, ceilingY, y), -widthHalf };
+    geometry.uAxis  = { 0.0f, 0.0f, roomDimensions.width };
+    geometry.vAxis  = { -roomDimensions.depth, 0.0f, 0.0f };
+    return geometry;
+}
+
+void SpeakerVisualizerComponent::renderSliceImage (const SliceGeometry& geometry)
+{
+    const auto densityIndex = (size_t) juce::jlimit (0, (int) slicePixelsPerMetre.size() - 1, heatmapDensityLevel - 1);
+    const auto pixelsPerMetre = slicePixelsPerMetre[densityIndex];
+    const int width  = juce::jmax (8, juce::roundToInt (geometry.uAxis.length() * pixelsPerMetre));
+    const int height = juce::jmax (8, juce::roundToInt (geometry.vAxis.length() * pixelsPerMetre));
+
+    if (! sliceImage.isValid() || sliceImage.getWidth() != width || sliceImage.getHeight() != height)
+        sliceImage = juce::Image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+    sliceLevels.resize ((size_t) (width * height));
+    sliceRowMaxima.resize ((size_t) height);
+
+    const auto uStep = geometry.uAxis / (float) width;
+    const auto vStep = geometry.vAxis / (float) height;
+    const auto firstPixel = geometry.origin + uStep * 0.5f + vStep * 0.5f;
+    constexpr float minDistanceSquared = heatmapMinDistance * heatmapMinDistance;
+
+    // Each row is evaluated source-by-source over contiguous pixels with no branches in
+    // the inner loops so the compiler can vectorise them.
+    parallelForChunks (renderPool.get(), height, [&] (int rowStart, int rowEnd)
+    {
+        for (int row = rowStart; row < rowEnd; ++row)
         {
-            const auto fz = juce::jmap ((float) z, 0.0f, (float) (widthSteps - 1), -widthHalf * 0.92f, widthHalf * 0.92f);
+            auto* levels = sliceLevels.data() + (size_t) row * (size_t) width;
+            std::fill (levels, levels + width, 0.0f);
 
-            for (int x = 0; x < depthSteps; ++x)
+            const auto rowOrigin = firstPixel + vStep * (float) row;
+
+            for (const auto& source : fieldSources)
             {
-                const auto fx = juce::jmap ((float) x, 0.0f, (float) (depthSteps - 1), -depthHalf * 0.92f, depthHalf * 0.92f);
-                heatmapPoints.emplace_back (fx, fy, fz);
+                const float bx = rowOrigin.x - source.position.x;
+                const float by = rowOrigin.y - source.position.y;
+                const float bz = rowOrigin.z - source.position.z;
+                const float amplitude = source.amplitude;
+
+                if (source.omnidirectional)
+                {
+                    for (int i = 0; i < width; ++i)
+                    {
+                        const float fi = (float) i;
+                        const float dx = bx + uStep.x * fi;
+                        const float dy = by + uStep.y * fi;
+                        const float dz = bz + uStep.z * fi;
+                        const float lengthSquared = dx * dx + dy * dy + dz * dz;
+                        levels[i] += amplitude / std::max (lengthSquared, minDistanceSquared);
+                    }
+                    continue;
+                }
+
+                const float ax = source.aim.x;
+                const float ay = source.aim.y;
+                const float az = source.aim.z;
+
+                for (int i = 0; i < width; ++i)
+                {
+                    const float fi = (float) i;
+                    const float dx = bx + uStep.x * fi;
+                    const float dy = by + uStep.y * fi;
+                    const float dz = bz + uStep.z * fi;
+                    const float lengthSquared = dx * dx + dy * dy + dz * dz;
+                    const float length = std::sqrt (lengthSquared);
+                    const float facing = std::max (0.0f, ax * dx + ay * dy + az * dz) / std::max (length, 1.0e-4f);
+                    levels[i] += amplitude * facing / std::max (lengthSquared, minDistanceSquared);
+                }
             }
+
+            sliceRowMaxima[(size_t) row] = *std::max_element (levels, levels + width);
         }
-    }
+    });
 
-    cachedHeatmapMaxLevel = 0.0f;
+    const auto frameMax = *std::max_element (sliceRowMaxima.begin(), sliceRowMaxima.end());
+    cachedSliceMaxLevel = juce::jmax (cachedSliceMaxLevel * 0.85f, frameMax);
+    const auto normaliser = juce::jmax (0.12f, cachedSliceMaxLevel);
+
+    const juce::Image::BitmapData bitmap (sliceImage, juce::Image::BitmapData::writeOnly);
+    const auto paletteScale = (float) (heatmapRampSize - 1) / normaliser;
+    const auto* palette = sliceRampLut.data();
+
+    parallelForChunks (renderPool.get(), height, [&] (int rowStart, int rowEnd)
+    {
+        for (int row = rowStart; row < rowEnd; ++row)
+        {
+            const auto* levels = sliceLevels.data() + (size_t) row * (size_t) width;
+            auto* pixels = reinterpret_cast<juce::uint32*> (bitmap.getLinePointer (row));
+
+            for (int i = 0; i < width; ++i)
+            {
+                const auto index = juce::jlimit (0, heatmapRampSize - 1, (int) (levels[i] * paletteScale));
+                pixels[i] = palette[(size_t) index];
+            }
+        }
+    });
 }
 
-void SpeakerVisualizerComponent::updateTrails()
+void SpeakerVisualizerComponent::drawSliceHeatmap (juce::Graphics& g)
 {
-    for (auto& speaker : speakers)
+    collectFieldSources();
+
+    const auto geometry = computeSliceGeometry();
+    renderSliceImage (geometry);
+    profiler.counters().cellsEvaluated += (int) sliceLevels.size();
+    profiler.counters().cellsDrawn += (int) sliceLevels.size();
+
+    const auto imageWidth  = (float) sliceImage.getWidth();
+    const auto imageHeight = (float) sliceImage.getHeight();
+
+    auto cornerAt = [&] (float u, float v)
     {
-        if (cameraInside && speaker.depth < -insideNearPlane)
+        return geometry.origin + geometry.uAxis * u + geometry.vAxis * v;
+    };
+
+    auto& outline = acquireScratchPath();
+
+    if (! cameraInside)
+    {
+        // Orthographic projection keeps the plane affine, so one transform maps the whole image.
+        const auto topLeft    = projectPoint (cornerAt (0.0f, 0.0f)).screen;
+        const auto topRight   = projectPoint (cornerAt (1.0f, 0.0f)).screen;
+        const auto bottomLeft = projectPoint (cornerAt (0.0f, 1.0f)).screen;
+        const auto bottomRight = projectPoint (cornerAt (1.0f, 1.0f)).screen;
+
+        g.drawImageTransformed (sliceImage,
+                                juce::AffineTransform::fromTargetPoints ({ 0.0f, 0.0f }, topLeft,
+                                                                         { imageWidth, 0.0f }, topRight,
+                                                                         { 0.0f, imageHeight }, bottomLeft));
+
+        outline.startNewSubPath (topLeft);
+        outline.lineTo (topRight);
+        outline.lineTo (bottomRight);
+        outline.lineTo (bottomLeft);
+        outline.closeSubPath();
+    }
+    else
+    {
+        // Perspective is not affine, so split the plane into tiles and map each triangle
+        // with its own transform; triangles crossing the near plane are dropped.
+        const auto params = computeInsideProjectionParameters (getLocalBounds().toFloat());
+
+        struct TileVertex
         {
-            if (! speaker.trail.empty())
-                speaker.trail.clear();
-            continue;
+            juce::Point<float> screen;
+            juce::Point<float> texture;
+            bool visible = false;
+        };
+
+        constexpr int verticesPerSide = sliceInsideTiles + 1;
+        std::array<TileVertex, verticesPerSide * verticesPerSide> vertices;
+
+        for (int v = 0; v < verticesPerSide; ++v)
+        {
+            for (int u = 0; u < verticesPerSide; ++u)
+            {
+                const auto fu = (float) u / (float) sliceInsideTiles;
+                const auto fv = (float) v / (float) sliceInsideTiles;
+                const auto relative = cornerAt (fu, fv) - params.cameraPosition;
+
+                const float camX = params.row0.x * relative.x + params.row0.y * relative.y + params.row0.z * relative.z;
+                const float camY = params.row1.x * relative.x + params.row1.y * relative.y + params.row1.z * relative.z;
+                const float camZ = params.row2.x * relative.x + params.row2.y * relative.y + params.row2.z * relative.z;
+                const float depth = -camZ;
+
+                auto& vertex = vertices[(size_t) (v * verticesPerSide + u)];
+                vertex.visible = depth >= params.nearPlane;
+                vertex.texture = { fu * imageWidth, fv * imageHeight };
+
+                if (vertex.visible)
+                    vertex.screen = { params.centre.x + (camX * params.focalX) / depth,
+                                      params.centre.y - (camY * params.focalY) / depth };
+            }
         }
 
-        if (! speaker.trail.empty()
-            && speaker.projected.getDistanceFrom (speaker.trail.back()) < 0.25f)
+        auto& triangle = acquireScratchPath();
+
+        auto drawTriangle = [&] (const TileVertex& a, const TileVertex& b, const TileVertex& c)
         {
-            continue;
+            if (! (a.visible && b.visible && c.visible))
+                return;
+
+            triangle.clear();
+            triangle.addTriangle (a.screen, b.screen, c.screen);
+
+            juce::Graphics::ScopedSaveState state (g);
+            g.reduceClipRegion (triangle);
+            g.drawImageTransformed (sliceImage,
+                                    juce::AffineTransform::fromTargetPoints (a.texture, a.screen,
+                                                                             b.texture, b.screen,
+                                                                             c.texture, c.screen));
+        };
+
+        for (int v = 0; v < sliceInsideTiles; ++v)
+        {
+            for (int u = 0; u < sliceInsideTiles; ++u)
+            {
+                const auto& topLeft     = vertices[(size_t) (v * verticesPerSide + u)];
+                const auto& topRight    = vertices[(size_t) (v * verticesPerSide + u + 1)];
+                const auto& bottomLeft  = vertices[(size_t) ((v + 1) * verticesPerSide + u)];
+                const auto& bottomRight = vertices[(size_t) ((v + 1) * verticesPerSide + u + 1)];
+
+                drawTriangle (topLeft, topRight, bottomRight);
+                drawTriangle (topLeft, bottomRight, bottomLeft);
+            }
         }
 
-        speaker.trail.push_back (speaker.projected);
-        while (speaker.trail.size() > trailHistoryLength)
-            speaker.trail.pop_front();
+        auto addEdge = [&] (int fromIndex, int toIndex)
+        {
+            const auto& from = vertices[(size_t) fromIndex];
+            const auto& to   = vertices[(size_t) toIndex];
+            if (! (from.visible && to.visible))
+                return;
+
+            outline.startNewSubPath (from.screen);
+            outline.lineTo (to.screen);
+        };
+
+        for (int i = 0; i < sliceInsideTiles; ++i)
+        {
+            addEdge (i, i + 1);
+            addEdge (sliceInsideTiles * verticesPerSide + i, sliceInsideTiles * verticesPerSide + i + 1);
+            addEdge (i * verticesPerSide, (i + 1) * verticesPerSide);
+            addEdge (i * verticesPerSide + sliceInsideTiles, (i + 1) * verticesPerSide + sliceInsideTiles);
+        }
     }
+
+    g.setColour (juce::Colours::whitesmoke.withAlpha (0.45f));
+    g.strokePath (outline, juce::PathStrokeType (1.2f));
 }
 
-juce::Colour SpeakerVisualizerComponent::colourForLevel (float level, float maxLevel) const
+void SpeakerVisualizerComponent::drawVolumetricField (juce::Graphics& g)
 {
-    if (maxLevel <= 1.0e-6f)
-        return juce::Colours::transparentBlack;
-
-    const auto ratio = juce::jlimit (0.0f, 1.0f, level / juce::jmax (maxLevel, 1.0e-6f));
-
-    if (ratio <= 1.0e-5f)
-        return juce::Colour::fromFloatRGBA (0.18f, 0.21f, 0.28f, 1.0f);
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
 
-    return colourForHeatmapRatio (ratio);
+    const auto renderStart = juce::Time::getMillisecondCounterHiRes();
+
+    collectFieldSources();
+    const auto frameMax = updateVolumeGrid();
+    cachedVolumeMaxLevel = juce::jmax (cachedVolumeMaxLevel * 0.85f, frameMax);
+
+    renderVolumeImage();
+    profiler.counters().cellsEvaluated += (int) volumeLevels.size();
+    profiler.counters().cellsDrawn += volumeImage.getWidth() * volumeImage.getHeight();
+
+    // Walk the quality table so the next frame lands inside the budget, with a dead band
+    // between the two thresholds to avoid flickering between steps. Exports have no budget.
+    const auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - renderStart;
+    if (exporting)
+        volumeQuality = 0;
+    else if (elapsedMs > volumeFrameBudgetMs * 1.2)
+        volumeQuality = juce::jmin ((int) volumeQualitySteps.size() - 1, volumeQuality + 1);
+    else if (elapsedMs < volumeFrameBudgetMs * 0.5)
+        volumeQuality = juce::jmax (0, volumeQuality - 1);
+
+    juce::Graphics::ScopedSaveState state (g);
+    g.setImageResamplingQuality (juce::Graphics::mediumResamplingQuality);
+    g.drawImage (volumeImage, getLocalBounds().toFloat());
 }
 
-juce::AffineTransform SpeakerVisualizerComponent::rotationTransform (juce::Point<float> centre,
-                                                                     juce::Point<float> direction,
-                                                                     float width,
-                                                                     float height) const
+float SpeakerVisualizerComponent::updateVolumeGrid()
 {
-    auto dir = direction;
-    auto len = dir.getDistanceFromOrigin();
-    if (len > 1.0e-4f)
-        dir /= len;
-    else
-        dir = { 0.0f, -1.0f };
+    const auto densityIndex = (size_t) juce::jlimit (0, (int) volumeLateralCells.size() - 1, heatmapDensityLevel - 1);
+    volumeDims = { volumeLateralCells[densityIndex], volumeVerticalCells[densityIndex], volumeLateralCells[densityIndex] };
 
-    const auto angle = std::atan2 (dir.y, dir.x);
+    const auto nx = volumeDims[0];
+    const auto ny = volumeDims[1];
+    const auto nz = volumeDims[2];
+    volumeLevels.resize ((size_t) (nx * ny * nz));
 
-    return juce::AffineTransform::scale (width, height)
-        .rotated (angle)
-        .translated (centre.x, centre.y);
+    const auto depthHalf = roomDimensions.depth * 0.5f;
+    const auto widthHalf = roomDimensions.width * 0.5f;
+    const auto floorY    = -roomDimensions.earHeight;
+    const auto ceilingY  = roomDimensions.height - roomDimensions.earHeight;
+
+    FrameVector<float> layerMaxima ((size_t) ny, 0.0f, FrameAllocator<float> (frameArena));
+
+    parallelForChunks (renderPool.get(), ny, [&] (int layerStart, int layerEnd)
+    {
+        for (int y = layerStart; y < layerEnd; ++y)
+        {
+            const auto fy = juce::jmap ((float) y, 0.0f, (float) (ny - 1), floorY, ceilingY);
+            float layerMax = 0.0f;
+
+            for (int z = 0; z < nz; ++z)
+            {
+                const auto fz = juce::jmap ((float) z, 0.0f, (float) (nz - 1), -widthHalf, widthHalf);
+                auto* row = volumeLevels.data() + ((size_t) y * (size_t) nz + (size_t) z) * (size_t) nx;
+
+                for (int x = 0; x < nx; ++x)
+                {
+                    const auto fx = juce::jmap ((float) x, 0.0f, (float) (nx - 1), -depthHalf, depthHalf);
+                    row[x] = evaluateFieldLevel ({ fx, fy, fz });
+                    layerMax = std::max (layerMax, row[x]);
+                }
+            }
+
+            layerMaxima[(size_t) y] = layerMax;
+        }
+    });
+
+    return *std::max_element (layerMaxima.begin(), layerMaxima.end());
 }
 
-void SpeakerVisualizerComponent::applyZoomFactorToCamera()
+void SpeakerVisualizerComponent::renderVolumeImage()
 {
-    cameraBaseDistance = juce::jmax (0.001f, cameraBaseDistance);
-    zoomFactor = juce::jlimit (getCurrentMinZoom(), maxZoomFactor, zoomFactor);
+    const auto quality = volumeQualitySteps[(size_t) juce::jlimit (0, (int) volumeQualitySteps.size() - 1, volumeQuality)];
+    const auto bounds = getLocalBounds().toFloat();
+    const int width  = juce::jmax (1, (int) std::ceil (bounds.getWidth()  / (float) quality.pixelDivisor));
+    const int height = juce::jmax (1, (int) std::ceil (bounds.getHeight() / (float) quality.pixelDivisor));
 
-    if (cameraInside)
+    if (! volumeImage.isValid() || volumeImage.getWidth() != width || volumeImage.getHeight() != height)
+        volumeImage = juce::Image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+    const auto depthHalf = roomDimensions.depth * 0.5f;
+    const auto widthHalf = roomDimensions.width * 0.5f;
+    const auto floorY    = -roomDimensions.earHeight;
+    const auto diagonal  = std::sqrt (roomDimensions.depth * roomDimensions.depth
+                                      + roomDimensions.width * roomDimensions.width
+                                      + roomDimensions.height * roomDimensions.height);
+
+    const auto step = diagonal / volumeBaseSamples * quality.stepScale;
+    const auto normaliser = juce::jmax (0.12f, cachedVolumeMaxLevel);
+    const auto extinction = volumeExtinction * visualizationScale;
+
+    const auto* palette = heatmapRampLut.data();
+    constexpr float byteScale = 1.0f / 255.0f;
+
+    const auto nx = volumeDims[0];
+    const auto ny = volumeDims[1];
+    const auto nz = volumeDims[2];
+    const auto* grid = volumeLevels.data();
+    const juce::Vector3D<float> gridScale { (float) (nx - 1) / roomDimensions.depth,
+                                            (float) (ny - 1) / roomDimensions.height,
+                                            (float) (nz - 1) / roomDimensions.width };
+
+    auto sampleGrid = [=] (const juce::Vector3D<float>& p) noexcept
+    {
+        const auto gx = juce::jlimit (0.0f, (float) (nx - 1) - 1.0e-3f, (p.x + depthHalf) * gridScale.x);
+        const auto gy = juce::jlimit (0.0f, (float) (ny - 1) - 1.0e-3f, (p.y - floorY)    * gridScale.y);
+        const auto gz = juce::jlimit (0.0f, (float) (nz - 1) - 1.0e-3f, (p.z + widthHalf) * gridScale.z);
+
+        const auto ix = (int) gx, iy = (int) gy, iz = (int) gz;
+        const auto fx = gx - (float) ix, fy = gy - (float) iy, fz = gz - (float) iz;
+
+        const auto* c000 = grid + ((size_t) iy * (size_t) nz + (size_t) iz) * (size_t) nx + (size_t) ix;
+        const auto* c010 = c000 + (size_t) nz * (size_t) nx;
+        const auto* c001 = c000 + (size_t) nx;
+        const auto* c011 = c010 + (size_t) nx;
+
+        const auto lower = juce::jmap (fz, juce::jmap (fx, c000[0], c000[1]), juce::jmap (fx, c001[0], c001[1]));
+        const auto upper = juce::jmap (fz, juce::jmap (fx, c010[0], c010[1]), juce::jmap (fx, c011[0], c011[1]));
+        return juce::jmap (fy, lower, upper);
+    };
+
+    // Per-pixel ray setup for both projections; outside views are orthographic so only the
+    // ray origin moves across the image, inside views share the origin at the listener.
+    const bool inside = cameraInside;
+    const auto insideParams = computeInsideProjectionParameters (bounds);
+    auto orientation = computeCameraOrientation();
+    orientation.right = (-orientation.right).normalised();
+    orientation.up    = (orientation.forward ^ orientation.right).normalised();
+    const auto outsideCamera = orientation.forward * (-cameraDistance);
+    const auto centre = bounds.getCentre();
+    const auto scale = juce::jmax (1.0e-4f, projectionScale);
+    const auto divisor = (float) quality.pixelDivisor;
+
+    const juce::Image::BitmapData bitmap (volumeImage, juce::Image::BitmapData::writeOnly);
+    const int tilesX = (width  + volumeTileSize - 1) / volumeTileSize;
+    const int tilesY = (height + volumeTileSize - 1) / volumeTileSize;
+
+    parallelForChunks (renderPool.get(), tilesX * tilesY, [&] (int tileStart, int tileEnd)
+    {
+        for (int tile = tileStart; tile < tileEnd; ++tile)
+        {
+            const int x0 = (tile % tilesX) * volumeTileSize;
+            const int y0 = (tile / tilesX) * volumeTileSize;
+            const int x1 = juce::jmin (width,  x0 + volumeTileSize);
+            const int y1 = juce::jmin (height, y0 + volumeTileSize);
+
+            for (int py = y0; py < y1; ++py)
+            {
+                auto* pixels = reinterpret_cast<juce::PixelARGB*> (bitmap.getLinePointer (py));
+
+                for (int px = x0; px < x1; ++px)
+                {
+                    const auto sx = ((float) px + 0.5f) * divisor;
+                    const auto sy = ((float) py + 0.5f) * divisor;
+
+                    juce::Vector3D<float> origin;
+                    juce::Vector3D<float> direction;
+                    float entry = 0.0f;
+                    float exit = 0.0f;
+
+                    if (inside)
+                    {
+                        const auto camX =  (sx - insideParams.centre.x) / insideParams.focalX;
+                        const auto camY = -(sy - insideParams.centre.y) / insideParams.focalY;
+                        direction = (insideParams.row0 * camX + insideParams.row1 * camY - insideParams.row2).normalised();
+                        origin = insideParams.cameraPosition;
+                        entry = insideParams.nearPlane;
+                        exit = distanceToRoomBoundary (origin, direction);
+                    }
+                    else
+                    {
+                        const auto camX =  (sx - centre.x) / scale;
+                        const auto camY = -(sy - centre.y) / scale;
+                        origin = outsideCamera + orientation.right * camX + orientation.up * camY;
+                        direction = orientation.forward;
+
+                        if (! intersectRoomBounds (origin, direction, entry, exit))
+                        {
+                            pixels[px] = juce::PixelARGB (0, 0, 0, 0);
+                            continue;
+                        }
+
+                        entry = std::max (entry, 0.0f);
+                    }
+
+                    // Ordered jitter on the first sample hides the banding of the coarse steps.
+                    const auto jitter = (float) (((px * 7) + (py * 13)) & 7) / 8.0f;
+                    float red = 0.0f, green = 0.0f, blue = 0.0f, alpha = 0.0f;
+
+                    for (auto t = entry + step * jitter; t < exit; t += step)
+                    {
+                        const auto ratio = sampleGrid (origin + direction * t) / normaliser;
+                        if (ratio < 0.04f)
+                            continue;
+
+                        const auto clamped = juce::jmin (ratio, 1.0f);
+                        const auto sampleAlpha = juce::jmin (1.0f, clamped * clamped * extinction * step);
+                        const auto argb = palette[(size_t) (clamped * (float) (heatmapRampSize - 1))];
+                        const auto weight = (1.0f - alpha) * sampleAlpha * byteScale;
+
+                        red   += weight * (float) ((argb >> 16) & 0xffu);
+                        green += weight * (float) ((argb >> 8) & 0xffu);
+                        blue  += weight * (float) (argb & 0xffu);
+                        alpha += (1.0f - alpha) * sampleAlpha;
+
+                        if (alpha >= volumeOpaqueAlpha)
+                            break;
+                    }
+
+                    pixels[px] = juce::PixelARGB ((juce::uint8) juce::jlimit (0, 255, (int) (alpha * 255.0f)),
+                                                  (juce::uint8) juce::jlimit (0, 255, (int) (red   * 255.0f)),
+                                                  (juce::uint8) juce::jlimit (0, 255, (int) (green * 255.0f)),
+                                                  (juce::uint8) juce::jlimit (0, 255, (int) (blue  * 255.0f)));
+                }
+            }
+        }
+    });
+}
+
+void SpeakerVisualizerComponent::drawTemporalTrails (juce::Graphics& g, const DrawOrder& order)
+{
+    for (const auto* speakerPtr : order)
+    {
+        const auto& speaker = *speakerPtr;
+
+        if (speaker.trail.size() < 2)
+            continue;
+
+        const auto colour = colourForBands (speaker.metrics.bands, speaker.definition.isLfe);
+        const auto thickness = speaker.definition.isLfe ? 2.0f : 2.4f;
+
+        for (size_t i = 1; i < speaker.trail.size(); ++i)
+        {
+            const auto t = static_cast<float> (i) / static_cast<float> (speaker.trail.size() - 1);
+            g.setColour (colour.withAlpha (juce::jlimit (0.05f, 0.65f, t * 0.65f)));
+            g.drawLine (juce::Line<float> (speaker.trail[i - 1], speaker.trail[i]), thickness);
+        }
+
+        if (! speaker.definition.isLfe)
+        {
+            auto dir2D = speaker.orientation2D;
+            auto len = dir2D.getDistanceFromOrigin();
+            if (len <= 1.0e-4f)
+                continue;
+            dir2D /= len;
+
+            const auto level  = visualLevelForSpeaker (speaker);
+            const auto reach  = reachForLevel (speaker, level, 0.6f);
+            g.setColour (colour.withAlpha (0.55f));
+            g.drawLine (juce::Line<float> (speaker.projected,
+                                           speaker.projected + dir2D * juce::jlimit (20.0f, reach, reach * 1.05f)),
+                        2.2f);
+        }
+    }
+}
+
+void SpeakerVisualizerComponent::drawSpeakerBaseMarkers (juce::Graphics& g, const DrawOrder& order)
+{
+    refreshSpriteCaches (g.getInternalContext().getPhysicalPixelScaleFactor());
+
+    markerDiameters.resize (speakers.size());
+    for (const auto* speakerPtr : order)
+    {
+        const auto level = visualLevelForSpeaker (*speakerPtr);
+        const auto size  = juce::jlimit (20.0f, 65.0f, 26.0f + level * 135.0f);
+        markerDiameters[(size_t) (speakerPtr - speakers.data())] = size * 0.45f * juce::jlimit (0.6f, 1.5f, std::pow (visualizationScale, 0.25f));
+    }
+
+    layoutSpeakerLabels (order, markerDiameters);
+
+    for (const auto* speakerPtr : order)
+    {
+        const auto& speaker = *speakerPtr;
+        const auto index = (size_t) (speakerPtr - speakers.data());
+        const auto colour = colourForBands (speaker.metrics.bands, speaker.definition.isLfe);
+        const auto baseDiameter = markerDiameters[index];
+        const auto& marker = markerSpriteFor (baseDiameter);
+        const auto markerBounds = marker.boundsFor (speaker.projected, baseDiameter);
+
+        g.setColour (colour.withAlpha (0.95f));
+        g.drawImage (marker.disc, markerBounds, juce::RectanglePlacement::stretchToFit, true);
+
+        g.setColour (juce::Colours::white.withAlpha (0.5f));
+        g.drawImage (marker.ring, markerBounds, juce::RectanglePlacement::stretchToFit, true);
+
+        if (speaker.transientFlash > 0.02f)
+        {
+            // Transient flash: the ring sprite expands outwards and fades as the flash decays.
+            const auto flashDiameter = baseDiameter * (1.2f + 1.3f * (1.0f - speaker.transientFlash));
+            g.setColour (juce::Colours::white.withAlpha (speaker.transientFlash));
+            g.drawImage (marker.ring, marker.boundsFor (speaker.projected, flashDiameter),
+                         juce::RectanglePlacement::stretchToFit, true);
+        }
+
+        const auto& label = labelSprites[index];
+        const auto& placement = labelPlacements[index];
+        const auto gap = baseDiameter * 0.75f;
+
+        juce::Rectangle<float> labelBounds (label.size.x, label.size.y);
+        switch (placement.candidate)
+        {
+            case 1:  labelBounds = labelBounds.withCentre (speaker.projected).withY (speaker.projected.y - gap - label.size.y); break;
+            case 2:  labelBounds = labelBounds.withCentre (speaker.projected).withX (speaker.projected.x + gap); break;
+            case 3:  labelBounds = labelBounds.withCentre (speaker.projected).withX (speaker.projected.x - gap - label.size.x); break;
+            default: labelBounds = labelBounds.withCentre (speaker.projected).withY (speaker.projected.y + gap); break;
+        }
+
+        g.setOpacity (placement.crowded ? 0.35f : 1.0f);
+        g.drawImage (label.image, labelBounds);
+    }
+
+    g.setOpacity (1.0f);
+}
+
+void SpeakerVisualizerComponent::refreshSpriteCaches (float pixelScale)
+{
+    pixelScale = juce::jmax (1.0f, pixelScale);
+
+    if (std::abs (pixelScale - spritePixelScale) > 1.0e-3f)
+    {
+        spritePixelScale = pixelScale;
+        labelSprites.clear();
+        markerSprites.clear();
+    }
+
+    if (labelSprites.size() == speakers.size())
+        return;
+
+    // Labels are shaped once and rasterised at the display's physical scale; per frame
+    // they are only blitted, which skips text layout entirely.
+    const juce::Font font (14.0f);
+    constexpr float labelHeight = 18.0f;
+    labelSprites.resize (speakers.size());
+
+    for (size_t i = 0; i < speakers.size(); ++i)
+    {
+        auto& sprite = labelSprites[i];
+        sprite.text = speakers[i].definition.displayName;
+
+        juce::GlyphArrangement glyphs;
+        glyphs.addLineOfText (font, sprite.text, 2.0f, (labelHeight + font.getAscent() - font.getDescent()) * 0.5f);
+
+        sprite.size = { std::ceil (font.getStringWidthFloat (sprite.text)) + 4.0f, labelHeight };
+        sprite.image = juce::Image (juce::Image::ARGB,
+                                    juce::jmax (1, juce::roundToInt (sprite.size.x * pixelScale)),
+                                    juce::jmax (1, juce::roundToInt (sprite.size.y * pixelScale)),
+                                    true);
+
+        juce::Graphics sg (sprite.image);
+        sg.addTransform (juce::AffineTransform::scale (pixelScale));
+        sg.setColour (juce::Colours::white);
+        glyphs.draw (sg);
+    }
+}
+
+const SpeakerVisualizerComponent::MarkerSprite& SpeakerVisualizerComponent::markerSpriteFor (float diameter)
+{
+    // One alpha-only disc and ring per whole-pixel diameter, tinted by the current colour when drawn.
+    const auto bucket = (size_t) juce::jlimit (1, 96, juce::roundToInt (diameter));
+    if (markerSprites.size() <= bucket)
+        markerSprites.resize (bucket + 1);
+
+    auto& sprite = markerSprites[bucket];
+    if (sprite.disc.isValid())
+        return sprite;
+
+    // The pixel of padding keeps the ring's stroke and antialiasing inside the image;
+    // boundsFor() scales it back out so the circle itself lands on the marker's diameter.
+    const auto logicalSize = (float) bucket + 2.0f;
+    const auto pixelSize = juce::jmax (1, juce::roundToInt (logicalSize * spritePixelScale));
+    const auto circle = juce::Rectangle<float> (1.0f, 1.0f, (float) bucket, (float) bucket);
+    sprite.circleDiameter = (float) bucket;
+    sprite.logicalSize = logicalSize;
+
+    sprite.disc = juce::Image (juce::Image::SingleChannel, pixelSize, pixelSize, true);
+    sprite.ring = juce::Image (juce::Image::SingleChannel, pixelSize, pixelSize, true);
+
+    {
+        juce::Graphics sg (sprite.disc);
+        sg.addTransform (juce::AffineTransform::scale ((float) pixelSize / logicalSize));
+        sg.setColour (juce::Colours::white);
+        sg.fillEllipse (circle);
+    }
+
+    {
+        juce::Graphics sg (sprite.ring);
+        sg.addTransform (juce::AffineTransform::scale ((float) pixelSize / logicalSize));
+        sg.setColour (juce::Colours::white);
+        sg.drawEllipse (circle, 1.4f);
+    }
+
+    return sprite;
+}
+
+void SpeakerVisualizerComponent::layoutSpeakerLabels (const DrawOrder& order, const std::vector<float>& diameters)
+{
+    labelPlacements.resize (speakers.size());
+
+    // Placements only change when the camera (or layout) moves the projected speakers, or a
+    // marker steps to another whole-pixel diameter (its sprite, and the gap its label keeps).
+    bool unchanged = labelLayoutAnchors.size() == speakers.size() && labelLayoutDiameters.size() == speakers.size();
+    for (size_t i = 0; unchanged && i < speakers.size(); ++i)
+        unchanged = speakers[i].projected.getDistanceSquaredFrom (labelLayoutAnchors[i]) < 0.25f
+                 && juce::roundToInt (diameters[i]) == labelLayoutDiameters[i];
+
+    if (unchanged)
+        return;
+
+    labelLayoutAnchors.resize (speakers.size());
+    labelLayoutDiameters.resize (speakers.size());
+    for (size_t i = 0; i < speakers.size(); ++i)
+    {
+        labelLayoutAnchors[i] = speakers[i].projected;
+        labelLayoutDiameters[i] = juce::roundToInt (diameters[i]);
+    }
+
+    // Greedy placement: nearest speakers claim space first, trying below, above, right and
+    // left of the marker. Placed rectangles are bucketed on a coarse grid so each test only
+    // looks at its neighbours.
+    constexpr float bucketSize = 64.0f;
+    constexpr float padding = 2.0f;
+    const auto columns = juce::jmax (1, (int) std::ceil ((float) getWidth()  / bucketSize));
+    const auto rows    = juce::jmax (1, (int) std::ceil ((float) getHeight() / bucketSize));
+
+    struct BucketEntry
+    {
+        int rect;
+        int next;
+    };
+
+    FrameVector<int> bucketHeads ((size_t) (columns * rows), -1, FrameAllocator<int> (frameArena));
+    FrameVector<BucketEntry> entries { FrameAllocator<BucketEntry> (frameArena) };
+    FrameVector<juce::Rectangle<float>> placed { FrameAllocator<juce::Rectangle<float>> (frameArena) };
+    entries.reserve (order.size() * 8);
+    placed.reserve (order.size() * 2);
+
+    auto forEachBucket = [&] (const juce::Rectangle<float>& area, auto&& visit)
+    {
+        const auto x0 = juce::jlimit (0, columns - 1, (int) std::floor (area.getX() / bucketSize));
+        const auto x1 = juce::jlimit (0, columns - 1, (int) std::floor (area.getRight() / bucketSize));
+        const auto y0 = juce::jlimit (0, rows - 1, (int) std::floor (area.getY() / bucketSize));
+        const auto y1 = juce::jlimit (0, rows - 1, (int) std::floor (area.getBottom() / bucketSize));
+
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                if (! visit (y * columns + x))
+                    return false;
+
+        return true;
+    };
+
+    auto insert = [&] (const juce::Rectangle<float>& area)
+    {
+        const auto rectIndex = (int) placed.size();
+        placed.push_back (area);
+        forEachBucket (area, [&] (int bucket)
+        {
+            entries.push_back ({ rectIndex, bucketHeads[(size_t) bucket] });
+            bucketHeads[(size_t) bucket] = (int) entries.size() - 1;
+            return true;
+        });
+    };
+
+    auto isFree = [&] (const juce::Rectangle<float>& area)
+    {
+        return forEachBucket (area, [&] (int bucket)
+        {
+            for (auto entry = bucketHeads[(size_t) bucket]; entry >= 0; entry = entries[(size_t) entry].next)
+                if (placed[(size_t) entries[(size_t) entry].rect].intersects (area))
+                    return false;
+
+            return true;
+        });
+    };
+
+    // Markers are obstacles too, so labels never cover another speaker.
+    for (const auto* speakerPtr : order)
+    {
+        const auto diameter = diameters[(size_t) (speakerPtr - speakers.data())];
+        insert (juce::Rectangle<float> (diameter, diameter).withCentre (speakerPtr->projected));
+    }
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        const auto& speaker = **it;
+        const auto index = (size_t) (*it - speakers.data());
+        const auto& size = labelSprites[index].size;
+        const auto gap = diameters[index] * 0.75f;
+        const auto centred = juce::Rectangle<float> (size.x, size.y).withCentre (speaker.projected);
+
+        const std::array<juce::Rectangle<float>, 4> candidates {
+            centred.withY (speaker.projected.y + gap),
+            centred.withY (speaker.projected.y - gap - size.y),
+            centred.withX (speaker.projected.x + gap),
+            centred.withX (speaker.projected.x - gap - size.x)
+        };
+
+        auto& placement = labelPlacements[index];
+        placement = {};
+        placement.crowded = true;
+
+        for (size_t candidate = 0; candidate < candidates.size(); ++candidate)
+        {
+            if (isFree (candidates[candidate].expanded (padding)))
+            {
+                placement.candidate = (int) candidate;
+                placement.crowded = false;
+                break;
+            }
+        }
+
+        insert (candidates[(size_t) placement.candidate].expanded (padding));
+    }
+}
+
+void SpeakerVisualizerComponent::updateHeatmapCache()
+{
+    heatmapPoints.clear();
+
+    static constexpr std::array<int, 5> lateralSteps { 5, 7, 9, 11, 13 };
+    static constexpr std::array<int, 5> verticalSteps { 3, 5, 7, 9, 11 };
+
+    const auto index = juce::jlimit (0, (int) lateralSteps.size() - 1, heatmapDensityLevel - 1);
+    const int depthSteps = lateralSteps[(size_t) index];
+    const int widthSteps = lateralSteps[(size_t) index];
+    const int heightSteps = verticalSteps[(size_t) index];
+
+    const auto depthHalf = roomDimensions.depth * 0.5f;
+    const auto widthHalf = roomDimensions.width * 0.5f;
+    const auto floorY = -roomDimensions.earHeight;
+    const auto ceilingY = roomDimensions.height - roomDimensions.earHeight;
+
+    heatmapPoints.reserve (depthSteps * widthSteps * heightSteps);
+    heatmapGridDims = { depthSteps, heightSteps, widthSteps };
+    isoCellMasks.clear();
+    isoMesh.clear();
+
+    for (int y = 0; y < heightSteps; ++y)
+    {
+        const auto fy = juce::jmap ((float) y, 0.0f, (float) (heightSteps - 1), floorY + 0.12f, ceilingY - 0.12f);
+
+        for (int z = 0; z < widthSteps; ++z)
+        {
+            const auto fz = juce::jmap ((float) z, 0.0f, (float) (widthSteps - 1), -widthHalf * 0.92f, widthHalf * 0.92f);
+
+            for (int x = 0; x < depthSteps; ++x)
+            {
+                const auto fx = juce::jmap ((float) x, 0.0f, (float) (depthSteps - 1), -depthHalf * 0.92f, depthHalf * 0.92f);
+                heatmapPoints.emplace_back (fx, fy, fz);
+            }
+        }
+    }
+
+    cachedHeatmapMaxLevel = 0.0f;
+}
+
+void SpeakerVisualizerComponent::updateTrails()
+{
+    for (auto& speaker : speakers)
+    {
+        if (cameraInside && speaker.depth < -insideNearPlane)
+        {
+            if (! speaker.trail.empty())
+                speaker.trail.clear();
+            continue;
+        }
+
+        if (! speaker.trail.empty()
+            && speaker.projected.getDistanceFrom (speaker.trail.back()) < 0.25f)
+        {
+            continue;
+        }
+
+        speaker.trail.push_back (speaker.projected);
+        while (speaker.trail.size() > trailHistoryLength)
+            speaker.trail.pop_front();
+    }
+}
+
+juce::Colour SpeakerVisualizerComponent::colourForLevel (float level, float maxLevel) const
+{
+    if (maxLevel <= 1.0e-6f)
+        return juce::Colours::transparentBlack;
+
+    const auto ratio = juce::jlimit (0.0f, 1.0f, level / juce::jmax (maxLevel, 1.0e-6f));
+
+    if (ratio <= 1.0e-5f)
+        return juce::Colour::fromFloatRGBA (0.18f, 0.21f, 0.28f, 1.0f);
+
+    return colourForHeatmapRatio (ratio);
+}
+
+juce::AffineTransform SpeakerVisualizerComponent::rotationTransform (juce::Point<float> centre,
+                                                                     juce::Point<float> direction,
+                                                                     float width,
+                                                                     float height) const
+{
+    auto dir = direction;
+    auto len = dir.getDistanceFromOrigin();
+    if (len > 1.0e-4f)
+        dir /= len;
+    else
+        dir = { 0.0f, -1.0f };
+
+    const auto angle = std::atan2 (dir.y, dir.x);
+
+    return juce::AffineTransform::scale (width, height)
+        .rotated (angle)
+        .translated (centre.x, centre.y);
+}
+
+void SpeakerVisualizerComponent::buildShapeTemplates()
+{
+    // Unit shapes in a local frame where +x runs along the speaker aim and +y across it;
+    // rotationTransform() stretches them to each speaker's reach and spread per frame.
+    lobeTemplate.clear();
+    lobeTemplate.startNewSubPath (0.0f, -1.0f);
+    lobeTemplate.lineTo (0.0f, 1.0f);
+    lobeTemplate.lineTo (1.0f, 0.0f);
+    lobeTemplate.closeSubPath();
+
+    // Layers only differ in reach and spread, so all of them share one template.
+    layeredLobeTemplate.clear();
+    layeredLobeTemplate.startNewSubPath (0.0f, -0.42f);
+    layeredLobeTemplate.lineTo (0.0f, 0.42f);
+    layeredLobeTemplate.lineTo (1.0f, 0.0f);
+    layeredLobeTemplate.closeSubPath();
+
+    // The balloon is stored pre-flattened so filling it never re-subdivides curves.
+    constexpr int balloonSegments = 48;
+    balloonTemplate.clear();
+    balloonTemplate.preallocateSpace (3 * (balloonSegments + 2));
+
+    for (int i = 0; i < balloonSegments; ++i)
+    {
+        const auto angle = juce::MathConstants<float>::twoPi * (float) i / (float) balloonSegments;
+        const juce::Point<float> point { 0.5f * std::cos (angle), 0.5f * std::sin (angle) };
+
+        if (i == 0)
+            balloonTemplate.startNewSubPath (point);
+        else
+            balloonTemplate.lineTo (point);
+    }
+
+    balloonTemplate.closeSubPath();
+}
+
+juce::Path& SpeakerVisualizerComponent::acquireScratchPath()
+{
+    // Paths handed out here keep their storage between frames; paint() rewinds the pool.
+    // A deque keeps earlier references valid while the pool grows.
+    if (scratchPathsInUse == scratchPathPool.size())
+    {
+        scratchPathPool.emplace_back();
+        frameArena.noteOverflow();
+    }
+
+    auto& path = scratchPathPool[scratchPathsInUse++];
+    path.clear();
+    return path;
+}
+
+void SpeakerVisualizerComponent::strokeTemplate (juce::Graphics& g,
+                                                 const juce::Path& shape,
+                                                 const juce::AffineTransform& transform,
+                                                 float thickness)
+{
+    auto& outline = acquireScratchPath();
+    juce::PathStrokeType (thickness).createStrokedPath (outline, shape, transform);
+    g.fillPath (outline);
+}
+
+void SpeakerVisualizerComponent::applyZoomFactorToCamera()
+{
+    cameraBaseDistance = juce::jmax (0.001f, cameraBaseDistance);
+    zoomFactor = juce::jlimit (getCurrentMinZoom(), maxZoomFactor, zoomFactor);
+
+    if (cameraInside)
         cameraDistance = 0.0f;
     else
-        cameraDistance = juce::jmax (0.05f, cameraBaseDistance);
+        cameraDistance = juce::jmax (0.05f, cameraBaseDistance);
+
+    updateProjectionScale();
+}
+
+void SpeakerVisualizerComponent::captureUserState()
+{
+    auto& state = getUserState (cameraInside);
+    state.yaw = yaw;
+    state.pitch = pitch;
+    state.roll = roll;
+    state.baseDistance = cameraBaseDistance;
+    state.zoom = zoomFactor;
+}
+
+void SpeakerVisualizerComponent::restoreUserState (bool inside)
+{
+    const auto& state = getUserState (inside);
+    yaw = state.yaw;
+    pitch = state.pitch;
+    roll = state.roll;
+    cameraBaseDistance = juce::jmax (0.001f, state.baseDistance);
+    if (inside)
+        zoomFactor = juce::jlimit (getInsideMinZoomForPreset (isInsidePreset (currentPreset) ? currentPreset : CameraPreset::InsideUser), maxZoomFactor, state.zoom);
+    else
+        zoomFactor = juce::jlimit (minZoomFactor, maxZoomFactor, state.zoom);
+    applyZoomFactorToCamera();
+}
+
+SpeakerVisualizerComponent::CameraState& SpeakerVisualizerComponent::getUserState (bool inside) noexcept
+{
+    return inside ? insideUserState : outsideUserState;
+}
+
+const SpeakerVisualizerComponent::CameraState& SpeakerVisualizerComponent::getUserState (bool inside) const noexcept
+{
+    return inside ? insideUserState : outsideUserState;
+}
+
+bool SpeakerVisualizerComponent::isInsidePreset (CameraPreset preset) noexcept
+{
+    switch (preset)
+    {
+        case CameraPreset::InsideHome:
+        case CameraPreset::InsideUser:
+        case CameraPreset::InsideFront:
+        case CameraPreset::InsideBack:
+        case CameraPreset::InsideLeft:
+        case CameraPreset::InsideRight:
+        case CameraPreset::InsideTop:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool SpeakerVisualizerComponent::isUserPreset (CameraPreset preset) noexcept
+{
+    return preset == CameraPreset::OutsideUser
+        || preset == CameraPreset::InsideUser;
+}
+
+bool SpeakerVisualizerComponent::isHomePreset (CameraPreset preset) noexcept
+{
+    return preset == CameraPreset::OutsideHome
+        || preset == CameraPreset::InsideHome;
+}
+
+const SpeakerVisualizerComponent::CameraParameters* SpeakerVisualizerComponent::findPresetDefinition (CameraPreset preset) const noexcept
+{
+    const auto iter = std::find_if (presetDefinitions.begin(), presetDefinitions.end(),
+                                    [preset] (const PresetDefinition& entry)
+                                    {
+                                        return entry.preset == preset;
+                                    });
+    return iter != presetDefinitions.end() ? &iter->params : nullptr;
+}
+
+void SpeakerVisualizerComponent::promoteToUserPreset()
+{
+    captureUserState();
+    const auto target = cameraInside ? CameraPreset::InsideUser : CameraPreset::OutsideUser;
+    if (currentPreset != target)
+        currentPreset = target;
+    notifyPresetChanged();
+}
+
+void SpeakerVisualizerComponent::notifyPresetChanged()
+{
+    if (onPresetChanged)
+        onPresetChanged (currentPreset);
+}
+
+void SpeakerVisualizerComponent::resized() {}
+
+//==============================================================================
+// AtmosVizAudioProcessorEditor
+//==============================================================================
+namespace
+{
+    constexpr float kPadHandleRadius = 9.0f;
+    constexpr float kPadHandleOutline = 1.4f;
+
+    SpeakerVisualizerComponent::BandColourWeights normalisedWeights (const SpeakerVisualizerComponent::BandColourWeights& weights)
+    {
+        const auto total = weights.low + weights.mid + weights.high;
+        if (total <= 1.0e-6f)
+            return { 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f };
+
+        return { weights.low / total, weights.mid / total, weights.high / total };
+    }
+    double visualizationPercentFromAdjustment (double adjustment) noexcept
+    {
+        return juce::jlimit (50.0, 200.0, 100.0 * std::pow (2.0, adjustment / 100.0));
+    }
+
+    double visualizationAdjustmentFromPercent (double percent) noexcept
+    {
+        percent = juce::jlimit (50.0, 200.0, percent);
+        return juce::jlimit (-100.0, 100.0, std::log2 (percent / 100.0) * 100.0);
+    }
+
+
+
+    juce::String heatmapDensityLabelText (int level)
+    {
+        static const char* const labels[] { "Coarse", "Low", "Medium", "High", "Ultra" };
+        const auto index = juce::jlimit (0, 4, level - 1);
+        return juce::String (labels[index]);
+    }
+}
+
+ColourMixPadComponent::ColourMixPadComponent()
+{
+    setInterceptsMouseClicks (true, true);
+}
+
+void ColourMixPadComponent::setWeights (SpeakerVisualizerComponent::BandColourWeights newWeights)
+{
+    updateWeightsInternal (newWeights, false);
+}
+
+juce::Rectangle<float> ColourMixPadComponent::getTriangleBounds() const
+{
+    auto area = getLocalBounds().toFloat().reduced (20.0f, 28.0f);
+    if (area.getHeight() < 1.0f || area.getWidth() < 1.0f)
+        return getLocalBounds().toFloat();
+    return area;
+}
+
+juce::Point<float> ColourMixPadComponent::getCorner (int index) const
+{
+    const auto bounds = getTriangleBounds();
+    const auto bottomY = bounds.getBottom();
+    switch (index)
+    {
+        case 0: return { bounds.getX(), bottomY };
+        case 1: return { bounds.getRight(), bottomY };
+        case 2: return { bounds.getCentreX(), bounds.getY() };
+        default: return bounds.getCentre();
+    }
+}
+
+juce::Point<float> ColourMixPadComponent::getCentre() const
+{
+    const auto a = getCorner (0);
+    const auto b = getCorner (1);
+    const auto c = getCorner (2);
+    return { (a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f };
+}
+
+SpeakerVisualizerComponent::BandColourWeights ColourMixPadComponent::getNormalisedWeights() const
+{
+    return normalisedWeights (weights);
+}
+
+juce::Point<float> ColourMixPadComponent::getHandlePosition (int index) const
+{
+    const auto centre = getCentre();
+    const auto corner = getCorner (index);
+    const auto normalised = getNormalisedWeights();
+    const std::array<float, 3> shares { normalised.low, normalised.mid, normalised.high };
+    const auto share = juce::jlimit (0.0f, 1.0f, shares[juce::jlimit (0, 2, index)]);
+    return centre + (corner - centre) * share;
+}
+
+void ColourMixPadComponent::updateWeightsInternal (SpeakerVisualizerComponent::BandColourWeights newWeights, bool sendCallback)
+{
+    newWeights.low = std::max (0.0f, newWeights.low);
+    newWeights.mid = std::max (0.0f, newWeights.mid);
+    newWeights.high = std::max (0.0f, newWeights.high);
+
+    if (std::abs (newWeights.low - weights.low) < 1.0e-4f
+        && std::abs (newWeights.mid - weights.mid) < 1.0e-4f
+        && std::abs (newWeights.high - weights.high) < 1.0e-4f)
+        return;
+
+    weights = newWeights;
+    repaint();
+
+    if (sendCallback && onWeightsChanged)
+        onWeightsChanged (weights);
+}
+
+float ColourMixPadComponent::distanceToHandle (int index, juce::Point<float> point) const
+{
+    return getHandlePosition (index).getDistanceFrom (point);
+}
+
+float ColourMixPadComponent::shareForPoint (int index, juce::Point<float> point) const
+{
+    const auto centre = getCentre();
+    const auto corner = getCorner (index);
+    const auto vector = corner - centre;
+    const auto lengthSquared = vector.getDistanceSquaredFromOrigin();
+    if (lengthSquared <= 1.0e-6f)
+        return 0.0f;
+
+    const auto relative = (point - centre).getDotProduct (vector) / lengthSquared;
+    return juce::jlimit (0.0f, 1.0f, relative);
+}
+
+void ColourMixPadComponent::resized()
+{
+    repaint();
+}
+
+void ColourMixPadComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black.withAlpha (0.82f));
+
+    const auto bounds = getTriangleBounds();
+    juce::Path triangle;
+    triangle.addTriangle (getCorner (0), getCorner (1), getCorner (2));
+
+    g.setColour (juce::Colours::darkgrey.withAlpha (0.35f));
+    g.fillPath (triangle);
+
+    g.setColour (juce::Colours::white.withAlpha (0.55f));
+    g.strokePath (triangle, juce::PathStrokeType (1.4f));
+
+    const auto centre = getCentre();
+    const std::array<juce::Colour, 3> bandColours
+    {
+        juce::Colour::fromFloatRGBA (0.35f, 0.55f, 0.95f, 1.0f),
+        juce::Colour::fromFloatRGBA (0.35f, 0.85f, 0.45f, 1.0f),
+        juce::Colour::fromFloatRGBA (0.98f, 0.45f, 0.35f, 1.0f)
+    };
+    const std::array<juce::String, 3> labels { "Low", "Mid", "High" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto corner = getCorner (i);
+        g.setColour (bandColours[i].withAlpha (0.35f));
+        g.drawLine (juce::Line<float> (centre, corner), 1.1f);
+
+        auto labelArea = juce::Rectangle<float> (corner.x - 32.0f, corner.y - 20.0f, 64.0f, 18.0f);
+        if (i == 2)
+            labelArea.setCentre (corner.x, corner.y - 18.0f);
+        g.setColour (juce::Colours::white.withAlpha (0.8f));
+        g.drawFittedText (labels[i], labelArea.toNearestInt(), juce::Justification::centred, 1);
+    }
+
+    const auto normalised = getNormalisedWeights();
+    const std::array<float, 3> shares { normalised.low, normalised.mid, normalised.high };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto handle = getHandlePosition (i);
+        g.setColour (bandColours[i].withAlpha (0.9f));
+        g.fillEllipse (handle.x - kPadHandleRadius,
+                       handle.y - kPadHandleRadius,
+                       kPadHandleRadius * 2.0f,
+                       kPadHandleRadius * 2.0f);
+
+        g.setColour (juce::Colours::white.withAlpha (0.75f));
+        g.drawEllipse (handle.x - kPadHandleRadius,
+                       handle.y - kPadHandleRadius,
+                       kPadHandleRadius * 2.0f,
+                       kPadHandleRadius * 2.0f,
+                       kPadHandleOutline);
+
+        auto valueLabel = juce::Rectangle<int> ((int) std::round (handle.x - 28.0f),
+                                                (int) std::round (handle.y - 36.0f),
+                                                56,
+                                                18);
+        g.drawFittedText (juce::String (juce::roundToInt (shares[i] * 100.0f)) + " %",
+                          valueLabel,
+                          juce::Justification::centred,
+                          1);
+    }
+}
+
+void ColourMixPadComponent::mouseDown (const juce::MouseEvent& e)
+{
+    const auto pos = e.position;
+    activeHandle = -1;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (distanceToHandle (i, pos) <= kPadHandleRadius * 1.6f)
+        {
+            activeHandle = i;
+            break;
+        }
+    }
+
+    if (activeHandle < 0)
+        return;
+
+    startWeights = weights;
+    startNormalised = getNormalisedWeights();
+    startTotal = weights.low + weights.mid + weights.high;
+    if (startTotal <= 1.0e-6f)
+    {
+        startTotal = 3.0f;
+        startWeights = { 1.0f, 1.0f, 1.0f };
+        startNormalised = normalisedWeights (startWeights);
+    }
+}
+
+void ColourMixPadComponent::mouseDrag (const juce::MouseEvent& e)
+{
+    if (activeHandle < 0)
+        return;
+
+    const auto newShare = shareForPoint (activeHandle, e.position);
+
+    std::array<float, 3> startShares { startNormalised.low, startNormalised.mid, startNormalised.high };
+    std::array<float, 3> newShares = startShares;
+
+    const float otherSum = startShares[0] + startShares[1] + startShares[2] - startShares[activeHandle];
+    const float remaining = 1.0f - newShare;
+    newShares[activeHandle] = newShare;
+
+    if (otherSum <= 1.0e-6f)
+    {
+        const int first = (activeHandle + 1) % 3;
+        const int second = (activeHandle + 2) % 3;
+        newShares[first] = remaining * 0.5f;
+        newShares[second] = remaining - newShares[first];
+    }
+    else
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            if (i == activeHandle)
+                continue;
+            newShares[i] = juce::jlimit (0.0f, 1.0f, (startShares[i] / otherSum) * remaining);
+        }
+    }
+
+    const auto total = std::max (startTotal, 1.0e-3f);
+    SpeakerVisualizerComponent::BandColourWeights newWeights
+    {
+        newShares[0] * total,
+        newShares[1] * total,
+        newShares[2] * total
+    };
+
+    updateWeightsInternal (newWeights, true);
+}
+
+void ColourMixPadComponent::mouseUp (const juce::MouseEvent&)
+{
+    activeHandle = -1;
+}
+
+AudioDiagnosticsComponent::AudioDiagnosticsComponent (AtmosVizAudioProcessor& processorToWatch)
+    : processor (processorToWatch)
+{
+    setInterceptsMouseClicks (true, false);
+}
+
+void AudioDiagnosticsComponent::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz (4);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void AudioDiagnosticsComponent::timerCallback()
+{
+    snapshot = processor.getBlockTimingSnapshot();
+    analysisTier = processor.getAnalysisTier();
+    repaint();
+}
+
+void AudioDiagnosticsComponent::mouseDoubleClick (const juce::MouseEvent&)
+{
+    processor.resetBlockTimingStats();
+}
+
+void AudioDiagnosticsComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
+
+    constexpr int lineHeight = 15;
+    auto area = getLocalBounds().reduced (8, 5);
+
+    auto percent = [] (float load) { return juce::String (load * 100.0f, 1) + "%"; };
+    auto share = [this] (std::uint64_t count)
+    {
+        return juce::String ((juce::int64) count)
+             + (snapshot.totalBlocks > 0 ? " (" + juce::String (100.0 * (double) count / (double) snapshot.totalBlocks, 2) + "%)" : juce::String());
+    };
+
+    auto drawLine = [&] (const juce::String& text, juce::Colour colour)
+    {
+        g.setColour (colour);
+        g.drawText (text, area.removeFromTop (lineHeight), juce::Justification::centredLeft, true);
+    };
+
+    g.setFont (juce::Font (13.0f, juce::Font::bold));
+    drawLine ("Audio thread  (" + juce::String (snapshot.lastBudgetMs, 3) + " ms budget)", juce::Colours::white);
+
+    g.setFont (juce::Font (11.0f));
+    drawLine ("Blocks " + juce::String ((juce::int64) snapshot.totalBlocks), juce::Colours::lightgrey);
+    drawLine ("Load p50 / p95 / p99  " + percent (snapshot.p50Load) + " / " + percent (snapshot.p95Load) + " / " + percent (snapshot.p99Load),
+              juce::Colours::lightgrey);
+    drawLine ("Max load  " + percent (snapshot.maxLoad),
+              snapshot.maxLoad > 1.0f ? juce::Colours::orangered : juce::Colours::lightgrey);
+    drawLine (">50%  " + share (snapshot.blocksOverHalfBudget), juce::Colours::lightgrey);
+    drawLine (">80%  " + share (snapshot.blocksOver80Percent),
+              snapshot.blocksOver80Percent > 0 ? juce::Colours::orange : juce::Colours::lightgrey);
+    drawLine (">100% " + share (snapshot.blocksOverBudget),
+              snapshot.blocksOverBudget > 0 ? juce::Colours::orangered : juce::Colours::lightgrey);
+    drawLine ("Metrics lock wait mean / max  " + juce::String (snapshot.meanLockWaitUs, 2) + " / "
+                  + juce::String (snapshot.maxLockWaitUs, 1) + " us",
+              juce::Colours::lightgrey);
+    drawLine ("Contended waits " + share (snapshot.contendedLockWaits) + "   double-click to reset",
+              juce::Colours::grey);
+    drawLine ("Analysis tier  " + juce::String (AnalysisGovernor::getTierDescription (analysisTier)),
+              analysisTier == AnalysisGovernor::Tier::Full ? juce::Colours::lightgrey : juce::Colours::orange);
+}
+
+LoudnessPanelComponent::LoudnessPanelComponent (AtmosVizAudioProcessor& processorToWatch)
+    : processor (processorToWatch)
+{
+    setInterceptsMouseClicks (true, false);
+}
+
+void LoudnessPanelComponent::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz (10);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void LoudnessPanelComponent::timerCallback()
+{
+    snapshot = processor.getLoudnessSnapshot();
+    repaint();
+}
+
+void LoudnessPanelComponent::mouseDoubleClick (const juce::MouseEvent&)
+{
+    processor.resetIntegratedLoudness();
+}
+
+void LoudnessPanelComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
+
+    constexpr int lineHeight = 15;
+    constexpr int channelRowHeight = 14;
+    constexpr float floorLufs = -60.0f;
+    auto area = getLocalBounds().reduced (8, 5);
+
+    auto lufs = [] (float value)
+    {
+        return value > LoudnessMeter::silenceLufs ? juce::String (value, 1) : juce::String ("--");
+    };
+
+    auto drawLine = [&] (const juce::String& text, juce::Colour colour)
+    {
+        g.setColour (colour);
+        g.drawText (text, area.removeFromTop (lineHeight), juce::Justification::centredLeft, true);
+    };
+
+    g.setFont (juce::Font (13.0f, juce::Font::bold));
+    drawLine ("Loudness  (LUFS, BS.1770)", juce::Colours::white);
+
+    g.setFont (juce::Font (11.0f));
+    drawLine ("Momentary   " + lufs (snapshot.momentaryLufs), juce::Colours::lightgrey);
+    drawLine ("Short-term  " + lufs (snapshot.shortTermLufs), juce::Colours::lightgrey);
+    drawLine ("Integrated  " + lufs (snapshot.integratedLufs) + "   double-click to reset", juce::Colours::white);
+
+    // Per-channel weighted momentary loudness in two columns; LFE is excluded and reads "--".
+    const auto& definitions = processor.getSpeakerDefinitions();
+    const auto numChannels = juce::jmin (snapshot.numChannels, (int) definitions.size());
+    const auto rows = (numChannels + 1) / 2;
+    const auto columnWidth = area.getWidth() / 2;
+
+    area.removeFromTop (3);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto cell = juce::Rectangle<int> (area.getX() + (ch / rows) * columnWidth,
+                                          area.getY() + (ch % rows) * channelRowHeight,
+                                          columnWidth - 6, channelRowHeight);
+
+        const auto value = snapshot.channelMomentaryLufs[(size_t) ch];
+        const auto fraction = juce::jlimit (0.0f, 1.0f, (value - floorLufs) / -floorLufs);
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawText (definitions[(size_t) ch].id, cell.removeFromLeft (34), juce::Justification::centredLeft, true);
+
+        auto valueArea = cell.removeFromRight (34);
+        auto bar = cell.reduced (0, 4).toFloat();
+
+        g.setColour (juce::Colours::white.withAlpha (0.12f));
+        g.fillRect (bar);
+        g.setColour (juce::Colours::skyblue.withAlpha (0.8f));
+        g.fillRect (bar.withWidth (bar.getWidth() * fraction));
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawText (lufs (value), valueArea, juce::Justification::centredRight, true);
+    }
+}
+
+AlignmentPanelComponent::AlignmentPanelComponent (AtmosVizAudioProcessor& processorToWatch)
+    : processor (processorToWatch)
+{
+    setInterceptsMouseClicks (false, false);
+}
+
+void AlignmentPanelComponent::visibilityChanged()
+{
+    if (isVisible())
+    {
+        timerCallback();
+        startTimerHz (4);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void AlignmentPanelComponent::timerCallback()
+{
+    const auto& estimator = processor.getDelayEstimator();
+    numEstimates = estimator.getNumPairs();
+
+    for (int i = 0; i < numEstimates; ++i)
+        estimates[(size_t) i] = estimator.getEstimate (i);
+
+    repaint();
+}
+
+void AlignmentPanelComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
+
+    constexpr int lineHeight = 15;
+    constexpr int rowHeight = 14;
+    constexpr float minimumConfidence = 0.3f;
+    auto area = getLocalBounds().reduced (8, 5);
+
+    g.setColour (juce::Colours::white);
+    g.setFont (juce::Font (13.0f, juce::Font::bold));
+    g.drawText ("Alignment  (ms, confidence)", area.removeFromTop (lineHeight), juce::Justification::centredLeft, true);
+
+    g.setFont (juce::Font (11.0f));
+    const auto& definitions = processor.getSpeakerDefinitions();
+
+    if (numEstimates == 0)
+    {
+        g.setColour (juce::Colours::grey);
+        g.drawText ("No speaker pairs in this layout", area.removeFromTop (rowHeight), juce::Justification::centredLeft, true);
+        return;
+    }
+
+    const auto rows = (numEstimates + 1) / 2;
+    const auto columnWidth = area.getWidth() / 2;
+
+    for (int i = 0; i < numEstimates; ++i)
+    {
+        const auto& estimate = estimates[(size_t) i];
+        if (estimate.pair.first < 0 || estimate.pair.second < 0
+            || (size_t) juce::jmax (estimate.pair.first, estimate.pair.second) >= definitions.size())
+            continue;
+
+        const auto cell = juce::Rectangle<int> (area.getX() + (i / rows) * columnWidth,
+                                                area.getY() + (i % rows) * rowHeight,
+                                                columnWidth - 6, rowHeight);
+
+        const auto name = definitions[(size_t) estimate.pair.first].id + "/" + definitions[(size_t) estimate.pair.second].id;
+        const auto reliable = estimate.confidence >= minimumConfidence;
+        const auto misaligned = reliable && std::abs (estimate.lagMs) > 0.1f;
+
+        g.setColour (misaligned ? juce::Colours::orange : (reliable ? juce::Colours::lightgrey : juce::Colours::grey));
+        g.drawText (name + "  " + (reliable ? juce::String (estimate.lagMs, 2) : juce::String ("--"))
+                        + "  " + juce::String (estimate.confidence, 2),
+                    cell, juce::Justification::centredLeft, true);
+    }
+}
+
+ReplayPanelComponent::ReplayPanelComponent (TimelinePlayer& playerToControl, SpeakerVisualizerComponent& visualizerToDrive)
+    : player (playerToControl), visualizer (visualizerToDrive)
+{
+    openButton.onClick = [this] { openTimeline(); };
+    addAndMakeVisible (openButton);
+
+    playButton.onClick = [this]
+    {
+        player.setPlaying (! player.isPlaying());
+        updateControls();
+    };
+    addAndMakeVisible (playButton);
+
+    static constexpr std::array<double, 8> speeds { 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 32.0 };
+    for (size_t i = 0; i < speeds.size(); ++i)
+        speedCombo.addItem (juce::String (speeds[i]) + "x", (int) i + 1);
+    speedCombo.setSelectedId (3, juce::dontSendNotification);
+    speedCombo.onChange = [this]
+    {
+        const auto index = speedCombo.getSelectedId() - 1;
+        if (index >= 0 && index < (int) speeds.size())
+            player.setSpeed (speeds[(size_t) index]);
+    };
+    addAndMakeVisible (speedCombo);
+
+    positionSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    positionSlider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    positionSlider.setRange (0.0, 1.0);
+    positionSlider.onValueChange = [this] { player.setPositionSeconds (positionSlider.getValue()); };
+    addAndMakeVisible (positionSlider);
 
-    updateProjectionScale();
-}
+    timeLabel.setJustificationType (juce::Justification::centredRight);
+    timeLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    timeLabel.setFont (juce::Font (12.0f));
+    addAndMakeVisible (timeLabel);
 
-void SpeakerVisualizerComponent::captureUserState()
-{
-    auto& state = getUserState (cameraInside);
-    state.yaw = yaw;
-    state.pitch = pitch;
-    state.roll = roll;
-    state.baseDistance = cameraBaseDistance;
-    state.zoom = zoomFactor;
+    updateControls();
 }
 
-void SpeakerVisualizerComponent::restoreUserState (bool inside)
+void ReplayPanelComponent::visibilityChanged()
 {
-    const auto& state = getUserState (inside);
-    yaw = state.yaw;
-    pitch = state.pitch;
-    roll = state.roll;
-    cameraBaseDistance = juce::jmax (0.001f, state.baseDistance);
-    if (inside)
-        zoomFactor = juce::jlimit (getInsideMinZoomForPreset (isInsidePreset (currentPreset) ? currentPreset : CameraPreset::InsideUser), maxZoomFactor, state.zoom);
+    if (isVisible())
+    {
+        updateControls();
+        startTimerHz (10);
+    }
     else
-        zoomFactor = juce::jlimit (minZoomFactor, maxZoomFactor, state.zoom);
-    applyZoomFactorToCamera();
+    {
+        stopTimer();
+    }
 }
 
-SpeakerVisualizerComponent::CameraState& SpeakerVisualizerComponent::getUserState (bool inside) noexcept
+void ReplayPanelComponent::timerCallback()
 {
-    return inside ? insideUserState : outsideUserState;
+    updateControls();
 }
 
-const SpeakerVisualizerComponent::CameraState& SpeakerVisualizerComponent::getUserState (bool inside) const noexcept
+void ReplayPanelComponent::openTimeline()
 {
-    return inside ? insideUserState : outsideUserState;
+    chooser = std::make_unique<juce::FileChooser> ("Open a metrics timeline",
+                                                   player.isOpen() ? player.getFile() : juce::File::getSpecialLocation (juce::File::userDocumentsDirectory).getChildFile ("AtmosViz"),
+                                                   "*.avtl");
+
+    chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                          [this] (const juce::FileChooser& fc)
+                          {
+                              const auto file = fc.getResult();
+                              if (file == juce::File())
+                                  return;
+
+                              lastOpenFailed = ! player.open (file);
+                              visualizer.setReplaySource (lastOpenFailed ? nullptr : &player);
+                              player.setPlaying (! lastOpenFailed);
+                              updateControls();
+                          });
 }
 
-bool SpeakerVisualizerComponent::isInsidePreset (CameraPreset preset) noexcept
+void ReplayPanelComponent::updateControls()
 {
-    switch (preset)
+    const auto open = player.isOpen();
+    const auto duration = player.getDurationSeconds();
+
+    playButton.setEnabled (open);
+    playButton.setButtonText (player.isPlaying() ? "Pause" : "Play");
+    positionSlider.setEnabled (open);
+    openButton.setTooltip (open ? player.getFile().getFullPathName() : juce::String ("Open a recorded .avtl timeline"));
+
+    // Leave the slider alone while it is being dragged.
+    if (! positionSlider.isMouseButtonDown())
     {
-        case CameraPreset::InsideHome:
-        case CameraPreset::InsideUser:
-        case CameraPreset::InsideFront:
-        case CameraPreset::InsideBack:
-        case CameraPreset::InsideLeft:
-        case CameraPreset::InsideRight:
-        case CameraPreset::InsideTop:
-            return true;
-        default:
-            return false;
+        positionSlider.setRange (0.0, juce::jmax (0.001, duration), 0.0);
+        positionSlider.setValue (player.getPositionSeconds(), juce::dontSendNotification);
     }
+
+    timeLabel.setText (open ? formatTime (player.getPositionSeconds()) + " / " + formatTime (duration)
+                            : juce::String (lastOpenFailed ? "Not a timeline file" : "No timeline"),
+                       juce::dontSendNotification);
 }
 
-bool SpeakerVisualizerComponent::isUserPreset (CameraPreset preset) noexcept
+juce::String ReplayPanelComponent::formatTime (double seconds)
 {
-    return preset == CameraPreset::OutsideUser
-        || preset == CameraPreset::InsideUser;
+    const auto total = juce::jmax (0, (int) seconds);
+    return juce::String (total / 3600) + ":" + juce::String ((total / 60) % 60).paddedLeft ('0', 2)
+         + ":" + juce::String (total % 60).paddedLeft ('0', 2);
 }
 
-bool SpeakerVisualizerComponent::isHomePreset (CameraPreset preset) noexcept
+void ReplayPanelComponent::paint (juce::Graphics& g)
 {
-    return preset == CameraPreset::OutsideHome
-        || preset == CameraPreset::InsideHome;
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
 }
 
-const SpeakerVisualizerComponent::CameraParameters* SpeakerVisualizerComponent::findPresetDefinition (CameraPreset preset) const noexcept
+void ReplayPanelComponent::resized()
 {
-    const auto iter = std::find_if (presetDefinitions.begin(), presetDefinitions.end(),
-                                    [preset] (const PresetDefinition& entry)
-                                    {
-                                        return entry.preset == preset;
-                                    });
-    return iter != presetDefinitions.end() ? &iter->params : nullptr;
+    auto area = getLocalBounds().reduced (6, 5);
+
+    openButton.setBounds (area.removeFromLeft (64));
+    area.removeFromLeft (4);
+    playButton.setBounds (area.removeFromLeft (52));
+    area.removeFromLeft (4);
+    speedCombo.setBounds (area.removeFromLeft (66));
+    area.removeFromLeft (6);
+    timeLabel.setBounds (area.removeFromRight (110));
+    positionSlider.setBounds (area);
 }
 
-void SpeakerVisualizerComponent::promoteToUserPreset()
+FilePlayerPanelComponent::FilePlayerPanelComponent (FilePlayer& playerToControl, SpeakerVisualizerComponent& visualizerToDrive)
+    : player (playerToControl), visualizer (visualizerToDrive)
 {
-    captureUserState();
-    const auto target = cameraInside ? CameraPreset::InsideUser : CameraPreset::OutsideUser;
-    if (currentPreset != target)
-        currentPreset = target;
-    notifyPresetChanged();
+    openButton.onClick = [this] { openFile(); };
+    addAndMakeVisible (openButton);
+
+    playButton.onClick = [this]
+    {
+        player.setPlaying (! player.isPlaying());
+        updateControls();
+    };
+    addAndMakeVisible (playButton);
+
+    loopToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    loopToggle.setToggleState (player.isLooping(), juce::dontSendNotification);
+    loopToggle.onClick = [this] { player.setLooping (loopToggle.getToggleState()); };
+    addAndMakeVisible (loopToggle);
+
+    positionSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    positionSlider.setTextBoxStyle (juce::Slider::NoTextBox, false, 0, 0);
+    positionSlider.setRange (0.0, 1.0);
+    positionSlider.onValueChange = [this] { player.setPositionSeconds (positionSlider.getValue()); };
+    addAndMakeVisible (positionSlider);
+
+    timeLabel.setJustificationType (juce::Justification::centredRight);
+    timeLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    timeLabel.setFont (juce::Font (12.0f));
+    addAndMakeVisible (timeLabel);
+
+    updateControls();
 }
 
-void SpeakerVisualizerComponent::notifyPresetChanged()
+void FilePlayerPanelComponent::visibilityChanged()
 {
-    if (onPresetChanged)
-        onPresetChanged (currentPreset);
+    if (isVisible())
+    {
+        updateControls();
+        startTimerHz (10);
+    }
+    else
+    {
+        stopTimer();
+    }
 }
 
-void SpeakerVisualizerComponent::resized() {}
+void FilePlayerPanelComponent::timerCallback()
+{
+    updateControls();
+    repaint (cacheStrip);
+}
 
-//==============================================================================
-// AtmosVizAudioProcessorEditor
-//==============================================================================
-namespace
+void FilePlayerPanelComponent::openFile()
 {
-    constexpr float kPadHandleRadius = 9.0f;
-    constexpr float kPadHandleOutline = 1.4f;
+    chooser = std::make_unique<juce::FileChooser> ("Open a multichannel audio file",
+                                                   player.isOpen() ? player.getFile() : juce::File::getSpecialLocation (juce::File::userMusicDirectory),
+                                                   "*.wav;*.bwf;*.aif;*.aiff");
+
+    chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                          [this] (const juce::FileChooser& fc)
+                          {
+                              const auto file = fc.getResult();
+                              if (file == juce::File())
+                                  return;
+
+                              lastOpenFailed = ! player.open (file);
+                              visualizer.setReplaySource (lastOpenFailed ? nullptr : &player);
+                              player.setLooping (loopToggle.getToggleState());
+                              player.setPlaying (! lastOpenFailed);
+                              updateControls();
+                              repaint();
+                          });
+}
 
-    SpeakerVisualizerComponent::BandColourWeights normalisedWeights (const SpeakerVisualizerComponent::BandColourWeights& weights)
-    {
-        const auto total = weights.low + weights.mid + weights.high;
-        if (total <= 1.0e-6f)
-            return { 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f };
+void FilePlayerPanelComponent::updateControls()
+{
+    const auto open = player.isOpen();
+    const auto duration = player.getDurationSeconds();
 
-        return { weights.low / total, weights.mid / total, weights.high / total };
-    }
-    double visualizationPercentFromAdjustment (double adjustment) noexcept
+    playButton.setEnabled (open);
+    playButton.setButtonText (player.isPlaying() ? "Pause" : "Play");
+    positionSlider.setEnabled (open);
+    openButton.setTooltip (open ? player.getFile().getFullPathName() + " (" + player.getFileLayout().getDescription() + ")"
+                                : juce::String ("Open a WAV, BWF or AIFF file of up to 16 channels"));
+
+    if (player.isPlaying() != wasPlaying)
     {
-        return juce::jlimit (50.0, 200.0, 100.0 * std::pow (2.0, adjustment / 100.0));
+        wasPlaying = player.isPlaying();
+
+        if (onPlayingChanged != nullptr)
+            onPlayingChanged (wasPlaying);
     }
 
-    double visualizationAdjustmentFromPercent (double percent) noexcept
+    // Leave the slider alone while it is being dragged.
+    if (! positionSlider.isMouseButtonDown())
     {
-        percent = juce::jlimit (50.0, 200.0, percent);
-        return juce::jlimit (-100.0, 100.0, std::log2 (percent / 100.0) * 100.0);
+        positionSlider.setRange (0.0, juce::jmax (0.001, duration), 0.0);
+        positionSlider.setValue (player.getPositionSeconds(), juce::dontSendNotification);
     }
 
+    timeLabel.setText (open ? ReplayPanelComponent::formatTime (player.getPositionSeconds()) + " / " + ReplayPanelComponent::formatTime (duration)
+                            : juce::String (lastOpenFailed ? "Cannot play this file" : "No file"),
+                       juce::dontSendNotification);
+}
+
+void FilePlayerPanelComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
 
+    const auto numFrames = player.getNumFrames();
+    if (numFrames <= 0 || cacheStrip.isEmpty())
+        return;
 
-    juce::String heatmapDensityLabelText (int level)
-    {
-        static const char* const labels[] { "Coarse", "Low", "Medium", "High", "Ultra" };
-        const auto index = juce::jlimit (0, 4, level - 1);
-        return juce::String (labels[index]);
-    }
+    // One column per pixel, lit when the frame at its start has been analysed.
+    g.setColour (juce::Colours::white.withAlpha (0.12f));
+    g.fillRect (cacheStrip);
+    g.setColour (juce::Colours::limegreen.withAlpha (0.7f));
+
+    for (int x = 0; x < cacheStrip.getWidth(); ++x)
+        if (player.isFrameAnalysed ((juce::int64) x * numFrames / cacheStrip.getWidth()))
+            g.drawVerticalLine (cacheStrip.getX() + x, (float) cacheStrip.getY(), (float) cacheStrip.getBottom());
 }
 
-ColourMixPadComponent::ColourMixPadComponent()
+void FilePlayerPanelComponent::resized()
 {
-    setInterceptsMouseClicks (true, true);
+    auto area = getLocalBounds().reduced (6, 5);
+
+    openButton.setBounds (area.removeFromLeft (64).withTrimmedBottom (4));
+    area.removeFromLeft (4);
+    playButton.setBounds (area.removeFromLeft (52).withTrimmedBottom (4));
+    area.removeFromLeft (4);
+    loopToggle.setBounds (area.removeFromLeft (60).withTrimmedBottom (4));
+    area.removeFromLeft (6);
+    timeLabel.setBounds (area.removeFromRight (110).withTrimmedBottom (4));
+    cacheStrip = area.removeFromBottom (3).reduced (4, 0);
+    positionSlider.setBounds (area.withTrimmedBottom (1));
 }
 
-void ColourMixPadComponent::setWeights (SpeakerVisualizerComponent::BandColourWeights newWeights)
+namespace
 {
-    updateWeightsInternal (newWeights, false);
+    constexpr std::array<std::pair<int, int>, 4> exportSizes { { { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } } };
+    constexpr std::array<int, 5> exportFrameRates { 24, 25, 30, 50, 60 };
 }
 
-juce::Rectangle<float> ColourMixPadComponent::getTriangleBounds() const
+ExportPanelComponent::ExportPanelComponent (AtmosVizAudioProcessor& processorToUse, SpeakerVisualizerComponent& viewToExport)
+    : processor (processorToUse), visualizer (viewToExport)
 {
-    auto area = getLocalBounds().toFloat().reduced (20.0f, 28.0f);
-    if (area.getHeight() < 1.0f || area.getWidth() < 1.0f)
-        return getLocalBounds().toFloat();
-    return area;
+    sourceButton.onClick = [this] { chooseSource(); };
+    addAndMakeVisible (sourceButton);
+
+    for (size_t i = 0; i < exportSizes.size(); ++i)
+        sizeCombo.addItem (juce::String (exportSizes[i].first) + " x " + juce::String (exportSizes[i].second), (int) i + 1);
+    sizeCombo.setSelectedId (2, juce::dontSendNotification);
+    addAndMakeVisible (sizeCombo);
+
+    for (size_t i = 0; i < exportFrameRates.size(); ++i)
+        frameRateCombo.addItem (juce::String (exportFrameRates[i]) + " fps", (int) i + 1);
+    frameRateCombo.setSelectedId (3, juce::dontSendNotification);
+    addAndMakeVisible (frameRateCombo);
+
+    for (auto* toggle : { &pngToggle, &rawToggle })
+    {
+        toggle->setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+        addAndMakeVisible (*toggle);
+    }
+
+    pngToggle.setToggleState (true, juce::dontSendNotification);
+    pngToggle.setTooltip ("Numbered PNG files, frame_000000.png onwards");
+    rawToggle.setTooltip ("frames.rgba: 8-bit RGBA frames back to back; make it a named pipe to stream into an encoder");
+
+    exportButton.onClick = [this]
+    {
+        if (exporter.isRunning())
+            exporter.stop();
+        else
+            chooseOutputAndStart();
+
+        updateControls();
+    };
+    addAndMakeVisible (exportButton);
+
+    statusLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    statusLabel.setFont (juce::Font (12.0f));
+    addAndMakeVisible (statusLabel);
+
+    updateControls();
 }
 
-juce::Point<float> ColourMixPadComponent::getCorner (int index) const
+void ExportPanelComponent::visibilityChanged()
 {
-    const auto bounds = getTriangleBounds();
-    const auto bottomY = bounds.getBottom();
-    switch (index)
+    if (isVisible())
     {
-        case 0: return { bounds.getX(), bottomY };
-        case 1: return { bounds.getRight(), bottomY };
-        case 2: return { bounds.getCentreX(), bounds.getY() };
-        default: return bounds.getCentre();
+        updateControls();
+        startTimerHz (10);
+    }
+    else
+    {
+        stopTimer();
     }
 }
 
-juce::Point<float> ColourMixPadComponent::getCentre() const
+void ExportPanelComponent::timerCallback()
 {
-    const auto a = getCorner (0);
-    const auto b = getCorner (1);
-    const auto c = getCorner (2);
-    return { (a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f };
+    updateControls();
 }
 
-SpeakerVisualizerComponent::BandColourWeights ColourMixPadComponent::getNormalisedWeights() const
+void ExportPanelComponent::chooseSource()
 {
-    return normalisedWeights (weights);
+    chooser = std::make_unique<juce::FileChooser> ("Export from a timeline or audio file",
+                                                   sourceFile.existsAsFile() ? sourceFile : juce::File::getSpecialLocation (juce::File::userDocumentsDirectory).getChildFile ("AtmosViz"),
+                                                   "*.avtl;*.wav;*.bwf;*.aif;*.aiff");
+
+    chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                          [this] (const juce::FileChooser& fc)
+                          {
+                              const auto file = fc.getResult();
+                              if (file == juce::File())
+                                  return;
+
+                              sourceFile = file;
+                              showingResult = false;
+                              updateControls();
+                          });
 }
 
-juce::Point<float> ColourMixPadComponent::getHandlePosition (int index) const
+void ExportPanelComponent::chooseOutputAndStart()
 {
-    const auto centre = getCentre();
-    const auto corner = getCorner (index);
-    const auto normalised = getNormalisedWeights();
-    const std::array<float, 3> shares { normalised.low, normalised.mid, normalised.high };
-    const auto share = juce::jlimit (0.0f, 1.0f, shares[juce::jlimit (0, 2, index)]);
-    return centre + (corner - centre) * share;
+    chooser = std::make_unique<juce::FileChooser> ("Choose a folder for the frames", sourceFile.getParentDirectory());
+
+    chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+                          [this] (const juce::FileChooser& fc)
+                          {
+                              const auto folder = fc.getResult();
+                              if (folder == juce::File())
+                                  return;
+
+                              const auto size = exportSizes[(size_t) juce::jlimit (0, (int) exportSizes.size() - 1, sizeCombo.getSelectedId() - 1)];
+
+                              FrameExporter::Settings settings;
+                              settings.width = size.first;
+                              settings.height = size.second;
+                              settings.framesPerSecond = exportFrameRates[(size_t) juce::jlimit (0, (int) exportFrameRates.size() - 1, frameRateCombo.getSelectedId() - 1)];
+                              settings.writePng = pngToggle.getToggleState();
+                              settings.writeRaw = rawToggle.getToggleState();
+                              settings.outputDirectory = folder;
+
+                              exporter.start (processor, visualizer, sourceFile, settings);
+                              showingResult = true;
+                              updateControls();
+                          });
 }
 
-void ColourMixPadComponent::updateWeightsInternal (SpeakerVisualizerComponent::BandColourWeights newWeights, bool sendCallback)
+void ExportPanelComponent::updateControls()
 {
-    newWeights.low = std::max (0.0f, newWeights.low);
-    newWeights.mid = std::max (0.0f, newWeights.mid);
-    newWeights.high = std::max (0.0f, newWeights.high);
-
-    if (std::abs (newWeights.low - weights.low) < 1.0e-4f
-        && std::abs (newWeights.mid - weights.mid) < 1.0e-4f
-        && std::abs (newWeights.high - weights.high) < 1.0e-4f)
-        return;
+    const auto running = exporter.isRunning();
+
+    // Free the offscreen views as soon as an export has ended.
+    if (wasRunning && ! running)
+        exporter.stop();
+
+    wasRunning = running;
+
+    for (auto* control : std::initializer_list<juce::Component*> { &sourceButton, &sizeCombo, &frameRateCombo, &pngToggle, &rawToggle })
+        control->setEnabled (! running);
+
+    exportButton.setButtonText (running ? "Cancel" : "Export...");
+    exportButton.setEnabled (running || sourceFile.existsAsFile());
+    sourceButton.setTooltip (sourceFile.existsAsFile() ? sourceFile.getFullPathName()
+                                                       : juce::String ("Choose a recorded .avtl timeline, or a WAV, BWF or AIFF file to analyse"));
+
+    const auto progress = juce::String (exporter.getFramesDone()) + " / " + juce::String (exporter.getTotalFrames()) + " frames";
+    const auto speed = juce::String (exporter.getSpeedFactor(), 1) + "x realtime";
+    juce::String status;
+
+    if (running)
+        status = progress + ", " + speed;
+    else if (! showingResult)
+        status = sourceFile.existsAsFile() ? sourceFile.getFileName() : juce::String ("No source");
+    else if (exporter.getErrorMessage().isNotEmpty())
+        status = exporter.getErrorMessage();
+    else if (exporter.wasSuccessful())
+        status = "Done: " + progress + " at " + speed;
+    else
+        status = "Cancelled at " + progress;
 
-    weights = newWeights;
-    repaint();
+    statusLabel.setText (status, juce::dontSendNotification);
+}
 
-    if (sendCallback && onWeightsChanged)
-        onWeightsChanged (weights);
+void ExportPanelComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
 }
 
-float ColourMixPadComponent::distanceToHandle (int index, juce::Point<float> point) const
+void ExportPanelComponent::resized()
 {
-    return getHandlePosition (index).getDistanceFrom (point);
+    auto area = getLocalBounds().reduced (6, 5);
+
+    auto top = area.removeFromTop (24);
+    sourceButton.setBounds (top.removeFromLeft (72));
+    top.removeFromLeft (6);
+    statusLabel.setBounds (top);
+
+    area.removeFromTop (4);
+    auto bottom = area.removeFromTop (24);
+    sizeCombo.setBounds (bottom.removeFromLeft (108));
+    bottom.removeFromLeft (4);
+    frameRateCombo.setBounds (bottom.removeFromLeft (72));
+    bottom.removeFromLeft (6);
+    pngToggle.setBounds (bottom.removeFromLeft (56));
+    rawToggle.setBounds (bottom.removeFromLeft (64));
+    exportButton.setBounds (bottom.removeFromRight (76));
 }
 
-float ColourMixPadComponent::shareForPoint (int index, juce::Point<float> point) const
+ActivityTimelineComponent::ActivityTimelineComponent (AtmosVizAudioProcessor& processorToWatch)
+    : processor (processorToWatch)
 {
-    const auto centre = getCentre();
-    const auto corner = getCorner (index);
-    const auto vector = corner - centre;
-    const auto lengthSquared = vector.getDistanceSquaredFromOrigin();
-    if (lengthSquared <= 1.0e-6f)
-        return 0.0f;
+    setMouseCursor (juce::MouseCursor::DraggingHandCursor);
 
-    const auto relative = (point - centre).getDotProduct (vector) / lengthSquared;
-    return juce::jlimit (0.0f, 1.0f, relative);
+    // Keeps collecting while hidden so the timeline covers the whole time the editor is open.
+    startTimerHz (20);
 }
 
-void ColourMixPadComponent::resized()
+void ActivityTimelineComponent::timerCallback()
 {
-    repaint();
+    collectFrames();
+
+    if (isShowing())
+    {
+        updateRaster();
+        repaint();
+    }
 }
 
-void ColourMixPadComponent::paint (juce::Graphics& g)
+void ActivityTimelineComponent::collectFrames()
 {
-    g.fillAll (juce::Colours::black.withAlpha (0.82f));
-
-    const auto bounds = getTriangleBounds();
-    juce::Path triangle;
-    triangle.addTriangle (getCorner (0), getCorner (1), getCorner (2));
+    constexpr float floorDb = -100.0f;
 
-    g.setColour (juce::Colours::darkgrey.withAlpha (0.35f));
-    g.fillPath (triangle);
+    const auto& history = processor.getMetricsHistory();
+    const auto newest = history.getNumWritten();
+    if (historyCursor < 0)
+        historyCursor = newest;
+    historyCursor = juce::jlimit (history.getOldestAvailable(), newest, historyCursor);
 
-    g.setColour (juce::Colours::white.withAlpha (0.55f));
-    g.strokePath (triangle, juce::PathStrokeType (1.4f));
+    const auto samplesPerFrame = juce::jmax (1.0, processor.getSampleRate() * frameSeconds);
 
-    const auto centre = getCentre();
-    const std::array<juce::Colour, 3> bandColours
+    for (; historyCursor < newest; ++historyCursor)
     {
-        juce::Colour::fromFloatRGBA (0.35f, 0.55f, 0.95f, 1.0f),
-        juce::Colour::fromFloatRGBA (0.35f, 0.85f, 0.45f, 1.0f),
-        juce::Colour::fromFloatRGBA (0.98f, 0.45f, 0.35f, 1.0f)
-    };
-    const std::array<juce::String, 3> labels { "Low", "Mid", "High" };
+        if (! history.read (historyCursor, historyFrame))
+            continue;
 
-    for (int i = 0; i < 3; ++i)
-    {
-        const auto corner = getCorner (i);
-        g.setColour (bandColours[i].withAlpha (0.35f));
-        g.drawLine (juce::Line<float> (centre, corner), 1.1f);
+        const auto numChannels = juce::jlimit (1, AtmosVizAudioProcessor::MetricsHistoryRing::maxChannels, historyFrame.numChannels);
 
-        auto labelArea = juce::Rectangle<float> (corner.x - 32.0f, corner.y - 20.0f, 64.0f, 18.0f);
-        if (i == 2)
-            labelArea.setCentre (corner.x, corner.y - 18.0f);
-        g.setColour (juce::Colours::white.withAlpha (0.8f));
-        g.drawFittedText (labels[i], labelArea.toNearestInt(), juce::Justification::centred, 1);
-    }
+        if (pyramid == nullptr || pyramid->getNumChannels() != numChannels)
+        {
+            // A layout change starts a new timeline.
+            pyramid = std::make_unique<ActivityPyramid> (numChannels, pyramidDepth);
+            columnCells.resize ((size_t) numChannels);
+            powerSums.fill (0.0);
+            pendingSamples = 0.0;
+            followLive = true;
+            rasterDirty = true;
+        }
 
-    const auto normalised = getNormalisedWeights();
-    const std::array<float, 3> shares { normalised.low, normalised.mid, normalised.high };
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto rms = (double) historyFrame.channels[(size_t) ch].rms;
+            powerSums[(size_t) ch] += rms * rms * historyFrame.numSamples;
+        }
 
-    for (int i = 0; i < 3; ++i)
-    {
-        const auto handle = getHandlePosition (i);
-        g.setColour (bandColours[i].withAlpha (0.9f));
-        g.fillEllipse (handle.x - kPadHandleRadius,
-                       handle.y - kPadHandleRadius,
-                       kPadHandleRadius * 2.0f,
-                       kPadHandleRadius * 2.0f);
+        pendingSamples += historyFrame.numSamples;
+        if (pendingSamples < samplesPerFrame)
+            continue;
 
-        g.setColour (juce::Colours::white.withAlpha (0.75f));
-        g.drawEllipse (handle.x - kPadHandleRadius,
-                       handle.y - kPadHandleRadius,
-                       kPadHandleRadius * 2.0f,
-                       kPadHandleRadius * 2.0f,
-                       kPadHandleOutline);
+        // A block longer than a frame becomes several equal frames, keeping the time axis linear.
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto meanPower = powerSums[(size_t) ch] / pendingSamples;
+            frameValues[(size_t) ch] = juce::Decibels::gainToDecibels ((float) std::sqrt (meanPower), floorDb);
+            powerSums[(size_t) ch] = meanPower;
+        }
+
+        for (; pendingSamples >= samplesPerFrame; pendingSamples -= samplesPerFrame)
+            pyramid->push (frameValues.data());
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            powerSums[(size_t) ch] *= pendingSamples;
+    }
+}
+
+juce::int64 ActivityTimelineComponent::getLiveEndColumn() const noexcept
+{
+    return pyramid != nullptr ? pyramid->getNumFrames() / framesPerColumn : 0;
+}
+
+void ActivityTimelineComponent::updateRaster()
+{
+    if (raster.isNull())
+        return;
 
-        auto valueLabel = juce::Rectangle<int> ((int) std::round (handle.x - 28.0f),
-                                                (int) std::round (handle.y - 36.0f),
-                                                56,
-                                                18);
-        g.drawFittedText (juce::String (juce::roundToInt (shares[i] * 100.0f)) + " %",
-                          valueLabel,
-                          juce::Justification::centred,
-                          1);
+    if (followLive)
+        viewEndColumn = getLiveEndColumn();
+
+    const auto width = raster.getWidth();
+    const auto height = raster.getHeight();
+    const auto shift = viewEndColumn - rasterEndColumn;
+
+    if (rasterDirty || std::abs (shift) >= width)
+    {
+        renderColumns (0, width);
+    }
+    else if (shift > 0)
+    {
+        raster.moveImageSection (0, 0, (int) shift, 0, width - (int) shift, height);
+        renderColumns (width - (int) shift, (int) shift);
+    }
+    else if (shift < 0)
+    {
+        raster.moveImageSection ((int) -shift, 0, 0, 0, width + (int) shift, height);
+        renderColumns (0, (int) -shift);
     }
+
+    rasterEndColumn = viewEndColumn;
+    rasterDirty = false;
 }
 
-void ColourMixPadComponent::mouseDown (const juce::MouseEvent& e)
+void ActivityTimelineComponent::renderColumns (int firstColumn, int numColumns)
 {
-    const auto pos = e.position;
-    activeHandle = -1;
-    for (int i = 0; i < 3; ++i)
+    // Each channel row is a level axis from -60 dBFS at the bottom to 0 dBFS at the top: solid
+    // up to the quietest frame of the column, lighter up to the loudest, with the mean marked.
+    constexpr float displayFloorDb = -60.0f;
+
+    const auto width = raster.getWidth();
+    const auto height = raster.getHeight();
+    const auto numChannels = pyramid != nullptr ? pyramid->getNumChannels() : 1;
+    const auto rowHeight = juce::jmax (1, height / numChannels);
+    const juce::Image::BitmapData bitmap (raster, juce::Image::BitmapData::writeOnly);
+
+    for (int x = firstColumn; x < firstColumn + numColumns; ++x)
     {
-        if (distanceToHandle (i, pos) <= kPadHandleRadius * 1.6f)
+        const auto column = viewEndColumn - width + x;
+        const auto hasData = pyramid != nullptr && column >= 0
+                          && pyramid->summarise (column * framesPerColumn, (column + 1) * framesPerColumn, columnCells.data());
+
+        for (int y = 0; y < height; ++y)
+            bitmap.setPixelColour (x, y, juce::Colours::transparentBlack);
+
+        if (! hasData)
+            continue;
+
+        for (int ch = 0; ch < numChannels && (ch + 1) * rowHeight <= height; ++ch)
         {
-            activeHandle = i;
-            break;
+            const auto& cell = columnCells[(size_t) ch];
+            const auto toPixels = [rowHeight] (float db) { return (db - displayFloorDb) / -displayFloorDb * (float) rowHeight; };
+            const auto minHeight = toPixels (cell.min);
+            const auto maxHeight = toPixels (cell.max);
+            const auto meanRow = (int) toPixels (cell.mean);
+
+            const auto colour = cell.max > -0.5f ? juce::Colours::red
+                                                 : juce::Colour::fromHSV (0.33f * juce::jlimit (0.0f, 1.0f, -cell.mean / 40.0f), 0.75f, 0.95f, 1.0f);
+
+            for (int level = 0; level < rowHeight && (float) level < maxHeight; ++level)
+            {
+                const auto alpha = level == meanRow ? 1.0f : ((float) level < minHeight ? 0.55f : 0.28f);
+                bitmap.setPixelColour (x, (ch + 1) * rowHeight - 1 - level, colour.withAlpha (alpha));
+            }
         }
     }
+}
 
-    if (activeHandle < 0)
-        return;
+juce::Rectangle<int> ActivityTimelineComponent::getRasterArea() const
+{
+    auto area = getLocalBounds().reduced (8, 5);
+    area.removeFromTop (16);
+    area.removeFromLeft (34);
+    return area;
+}
 
-    startWeights = weights;
-    startNormalised = getNormalisedWeights();
-    startTotal = weights.low + weights.mid + weights.high;
-    if (startTotal <= 1.0e-6f)
-    {
-        startTotal = 3.0f;
-        startWeights = { 1.0f, 1.0f, 1.0f };
-        startNormalised = normalisedWeights (startWeights);
-    }
+void ActivityTimelineComponent::resized()
+{
+    const auto area = getRasterArea();
+    raster = juce::Image (juce::Image::ARGB, juce::jmax (1, area.getWidth()), juce::jmax (1, area.getHeight()), true);
+    rasterDirty = true;
+    updateRaster();
 }
 
-void ColourMixPadComponent::mouseDrag (const juce::MouseEvent& e)
+void ActivityTimelineComponent::paint (juce::Graphics& g)
 {
-    if (activeHandle < 0)
-        return;
+    g.setColour (juce::Colours::black.withAlpha (0.78f));
+    g.fillRoundedRectangle (getLocalBounds().toFloat(), 4.0f);
 
-    const auto newShare = shareForPoint (activeHandle, e.position);
+    const auto rasterArea = getRasterArea();
+    const auto spanSeconds = (double) rasterArea.getWidth() * (double) framesPerColumn * frameSeconds;
+    const auto span = spanSeconds < 60.0   ? juce::String (spanSeconds, 1) + " s"
+                    : spanSeconds < 3600.0 ? juce::String ((int) spanSeconds / 60) + " min " + juce::String ((int) spanSeconds % 60) + " s"
+                                           : juce::String ((int) spanSeconds / 3600) + " h " + juce::String (((int) spanSeconds / 60) % 60) + " min";
 
-    std::array<float, 3> startShares { startNormalised.low, startNormalised.mid, startNormalised.high };
-    std::array<float, 3> newShares = startShares;
+    g.setColour (juce::Colours::white);
+    g.setFont (juce::Font (13.0f, juce::Font::bold));
+    // The live input is not analysed while a file plays, so the raster holds still.
+    const auto note = processor.getFilePlayer().isPlaying() ? juce::String ("  live input waits while a file plays")
+                    : followLive                              ? juce::String()
+                                                              : juce::String ("  paused, double-click for live");
+    g.drawText ("Activity  (RMS, " + span + " shown)" + note,
+                getLocalBounds().reduced (8, 5).removeFromTop (16), juce::Justification::centredLeft, true);
 
-    const float otherSum = startShares[0] + startShares[1] + startShares[2] - startShares[activeHandle];
-    const float remaining = 1.0f - newShare;
-    newShares[activeHandle] = newShare;
+    g.drawImageAt (raster, rasterArea.getX(), rasterArea.getY());
 
-    if (otherSum <= 1.0e-6f)
-    {
-        const int first = (activeHandle + 1) % 3;
-        const int second = (activeHandle + 2) % 3;
-        newShares[first] = remaining * 0.5f;
-        newShares[second] = remaining - newShares[first];
-    }
-    else
+    const auto numChannels = pyramid != nullptr ? pyramid->getNumChannels() : 0;
+    if (numChannels == 0)
+        return;
+
+    const auto rowHeight = juce::jmax (1, rasterArea.getHeight() / numChannels);
+    const auto& definitions = processor.getSpeakerDefinitions();
+    g.setFont (juce::Font (10.0f));
+
+    for (int ch = 0; ch < numChannels && (ch + 1) * rowHeight <= rasterArea.getHeight(); ++ch)
     {
-        for (int i = 0; i < 3; ++i)
+        const auto row = rasterArea.getY() + ch * rowHeight;
+
+        g.setColour (juce::Colours::white.withAlpha (0.1f));
+        g.drawHorizontalLine (row + rowHeight - 1, (float) rasterArea.getX(), (float) rasterArea.getRight());
+
+        if ((size_t) ch < definitions.size())
         {
-            if (i == activeHandle)
-                continue;
-            newShares[i] = juce::jlimit (0.0f, 1.0f, (startShares[i] / otherSum) * remaining);
+            g.setColour (juce::Colours::lightgrey);
+            g.drawText (definitions[(size_t) ch].id, juce::Rectangle<int> (rasterArea.getX() - 34, row, 32, rowHeight),
+                        juce::Justification::centredLeft, true);
         }
     }
+}
 
-    const auto total = std::max (startTotal, 1.0e-3f);
-    SpeakerVisualizerComponent::BandColourWeights newWeights
-    {
-        newShares[0] * total,
-        newShares[1] * total,
-        newShares[2] * total
-    };
+void ActivityTimelineComponent::mouseDown (const juce::MouseEvent&)
+{
+    dragStartEndColumn = viewEndColumn;
+}
 
-    updateWeightsInternal (newWeights, true);
+void ActivityTimelineComponent::mouseDrag (const juce::MouseEvent& event)
+{
+    // Dragging right looks further back; reaching the live edge resumes following it.
+    const auto liveEnd = getLiveEndColumn();
+    viewEndColumn = juce::jlimit ((juce::int64) 1, juce::jmax ((juce::int64) 1, liveEnd), dragStartEndColumn - event.getDistanceFromDragStartX());
+    followLive = viewEndColumn >= liveEnd;
+
+    updateRaster();
+    repaint();
 }
 
-void ColourMixPadComponent::mouseUp (const juce::MouseEvent&)
+void ActivityTimelineComponent::mouseDoubleClick (const juce::MouseEvent&)
 {
-    activeHandle = -1;
-}void ColourLegendComponent::setLegend (juce::String newTitle,
+    followLive = true;
+    updateRaster();
+    repaint();
+}
+
+void ActivityTimelineComponent::mouseWheelMove (const juce::MouseEvent&, const juce::MouseWheelDetails& wheel)
+{
+    if (wheel.deltaY == 0.0f || raster.isNull())
+        return;
+
+    // Zoom out no further than the whole timeline on screen.
+    juce::int64 maxFramesPerColumn = 1;
+    const auto numFrames = pyramid != nullptr ? pyramid->getNumFrames() : 0;
+    while (maxFramesPerColumn * raster.getWidth() < numFrames && maxFramesPerColumn < ((juce::int64) 1 << 30))
+        maxFramesPerColumn *= 2;
+
+    const auto previous = framesPerColumn;
+    framesPerColumn = wheel.deltaY > 0.0f ? juce::jmax ((juce::int64) 1, framesPerColumn / 2)
+                                          : juce::jmin (maxFramesPerColumn, framesPerColumn * 2);
+
+    if (framesPerColumn == previous)
+        return;
+
+    // Keep the right edge at the same point in time.
+    viewEndColumn = viewEndColumn * previous / framesPerColumn;
+    rasterDirty = true;
+    updateRaster();
+    repaint();
+}
+
+void ColourLegendComponent::setLegend (juce::String newTitle,
                                                  std::vector<Stop> newStops,
                                                  juce::String left,
                                                  juce::String centre,
@@ -1979,9 +4538,20 @@ AtmosVizAudioProcessorEditor::AtmosVizAudioProcessorEditor (AtmosVizAudioProcess
     setupSliderModeSelector();
     setupVisualizationSelector();
     setupHeatmapDensitySlider();
+    setupSliceControls();
     setupBandWeightControls();
     setupColourLegend();
     setupVisualizationGainSlider();
+    setupProfilerToggle();
+    setupDiagnosticsPanel();
+    setupLoudnessPanel();
+    setupPhantomLinksToggle();
+    setupAlignmentPanel();
+    setupTimelineRecordToggle();
+    setupReplayPanel();
+    setupFilePlayer();
+    setupActivityTimeline();
+    setupExportPanel();
     if (visualizer != nullptr)
         syncBandControlsWithWeights (visualizer->getBandColourWeights());
     else
@@ -2013,6 +4583,8 @@ AtmosVizAudioProcessorEditor::AtmosVizAudioProcessorEditor (AtmosVizAudioProcess
 
 AtmosVizAudioProcessorEditor::~AtmosVizAudioProcessorEditor()
 {
+    // The player is destroyed before the visualizer that points at it.
+    visualizer->setReplaySource (nullptr);
     closeColourMixPad();
     zoomSlider.removeListener (this);
 }
@@ -2117,6 +4689,9 @@ void AtmosVizAudioProcessorEditor::setupVisualizationSelector()
     visualizationCombo.addItem ("Directivity Balloon",1 + (int) SpeakerVisualizerComponent::VisualizationMode::DirectivityBalloon);
     visualizationCombo.addItem ("Radiation Heatmap",  1 + (int) SpeakerVisualizerComponent::VisualizationMode::RadiationHeatmap);
     visualizationCombo.addItem ("Temporal Trails",    1 + (int) SpeakerVisualizerComponent::VisualizationMode::TemporalTrail);
+    visualizationCombo.addItem ("Slice Heatmap",      1 + (int) SpeakerVisualizerComponent::VisualizationMode::SliceHeatmap);
+    visualizationCombo.addItem ("Volumetric Field",   1 + (int) SpeakerVisualizerComponent::VisualizationMode::VolumetricField);
+    visualizationCombo.addItem ("Isosurfaces",        1 + (int) SpeakerVisualizerComponent::VisualizationMode::Isosurface);
     visualizationCombo.setTooltip ("Select how speaker radiation is visualized");
     visualizationCombo.setJustificationType (juce::Justification::centredLeft);
 
@@ -2196,6 +4771,73 @@ void AtmosVizAudioProcessorEditor::setupHeatmapDensitySlider()
     addAndMakeVisible (heatmapDensitySlider);
 }
 
+void AtmosVizAudioProcessorEditor::setupSliceControls()
+{
+    slicePlaneCombo.addItem ("Ear Height",       1 + (int) SpeakerVisualizerComponent::SlicePlane::EarHeight);
+    slicePlaneCombo.addItem ("Ceiling",          1 + (int) SpeakerVisualizerComponent::SlicePlane::Ceiling);
+    slicePlaneCombo.addItem ("Vertical Section", 1 + (int) SpeakerVisualizerComponent::SlicePlane::VerticalSection);
+    slicePlaneCombo.setTooltip ("Select the plane the slice heatmap is rasterised on");
+    slicePlaneCombo.setJustificationType (juce::Justification::centredLeft);
+
+    if (visualizer != nullptr)
+        slicePlaneCombo.setSelectedId (1 + (int) visualizer->getSlicePlane(), juce::dontSendNotification);
+
+    slicePlaneCombo.onChange = [this]
+    {
+        if (visualizer == nullptr)
+            return;
+
+        const auto selected = slicePlaneCombo.getSelectedId();
+        if (selected > 0)
+        {
+            visualizer->setSlicePlane (static_cast<SpeakerVisualizerComponent::SlicePlane> (selected - 1));
+            updateSliceOffsetRange();
+        }
+    };
+
+    sliceOffsetLabel.setText ("Offset", juce::dontSendNotification);
+    sliceOffsetLabel.setJustificationType (juce::Justification::centredRight);
+    sliceOffsetLabel.setColour (juce::Label::textColourId, juce::Colours::white.withAlpha (0.85f));
+    sliceOffsetLabel.setInterceptsMouseClicks (false, false);
+
+    sliceOffsetSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    sliceOffsetSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 64, 20);
+    sliceOffsetSlider.setDoubleClickReturnValue (true, 0.0);
+    sliceOffsetSlider.setTooltip ("Move the slice plane (metres from its anchor)");
+    sliceOffsetSlider.textFromValueFunction = [] (double value)
+    {
+        return juce::String (value, 2) + " m";
+    };
+    sliceOffsetSlider.valueFromTextFunction = [] (const juce::String& text)
+    {
+        return text.upToFirstOccurrenceOf ("m", false, false).getDoubleValue();
+    };
+    sliceOffsetSlider.onValueChange = [this]
+    {
+        if (visualizer != nullptr)
+            visualizer->setSliceOffset ((float) sliceOffsetSlider.getValue());
+    };
+
+    updateSliceOffsetRange();
+
+    slicePlaneCombo.setVisible (false);
+    sliceOffsetLabel.setVisible (false);
+    sliceOffsetSlider.setVisible (false);
+    addChildComponent (slicePlaneCombo);
+    addChildComponent (sliceOffsetLabel);
+    addChildComponent (sliceOffsetSlider);
+}
+
+void AtmosVizAudioProcessorEditor::updateSliceOffsetRange()
+{
+    if (visualizer == nullptr)
+        return;
+
+    const auto range = visualizer->getSliceOffsetRange();
+    sliceOffsetSlider.setRange (range.getStart(), juce::jmax (range.getStart() + 0.01f, range.getEnd()), 0.01);
+    sliceOffsetSlider.setValue (visualizer->getSliceOffset(), juce::dontSendNotification);
+}
+
 void AtmosVizAudioProcessorEditor::setupBandWeightControls()
 {
     auto configureSlider = [] (juce::Slider& slider)
@@ -2270,6 +4912,243 @@ void AtmosVizAudioProcessorEditor::setupColourLegend()
 }
 
 
+void AtmosVizAudioProcessorEditor::setupProfilerToggle()
+{
+    profilerToggle.setButtonText ("Profiler");
+    profilerToggle.setTooltip ("Show per-stage frame timing, cell counts and allocations over the view");
+    profilerToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    profilerToggle.onClick = [this]
+    {
+        if (visualizer != nullptr)
+            visualizer->setProfilerOverlayVisible (profilerToggle.getToggleState());
+    };
+    addAndMakeVisible (profilerToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupDiagnosticsPanel()
+{
+    diagnosticsPanel = std::make_unique<AudioDiagnosticsComponent> (audioProcessor);
+    addChildComponent (*diagnosticsPanel);
+
+    diagnosticsToggle.setButtonText ("Audio Diagnostics");
+    diagnosticsToggle.setTooltip ("Show processBlock timing against the block deadline");
+    diagnosticsToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    diagnosticsToggle.onClick = [this]
+    {
+        diagnosticsPanel->setVisible (diagnosticsToggle.getToggleState());
+        diagnosticsPanel->toFront (false);
+    };
+    addAndMakeVisible (diagnosticsToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupLoudnessPanel()
+{
+    loudnessPanel = std::make_unique<LoudnessPanelComponent> (audioProcessor);
+    addChildComponent (*loudnessPanel);
+
+    loudnessToggle.setButtonText ("Loudness");
+    loudnessToggle.setTooltip ("Show BS.1770 momentary, short-term and integrated loudness with per-channel contributions");
+    loudnessToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    loudnessToggle.onClick = [this]
+    {
+        loudnessPanel->setVisible (loudnessToggle.getToggleState());
+        loudnessPanel->toFront (false);
+    };
+    addAndMakeVisible (loudnessToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupPhantomLinksToggle()
+{
+    phantomLinksToggle.setButtonText ("Phantom Links");
+    phantomLinksToggle.setTooltip ("Link speaker pairs whose signals are correlated (white) or anti-correlated (red), and mark the per-band energy vector direction and spread");
+    phantomLinksToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    phantomLinksToggle.setToggleState (visualizer->arePhantomLinksVisible(), juce::dontSendNotification);
+    phantomLinksToggle.onClick = [this]
+    {
+        if (visualizer != nullptr)
+            visualizer->setPhantomLinksVisible (phantomLinksToggle.getToggleState());
+    };
+    addAndMakeVisible (phantomLinksToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupAlignmentPanel()
+{
+    alignmentPanel = std::make_unique<AlignmentPanelComponent> (audioProcessor);
+    addChildComponent (*alignmentPanel);
+
+    alignmentToggle.setButtonText ("Alignment");
+    alignmentToggle.setTooltip ("Show GCC-PHAT arrival-time offsets between mirrored speaker pairs and the centre");
+    alignmentToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    alignmentToggle.onClick = [this]
+    {
+        alignmentPanel->setVisible (alignmentToggle.getToggleState());
+        alignmentPanel->toFront (false);
+    };
+    addAndMakeVisible (alignmentToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupReplayPanel()
+{
+    replayPanel = std::make_unique<ReplayPanelComponent> (timelinePlayer, *visualizer);
+    addChildComponent (*replayPanel);
+
+    replayToggle.setButtonText ("Replay");
+    replayToggle.setTooltip ("Drive the view from a recorded timeline instead of the live input");
+    replayToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    replayToggle.onClick = [this]
+    {
+        const auto replaying = replayToggle.getToggleState();
+
+        // Both drive the view from stored frames; only one at a time.
+        if (replaying && filePlayerToggle.getToggleState())
+            filePlayerToggle.setToggleState (false, juce::sendNotificationSync);
+
+        replayPanel->setVisible (replaying);
+        replayPanel->toFront (false);
+
+        // Back to live metrics; the timeline is reopened from the panel next time.
+        if (! replaying)
+        {
+            visualizer->setReplaySource (nullptr);
+            timelinePlayer.close();
+        }
+    };
+    addAndMakeVisible (replayToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupFilePlayer()
+{
+    // Plug-ins get their audio from the host; only the standalone app plays files.
+    if (audioProcessor.wrapperType != juce::AudioProcessor::wrapperType_Standalone)
+        return;
+
+    auto& player = audioProcessor.getFilePlayer();
+    filePlayerPanel = std::make_unique<FilePlayerPanelComponent> (player, *visualizer);
+    filePlayerPanel->onPlayingChanged = [this] (bool) { updateRecordToggleForFilePlayer(); };
+    addChildComponent (*filePlayerPanel);
+
+    filePlayerToggle.setButtonText ("File");
+    filePlayerToggle.setTooltip ("Play a multichannel file instead of the live input, with the view following the file");
+    filePlayerToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    filePlayerToggle.onClick = [this, &player]
+    {
+        const auto showing = filePlayerToggle.getToggleState();
+
+        if (showing && replayToggle.getToggleState())
+            replayToggle.setToggleState (false, juce::sendNotificationSync);
+
+        filePlayerPanel->setVisible (showing);
+        filePlayerPanel->toFront (false);
+
+        // Back to the live input; the file is reopened from the panel next time.
+        if (! showing)
+        {
+            visualizer->setReplaySource (nullptr);
+            player.close();
+            updateRecordToggleForFilePlayer();
+        }
+    };
+    addAndMakeVisible (filePlayerToggle);
+
+    // The player belongs to the processor and keeps playing while the editor is closed.
+    if (player.isOpen())
+    {
+        filePlayerToggle.setToggleState (true, juce::dontSendNotification);
+        filePlayerPanel->setVisible (true);
+        visualizer->setReplaySource (&player);
+    }
+
+    updateRecordToggleForFilePlayer();
+}
+
+void AtmosVizAudioProcessorEditor::updateRecordToggleForFilePlayer()
+{
+    // A playing file bypasses the live analysis, so there is nothing to start recording; a
+    // recording already running just waits, and can still be stopped.
+    const auto filePlaying = audioProcessor.getFilePlayer().isPlaying();
+    recordToggle.setEnabled (! filePlaying || recordToggle.getToggleState());
+
+    if (! recordToggle.getToggleState())
+        recordToggle.setTooltip (filePlaying ? juce::String ("Records the live input; pause the file to record")
+                                             : juce::String (recordIdleTooltip));
+}
+
+void AtmosVizAudioProcessorEditor::setupExportPanel()
+{
+    exportPanel = std::make_unique<ExportPanelComponent> (audioProcessor, *visualizer);
+    addChildComponent (*exportPanel);
+
+    exportToggle.setButtonText ("Export");
+    exportToggle.setTooltip ("Render the view offscreen to PNG frames or a raw RGBA stream, from a timeline or an audio file");
+    exportToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    exportToggle.onClick = [this]
+    {
+        exportPanel->setVisible (exportToggle.getToggleState());
+        exportPanel->toFront (false);
+    };
+    addAndMakeVisible (exportToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupActivityTimeline()
+{
+    activityTimeline = std::make_unique<ActivityTimelineComponent> (audioProcessor);
+    addChildComponent (*activityTimeline);
+
+    activityToggle.setButtonText ("Activity");
+    activityToggle.setTooltip ("Show per-channel RMS activity over time; scroll to zoom, drag to look back");
+    activityToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    activityToggle.onClick = [this]
+    {
+        activityTimeline->setVisible (activityToggle.getToggleState());
+        activityTimeline->toFront (false);
+    };
+    addAndMakeVisible (activityToggle);
+}
+
+void AtmosVizAudioProcessorEditor::setupTimelineRecordToggle()
+{
+    recordToggle.setButtonText ("Record");
+    recordToggle.setColour (juce::ToggleButton::textColourId, juce::Colours::white.withAlpha (0.85f));
+    recordToggle.setColour (juce::ToggleButton::tickColourId, juce::Colours::red);
+    recordToggle.setToggleState (audioProcessor.isTimelineRecording(), juce::dontSendNotification);
+    recordToggle.setTooltip (audioProcessor.isTimelineRecording() ? "Recording to " + audioProcessor.getTimelineFile().getFullPathName()
+                                                                  : juce::String (recordIdleTooltip));
+    recordToggle.onClick = [this]
+    {
+        if (! recordToggle.getToggleState())
+        {
+            audioProcessor.stopTimelineRecording();
+            recordToggle.setTooltip (recordIdleTooltip);
+            updateRecordToggleForFilePlayer();
+            return;
+        }
+
+        // Stays off until a file has been chosen and opened.
+        recordToggle.setToggleState (false, juce::dontSendNotification);
+
+        const auto defaultFile = juce::File::getSpecialLocation (juce::File::userDocumentsDirectory)
+                                     .getChildFile ("AtmosViz")
+                                     .getChildFile ("Timeline " + juce::Time::getCurrentTime().formatted ("%Y-%m-%d %H-%M-%S") + ".avtl");
+
+        timelineChooser = std::make_unique<juce::FileChooser> ("Record metrics timeline", defaultFile, "*.avtl");
+        timelineChooser->launchAsync (juce::FileBrowserComponent::saveMode
+                                          | juce::FileBrowserComponent::canSelectFiles
+                                          | juce::FileBrowserComponent::warnAboutOverwriting,
+                                      [this] (const juce::FileChooser& chooser)
+                                      {
+                                          const auto file = chooser.getResult().withFileExtension ("avtl");
+
+                                          if (chooser.getResult().getFullPathName().isNotEmpty()
+                                              && audioProcessor.startTimelineRecording (file))
+                                          {
+                                              recordToggle.setToggleState (true, juce::dontSendNotification);
+                                              recordToggle.setTooltip ("Recording to " + file.getFullPathName());
+                                          }
+                                      });
+    };
+    addAndMakeVisible (recordToggle);
+}
+
 void AtmosVizAudioProcessorEditor::setupVisualizationGainSlider()
 {
     visualizationGainLabel.setText ("Visualization Gain", juce::dontSendNotification);
@@ -2395,13 +5274,30 @@ void AtmosVizAudioProcessorEditor::updateVisualizationControlsVisibility()
         heatmapDensitySlider.setVisible (false);
         heatmapDensityLabel.setVisible (false);
         heatmapDensityValueLabel.setVisible (false);
+        slicePlaneCombo.setVisible (false);
+        sliceOffsetLabel.setVisible (false);
+        sliceOffsetSlider.setVisible (false);
         return;
     }
 
-    const bool showHeatmap = visualizer->getVisualizationMode() == SpeakerVisualizerComponent::VisualizationMode::RadiationHeatmap;
+    const auto mode = visualizer->getVisualizationMode();
+    const bool showSlice = mode == SpeakerVisualizerComponent::VisualizationMode::SliceHeatmap;
+    const bool showHeatmap = showSlice
+                          || mode == SpeakerVisualizerComponent::VisualizationMode::RadiationHeatmap
+                          || mode == SpeakerVisualizerComponent::VisualizationMode::VolumetricField
+                          || mode == SpeakerVisualizerComponent::VisualizationMode::Isosurface;
     heatmapDensitySlider.setVisible (showHeatmap);
     heatmapDensityLabel.setVisible (showHeatmap);
     heatmapDensityValueLabel.setVisible (showHeatmap);
+    slicePlaneCombo.setVisible (showSlice);
+    sliceOffsetLabel.setVisible (showSlice);
+    sliceOffsetSlider.setVisible (showSlice);
+
+    if (showSlice)
+    {
+        slicePlaneCombo.setSelectedId (1 + (int) visualizer->getSlicePlane(), juce::dontSendNotification);
+        updateSliceOffsetRange();
+    }
 
     if (showHeatmap)
     {
@@ -2427,7 +5323,10 @@ void AtmosVizAudioProcessorEditor::updateLegendContent()
     std::vector<ColourLegendComponent::Stop> stops;
     const auto mode = visualizer->getVisualizationMode();
 
-    if (mode == SpeakerVisualizerComponent::VisualizationMode::RadiationHeatmap)
+    if (mode == SpeakerVisualizerComponent::VisualizationMode::RadiationHeatmap
+        || mode == SpeakerVisualizerComponent::VisualizationMode::SliceHeatmap
+        || mode == SpeakerVisualizerComponent::VisualizationMode::VolumetricField
+        || mode == SpeakerVisualizerComponent::VisualizationMode::Isosurface)
     {
         static const std::array<float, 5> positions { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
         for (auto position : positions)
@@ -2706,6 +5605,28 @@ void AtmosVizAudioProcessorEditor::resized()
         box.performLayout (area.toFloat());
     };
 
+    auto layoutSliceControls = [this, controlHeight, spacing, scale] (juce::Rectangle<int> area)
+    {
+        if (! slicePlaneCombo.isVisible())
+        {
+            slicePlaneCombo.setBounds ({});
+            sliceOffsetLabel.setBounds ({});
+            sliceOffsetSlider.setBounds ({});
+            return;
+        }
+
+        const int planeWidth = juce::roundToInt (juce::jmax (120.0f, 140.0f * scale));
+        const int offsetLabelWidth = juce::roundToInt (juce::jmax (44.0f, 52.0f * scale));
+
+        slicePlaneCombo.setBounds (area.removeFromLeft (planeWidth).withHeight (controlHeight));
+        area.removeFromLeft (spacing);
+        sliceOffsetLabel.setBounds (area.removeFromLeft (offsetLabelWidth).withHeight (controlHeight));
+        area.removeFromLeft (spacing);
+        sliceOffsetSlider.setBounds (area.removeFromLeft (juce::jmin (area.getWidth() - spacing,
+                                                                      juce::roundToInt (260.0f * scale)))
+                                         .withHeight (controlHeight));
+    };
+
     auto sliderRow = headerArea.removeFromTop (controlHeight);
     headerBottom = sliderRow.getBottom();
 
@@ -2754,6 +5675,7 @@ void AtmosVizAudioProcessorEditor::resized()
             heatmapRow.removeFromRight (spacing);
             auto labelArea = heatmapRow.removeFromRight (heatmapLabelWidth);
             heatmapDensityLabel.setBounds (labelArea.withHeight (controlHeight));
+            layoutSliceControls (heatmapRow);
 
             headerBottom = std::max (headerBottom, std::max (valueArea.getBottom(), std::max (sliderArea.getBottom(), labelArea.getBottom())));
         }
@@ -2762,6 +5684,7 @@ void AtmosVizAudioProcessorEditor::resized()
             heatmapDensityLabel.setBounds ({});
             heatmapDensitySlider.setBounds ({});
             heatmapDensityValueLabel.setBounds ({});
+            layoutSliceControls ({});
         }
 
         headerArea.removeFromTop (spacing);
@@ -2806,6 +5729,7 @@ void AtmosVizAudioProcessorEditor::resized()
             heatmapRow.removeFromRight (spacing);
             auto labelArea = heatmapRow.removeFromRight (heatmapLabelWidth);
             heatmapDensityLabel.setBounds (labelArea.withHeight (controlHeight));
+            layoutSliceControls (heatmapRow);
 
             headerBottom = std::max (headerBottom, std::max (valueArea.getBottom(), std::max (sliderArea.getBottom(), labelArea.getBottom())));
             addDivider (heatmapRow.getBottom());
@@ -2816,6 +5740,7 @@ void AtmosVizAudioProcessorEditor::resized()
             heatmapDensityLabel.setBounds ({});
             heatmapDensitySlider.setBounds ({});
             heatmapDensityValueLabel.setBounds ({});
+            layoutSliceControls ({});
         }
     }
 
@@ -2832,7 +5757,7 @@ void AtmosVizAudioProcessorEditor::resized()
     auto weightRow = headerArea.removeFromTop (weightRowHeight);
 
     auto weightArea = weightRow;
-    const int padButtonWidth = juce::roundToInt (juce::jmax (130.0f, 150.0f * scale));
+    const int padButtonWidth = juce::roundToInt (juce::jmax (124.0f, 136.0f * scale));
     auto buttonArea = weightArea.removeFromRight (padButtonWidth);
     colourPadButton.setBounds (buttonArea.withSizeKeepingCentre (padButtonWidth, controlHeight));
     weightArea.removeFromRight (juce::roundToInt (6.0f * scale));
@@ -2899,6 +5824,37 @@ void AtmosVizAudioProcessorEditor::resized()
     auto gainLabelArea = gainRow.removeFromRight (gainLabelWidth);
     visualizationGainLabel.setBounds (gainLabelArea.withHeight (controlHeight));
 
+    const int profilerToggleWidth = juce::roundToInt (juce::jmax (80.0f, 88.0f * scale));
+    profilerToggle.setBounds (gainRow.removeFromLeft (juce::jmin (profilerToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int diagnosticsToggleWidth = juce::roundToInt (juce::jmax (124.0f, 136.0f * scale));
+    diagnosticsToggle.setBounds (gainRow.removeFromLeft (juce::jmin (diagnosticsToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int loudnessToggleWidth = juce::roundToInt (juce::jmax (82.0f, 90.0f * scale));
+    loudnessToggle.setBounds (gainRow.removeFromLeft (juce::jmin (loudnessToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int linksToggleWidth = juce::roundToInt (juce::jmax (100.0f, 110.0f * scale));
+    phantomLinksToggle.setBounds (gainRow.removeFromLeft (juce::jmin (linksToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int alignmentToggleWidth = juce::roundToInt (juce::jmax (80.0f, 88.0f * scale));
+    alignmentToggle.setBounds (gainRow.removeFromLeft (juce::jmin (alignmentToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int recordToggleWidth = juce::roundToInt (juce::jmax (68.0f, 76.0f * scale));
+    recordToggle.setBounds (gainRow.removeFromLeft (juce::jmin (recordToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    replayToggle.setBounds (gainRow.removeFromLeft (juce::jmin (recordToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    const int activityToggleWidth = juce::roundToInt (juce::jmax (72.0f, 80.0f * scale));
+    activityToggle.setBounds (gainRow.removeFromLeft (juce::jmin (activityToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    gainRow.removeFromLeft (spacing);
+    exportToggle.setBounds (gainRow.removeFromLeft (juce::jmin (recordToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+
+    if (filePlayerPanel != nullptr)
+    {
+        gainRow.removeFromLeft (spacing);
+        filePlayerToggle.setBounds (gainRow.removeFromLeft (juce::jmin (recordToggleWidth, gainRow.getWidth())).withHeight (controlHeight));
+    }
+
     headerBottom = std::max (headerBottom, std::max (gainValueArea.getBottom(), std::max (gainSliderArea.getBottom(), gainLabelArea.getBottom())));
     addDivider (gainSliderArea.getBottom());
 
@@ -2914,6 +5870,57 @@ void AtmosVizAudioProcessorEditor::resized()
     auto viewerBounds = bounds.withTrimmedTop (headerBottom + marginY)
                                .reduced (juce::roundToInt (16.0f * scale), juce::roundToInt (10.0f * scale));
     visualizer->setBounds (viewerBounds);
+
+    if (diagnosticsPanel != nullptr)
+    {
+        const int diagnosticsWidth = juce::jmin (280, viewerBounds.getWidth());
+        diagnosticsPanel->setBounds (viewerBounds.getRight() - diagnosticsWidth - 8, viewerBounds.getY() + 8, diagnosticsWidth, 163);
+    }
+
+    if (loudnessPanel != nullptr)
+    {
+        const int loudnessWidth = juce::jmin (260, viewerBounds.getWidth());
+        const int loudnessHeight = juce::jmin (190, viewerBounds.getHeight());
+        loudnessPanel->setBounds (viewerBounds.getRight() - loudnessWidth - 8, viewerBounds.getBottom() - loudnessHeight - 8,
+                                  loudnessWidth, loudnessHeight);
+    }
+
+    if (alignmentPanel != nullptr)
+    {
+        // Bottom-left, clear of the analysis quality badge.
+        const int alignmentWidth = juce::jmin (230, viewerBounds.getWidth());
+        const int alignmentHeight = juce::jmin (30 + 14 * DelayEstimator::maxPairs / 2, viewerBounds.getHeight());
+        alignmentPanel->setBounds (viewerBounds.getX() + 8, viewerBounds.getBottom() - alignmentHeight - 36,
+                                   alignmentWidth, alignmentHeight);
+    }
+
+    if (replayPanel != nullptr)
+    {
+        const int replayWidth = juce::jmin (460, viewerBounds.getWidth() - 16);
+        replayPanel->setBounds (viewerBounds.getCentreX() - replayWidth / 2, viewerBounds.getY() + 8, replayWidth, 34);
+    }
+
+    if (filePlayerPanel != nullptr)
+    {
+        const int playerWidth = juce::jmin (480, viewerBounds.getWidth() - 16);
+        filePlayerPanel->setBounds (viewerBounds.getCentreX() - playerWidth / 2, viewerBounds.getY() + 8, playerWidth, 38);
+    }
+
+    if (exportPanel != nullptr)
+    {
+        // Under the replay and file transports.
+        const int exportWidth = juce::jmin (440, viewerBounds.getWidth() - 16);
+        exportPanel->setBounds (viewerBounds.getCentreX() - exportWidth / 2, viewerBounds.getY() + 52, exportWidth, 62);
+    }
+
+    if (activityTimeline != nullptr)
+    {
+        // Along the bottom, ten pixels per channel row.
+        const auto numChannels = juce::jmax (1, (int) audioProcessor.getSpeakerDefinitions().size());
+        const int activityHeight = juce::jlimit (60, juce::jmax (60, viewerBounds.getHeight() / 2), 26 + 10 * numChannels);
+        activityTimeline->setBounds (viewerBounds.getX() + 8, viewerBounds.getBottom() - activityHeight - 8,
+                                     viewerBounds.getWidth() - 16, activityHeight);
+    }
 }
 
 
@@ -5,11 +5,18 @@
 #include <vector>
 #include <deque>
 #include <array>
+#include <cstdint>
 #include <limits>
 #include <utility>
 #include <functional>
 
 #include "PluginProcessor.h"
+#include "FrameArena.h"
+#include "FrameProfiler.h"
+#include "ParallelChunks.h"
+#include "TimelinePlayer.h"
+#include "FrameExporter.h"
+#include "ActivityPyramid.h"
 
 class SpeakerVisualizerComponent final : public juce::Component,
                                          private juce::Timer
@@ -21,7 +28,17 @@ public:
         LayeredLobes,
         DirectivityBalloon,
         RadiationHeatmap,
-        TemporalTrail
+        TemporalTrail,
+        SliceHeatmap,
+        VolumetricField,
+        Isosurface
+    };
+
+    enum class SlicePlane
+    {
+        EarHeight,
+        Ceiling,
+        VerticalSection
     };
 
     enum class CameraPreset
@@ -95,9 +112,39 @@ public:
     void setHeatmapDensity (int level);
     int getHeatmapDensity() const noexcept { return heatmapDensityLevel; }
 
+    void setSlicePlane (SlicePlane plane);
+    SlicePlane getSlicePlane() const noexcept { return slicePlane; }
+
+    void setSliceOffset (float metres);
+    float getSliceOffset() const noexcept { return sliceOffset; }
+    juce::Range<float> getSliceOffsetRange() const noexcept;
+
     juce::Colour colourForBandMix (float lowShare, float midShare, float highShare) const;
     juce::Colour colourForHeatmapRatio (float ratio) const;
+    juce::uint32 packedColourForHeatmapRatio (float ratio) const noexcept;
     bool isCameraInside() const noexcept { return cameraInside; }
+    int getArenaOverflowsLastFrame() const noexcept { return frameArena.getOverflowsLastFrame(); }
+    size_t getArenaBytesLastFrame() const noexcept { return frameArena.getBytesRequestedLastFrame(); }
+
+    void setProfilerOverlayVisible (bool shouldBeVisible);
+    bool isProfilerOverlayVisible() const noexcept { return profilerOverlayVisible; }
+
+    void setPhantomLinksVisible (bool shouldBeVisible);
+    bool arePhantomLinksVisible() const noexcept { return phantomLinksVisible; }
+
+    /** Drives the speaker metrics from a recorded timeline instead of the processor;
+        nullptr returns to live metrics. */
+    void setReplaySource (MetricsFrameSource* source);
+    bool isReplaying() const noexcept { return replaySource != nullptr; }
+
+    /** Turns this instance into an offscreen copy of another for frame export: same camera and
+        view settings, no timer, and every frame drawn on the calling thread at the best volume
+        quality. Message thread, after setBounds() and before the first renderExportFrame(). */
+    void prepareForExport (const SpeakerVisualizerComponent& viewToMatch);
+
+    /** One thread at a time: shows a stored frame and paints it into g. */
+    void renderExportFrame (const MetricsTimelineFrame& frame, const juce::StringArray& channelNames, juce::Graphics& g);
+    const FrameProfiler& getFrameProfiler() const noexcept { return profiler; }
 
     std::function<void (float)> onZoomFactorChanged;
     std::function<void (CameraPreset)> onPresetChanged;
@@ -115,6 +162,7 @@ private:
         float maxReachScreen = 120.0f;
         float maxReachWorld = 1.0f;
         std::deque<juce::Point<float>> trail;
+        float transientFlash = 0.0f;   // set by onset events, decays each timer tick
     };
 
     struct ProjectedPoint
@@ -158,6 +206,57 @@ private:
         juce::Vector3D<float> forward;
     };
 
+    struct FieldSource
+    {
+        juce::Vector3D<float> position;
+        juce::Vector3D<float> aim;
+        float amplitude = 0.0f;
+        bool omnidirectional = false;
+    };
+
+    struct IsoTriangle
+    {
+        std::array<juce::Vector3D<float>, 3> vertices;
+        std::array<std::pair<size_t, size_t>, 3> edges;   // grid points each vertex lies between
+        int cell = 0;
+        int layer = 0;
+    };
+
+    struct LabelSprite
+    {
+        juce::String text;
+        juce::Image image;
+        juce::Point<float> size;
+    };
+
+    struct MarkerSprite
+    {
+        juce::Image disc;
+        juce::Image ring;
+        float circleDiameter = 1.0f;   // logical size of the circle inside the sprite
+        float logicalSize = 3.0f;      // the sprite's logical size: the circle plus a pixel of padding each side
+
+        /** Where to draw the sprite so that its circle spans diameter around centre. */
+        juce::Rectangle<float> boundsFor (juce::Point<float> centre, float diameter) const noexcept
+        {
+            const auto size = logicalSize * diameter / circleDiameter;
+            return juce::Rectangle<float> (size, size).withCentre (centre);
+        }
+    };
+
+    struct LabelPlacement
+    {
+        int candidate = 0;
+        bool crowded = false;
+    };
+
+    struct SliceGeometry
+    {
+        juce::Vector3D<float> origin;
+        juce::Vector3D<float> uAxis;
+        juce::Vector3D<float> vAxis;
+    };
+
     InsideProjectionParameters computeInsideProjectionParameters (juce::Rectangle<float> bounds) const;
     CameraOrientation computeCameraOrientation() const noexcept;
     float getInsideMinZoomForPreset (CameraPreset preset) const noexcept;
@@ -174,14 +273,26 @@ private:
     void updateProjectionScale();
     ProjectedPoint projectPoint (const juce::Vector3D<float>& point) const;
 
-    using DrawOrder = std::vector<const DisplaySpeaker*>;
+    using DrawOrder = FrameVector<const DisplaySpeaker*>;
     void drawDirectionalLobes (juce::Graphics& g, const DrawOrder& order);
     void drawLayeredLobes (juce::Graphics& g, const DrawOrder& order);
     void drawDirectivityBalloons (juce::Graphics& g, const DrawOrder& order);
     void drawRadiationHeatmap (juce::Graphics& g);
+    void drawSliceHeatmap (juce::Graphics& g);
+    void drawVolumetricField (juce::Graphics& g);
+    void drawIsosurfaces (juce::Graphics& g);
     void drawTemporalTrails (juce::Graphics& g, const DrawOrder& order);
     void drawSpeakerBaseMarkers (juce::Graphics& g, const DrawOrder& order);
     void updateHeatmapCache();
+    void collectFieldSources();
+    float evaluateFieldLevel (const juce::Vector3D<float>& point) const noexcept;
+    SliceGeometry computeSliceGeometry() const noexcept;
+    void renderSliceImage (const SliceGeometry& geometry);
+    float updateVolumeGrid();
+    void renderVolumeImage();
+    void updateIsosurfaceMesh (float normaliser);
+    bool intersectRoomBounds (const juce::Vector3D<float>& origin, const juce::Vector3D<float>& direction,
+                              float& entry, float& exit) const noexcept;
     void updateTrails();
     void updateMaxReach (DisplaySpeaker& speaker) const;
     float distanceToRoomBoundary (const juce::Vector3D<float>& position, const juce::Vector3D<float>& direction) const;
@@ -189,7 +300,20 @@ private:
     float visualLevelForSpeaker (const DisplaySpeaker& speaker) const;
     juce::Colour colourForLevel (float level, float maxLevel) const;
     juce::Colour colourFromShares (float lowShare, float midShare, float highShare, float brightness) const;
+    juce::uint32 packedColourFromShares (float lowShare, float midShare, float highShare, float brightness) const noexcept;
+    juce::Colour computeColourFromShares (float lowShare, float midShare, float highShare, float brightness) const;
+    void rebuildColourLuts();
     juce::AffineTransform rotationTransform (juce::Point<float> centre, juce::Point<float> direction, float width, float height) const;
+    void buildShapeTemplates();
+    void drawProfilerOverlay (juce::Graphics& g);
+    void drawAnalysisTierBadge (juce::Graphics& g);
+    void drawPhantomLinks (juce::Graphics& g, const DrawOrder& order);
+    void drawEnergyVectors (juce::Graphics& g);
+    void refreshSpriteCaches (float pixelScale);
+    const MarkerSprite& markerSpriteFor (float diameter);
+    void layoutSpeakerLabels (const DrawOrder& order, const std::vector<float>& diameters);
+    juce::Path& acquireScratchPath();
+    void strokeTemplate (juce::Graphics& g, const juce::Path& shape, const juce::AffineTransform& transform, float thickness);
 
     juce::Colour colourForBands (const AtmosVizAudioProcessor::FrequencyBands& bands, bool isLfe) const;
 
@@ -238,9 +362,66 @@ private:
 
     static constexpr size_t trailHistoryLength = 32;
     std::vector<juce::Vector3D<float>> heatmapPoints;
+    std::array<int, 3> heatmapGridDims {};
     float cachedHeatmapMaxLevel = 0.0f;
     BandColourWeights bandColourWeights{};
+
+    static constexpr int heatmapRampSize = 1024;
+    static constexpr int bandShareSteps = 24;
+    static constexpr int bandBrightnessSteps = 24;
+    std::array<juce::uint32, heatmapRampSize> heatmapRampLut {};
+    std::array<juce::uint32, heatmapRampSize> sliceRampLut {};
+    std::vector<juce::uint32> bandShareLut;
     int heatmapDensityLevel = 2;
+    std::vector<FieldSource> fieldSources;
+
+    SlicePlane slicePlane { SlicePlane::EarHeight };
+    float sliceOffset = 0.0f;
+    juce::Image sliceImage;
+    std::vector<float> sliceLevels;
+    std::vector<float> sliceRowMaxima;
+    float cachedSliceMaxLevel = 0.0f;
+
+    std::vector<float> volumeLevels;
+    std::array<int, 3> volumeDims {};
+    juce::Image volumeImage;
+    float cachedVolumeMaxLevel = 0.0f;
+    int volumeQuality = 2;
+
+    juce::Path lobeTemplate;
+    juce::Path layeredLobeTemplate;
+    juce::Path balloonTemplate;
+    std::vector<LabelSprite> labelSprites;
+    std::vector<MarkerSprite> markerSprites;
+    float spritePixelScale = 0.0f;
+    std::vector<LabelPlacement> labelPlacements;
+    std::vector<juce::Point<float>> labelLayoutAnchors;
+    std::vector<int> labelLayoutDiameters;
+    std::vector<float> markerDiameters;
+
+    FrameArena frameArena;
+    FrameProfiler profiler;
+    bool profilerOverlayVisible = false;
+    AnalysisGovernor::Tier analysisTier = AnalysisGovernor::Tier::Full;
+    CorrelationMatrix::Values correlations {};
+    AtmosVizAudioProcessor::EnergyVectors energyVectors {};
+    AtmosVizAudioProcessor::MetricsHistoryRing::Frame historyFrame;
+    juce::int64 historyCursor = -1;   // next history frame to read; -1 until the first tick
+    MetricsFrameSource* replaySource = nullptr;
+    MetricsTimelineFrame replayFrame;
+    void applyReplayFrame();
+    void applyStoredFrame (const MetricsTimelineFrame& frame, const juce::StringArray& channelNames);
+    bool exporting = false;
+    bool phantomLinksVisible = true;
+    std::deque<juce::Path> scratchPathPool;
+    size_t scratchPathsInUse = 0;
+
+    std::vector<float> isoLevels;
+    std::vector<std::uint32_t> isoCellMasks;
+    std::vector<std::uint8_t> isoDirtyCells;
+    std::vector<IsoTriangle> isoMesh;
+    std::vector<std::pair<float, int>> isoDrawOrder;
+    std::unique_ptr<ParallelChunks> renderPool;
     float visualizationScale = 1.0f;
     float visualizationScaleSliderValue = 0.0f;
 
@@ -311,6 +492,201 @@ private:
     std::vector<Stop> stops;
 };
 
+class AudioDiagnosticsComponent : public juce::Component,
+                                  private juce::Timer
+{
+public:
+    explicit AudioDiagnosticsComponent (AtmosVizAudioProcessor& processorToWatch);
+
+    void paint (juce::Graphics& g) override;
+    void mouseDoubleClick (const juce::MouseEvent&) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    AtmosVizAudioProcessor& processor;
+    BlockTimingStats::Snapshot snapshot;
+    AnalysisGovernor::Tier analysisTier = AnalysisGovernor::Tier::Full;
+};
+
+class LoudnessPanelComponent : public juce::Component,
+                               private juce::Timer
+{
+public:
+    explicit LoudnessPanelComponent (AtmosVizAudioProcessor& processorToWatch);
+
+    void paint (juce::Graphics& g) override;
+    void mouseDoubleClick (const juce::MouseEvent&) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    AtmosVizAudioProcessor& processor;
+    LoudnessMeter::Snapshot snapshot;
+};
+
+class AlignmentPanelComponent : public juce::Component,
+                                private juce::Timer
+{
+public:
+    explicit AlignmentPanelComponent (AtmosVizAudioProcessor& processorToWatch);
+
+    void paint (juce::Graphics& g) override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+
+    AtmosVizAudioProcessor& processor;
+    std::array<DelayEstimator::Estimate, DelayEstimator::maxPairs> estimates {};
+    int numEstimates = 0;
+};
+
+class ReplayPanelComponent : public juce::Component,
+                             private juce::Timer
+{
+public:
+    ReplayPanelComponent (TimelinePlayer& playerToControl, SpeakerVisualizerComponent& visualizerToDrive);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+    /** h:mm:ss */
+    static juce::String formatTime (double seconds);
+
+private:
+    void timerCallback() override;
+    void openTimeline();
+    void updateControls();
+
+    TimelinePlayer& player;
+    SpeakerVisualizerComponent& visualizer;
+    juce::TextButton openButton { "Open..." };
+    juce::TextButton playButton { "Play" };
+    juce::ComboBox speedCombo;
+    juce::Slider positionSlider;
+    juce::Label timeLabel;
+    std::unique_ptr<juce::FileChooser> chooser;
+    bool lastOpenFailed = false;
+};
+
+// Standalone transport for playing a multichannel file: open, play/pause, loop and seek. A
+// strip under the position bar shows how much of the file the player has analysed so far.
+class FilePlayerPanelComponent : public juce::Component,
+                                 private juce::Timer
+{
+public:
+    FilePlayerPanelComponent (FilePlayer& playerToControl, SpeakerVisualizerComponent& visualizerToDrive);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+    /** Called when playback starts or stops, from the button or at the end of the file. */
+    std::function<void (bool)> onPlayingChanged;
+
+private:
+    void timerCallback() override;
+    void openFile();
+    void updateControls();
+
+    FilePlayer& player;
+    SpeakerVisualizerComponent& visualizer;
+    juce::TextButton openButton { "Open..." };
+    juce::TextButton playButton { "Play" };
+    juce::ToggleButton loopToggle { "Loop" };
+    juce::Slider positionSlider;
+    juce::Label timeLabel;
+    juce::Rectangle<int> cacheStrip;
+    std::unique_ptr<juce::FileChooser> chooser;
+    bool lastOpenFailed = false;
+    bool wasPlaying = false;
+};
+
+// Renders the view as it is set up on screen to PNG frames and/or a raw RGBA stream, from a
+// recorded timeline or an audio file, at a chosen size and frame rate. The export carries on
+// in the background while the panel is hidden.
+class ExportPanelComponent : public juce::Component,
+                             private juce::Timer
+{
+public:
+    ExportPanelComponent (AtmosVizAudioProcessor& processorToUse, SpeakerVisualizerComponent& viewToExport);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    void timerCallback() override;
+    void chooseSource();
+    void chooseOutputAndStart();
+    void updateControls();
+
+    AtmosVizAudioProcessor& processor;
+    SpeakerVisualizerComponent& visualizer;
+    FrameExporter exporter;
+    juce::File sourceFile;
+    juce::TextButton sourceButton { "Source..." };
+    juce::ComboBox sizeCombo;
+    juce::ComboBox frameRateCombo;
+    juce::ToggleButton pngToggle { "PNG" };
+    juce::ToggleButton rawToggle { "RGBA" };
+    juce::TextButton exportButton { "Export..." };
+    juce::Label statusLabel;
+    std::unique_ptr<juce::FileChooser> chooser;
+    bool wasRunning = false;
+    bool showingResult = false;   // the last export's outcome, until another source is chosen
+};
+
+// Channels x time raster of RMS activity since the editor opened. Metrics are folded into
+// 10 ms frames and kept in an ActivityPyramid, so any zoom from single frames to the whole
+// session draws in time proportional to the columns. While following the live edge the
+// raster is scrolled in place and only the new columns are rendered.
+class ActivityTimelineComponent : public juce::Component,
+                                  private juce::Timer
+{
+public:
+    static constexpr double frameSeconds = 0.01;
+    static constexpr int pyramidDepth = 7;   // 4096 cells per level: ~41 s of single frames, ~46 h in total
+
+    explicit ActivityTimelineComponent (AtmosVizAudioProcessor& processorToWatch);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+    void mouseDown (const juce::MouseEvent& event) override;
+    void mouseDrag (const juce::MouseEvent& event) override;
+    void mouseDoubleClick (const juce::MouseEvent& event) override;
+    void mouseWheelMove (const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+
+private:
+    void timerCallback() override;
+    void collectFrames();
+    void updateRaster();
+    void renderColumns (int firstColumn, int numColumns);
+    juce::Rectangle<int> getRasterArea() const;
+    juce::int64 getLiveEndColumn() const noexcept;
+
+    AtmosVizAudioProcessor& processor;
+    std::unique_ptr<ActivityPyramid> pyramid;
+    AtmosVizAudioProcessor::MetricsHistoryRing::Frame historyFrame;
+    juce::int64 historyCursor = -1;
+    std::array<double, AtmosVizAudioProcessor::MetricsHistoryRing::maxChannels> powerSums {};
+    double pendingSamples = 0.0;
+    std::array<float, AtmosVizAudioProcessor::MetricsHistoryRing::maxChannels> frameValues {};
+    std::vector<ActivityPyramid::Cell> columnCells;
+
+    juce::Image raster;
+    bool rasterDirty = true;
+    juce::int64 framesPerColumn = 1;
+    juce::int64 viewEndColumn = 0;     // one past the rightmost column, in units of framesPerColumn
+    juce::int64 rasterEndColumn = 0;   // what the raster currently shows
+    bool followLive = true;
+    juce::int64 dragStartEndColumn = 0;
+};
+
 class AtmosVizAudioProcessorEditor  : public juce::AudioProcessorEditor,
                                       private juce::Slider::Listener,
                                       private juce::ComponentListener
@@ -328,15 +704,28 @@ private:
     void setupSliderModeSelector();
     void setupVisualizationSelector();
     void setupHeatmapDensitySlider();
+    void setupSliceControls();
     void setupBandWeightControls();
     void setupColourLegend();
     void setupVisualizationGainSlider();
+    void setupProfilerToggle();
+    void setupDiagnosticsPanel();
+    void setupLoudnessPanel();
+    void setupPhantomLinksToggle();
+    void setupAlignmentPanel();
+    void setupTimelineRecordToggle();
+    void setupReplayPanel();
+    void setupFilePlayer();
+    void updateRecordToggleForFilePlayer();
+    void setupExportPanel();
+    void setupActivityTimeline();
     void setCameraPreset (SpeakerVisualizerComponent::CameraPreset preset);
     void updateCameraButtonStates();
     void updateVisualizationSelector();
     void updateSliderConfiguration();
     void updateVisualizationControlsVisibility();
     void updateHeatmapDensityValueLabel();
+    void updateSliceOffsetRange();
     void updateVisualizationGainValueLabel();
     void updateLegendContent();
 
@@ -368,6 +757,9 @@ private:
     juce::Slider heatmapDensitySlider;
     juce::Label heatmapDensityLabel;
     juce::Label heatmapDensityValueLabel;
+    juce::ComboBox slicePlaneCombo;
+    juce::Label sliceOffsetLabel;
+    juce::Slider sliceOffsetSlider;
     juce::Label bandWeightTitleLabel;
     juce::Label visualizationGainLabel;
     juce::Slider lowWeightSlider;
@@ -379,6 +771,25 @@ private:
     juce::TextButton colourPadButton;
     juce::Slider visualizationGainSlider;
     juce::Label visualizationGainValueLabel;
+    juce::ToggleButton profilerToggle;
+    juce::ToggleButton diagnosticsToggle;
+    std::unique_ptr<AudioDiagnosticsComponent> diagnosticsPanel;
+    juce::ToggleButton loudnessToggle;
+    juce::ToggleButton phantomLinksToggle;
+    juce::ToggleButton alignmentToggle;
+    std::unique_ptr<AlignmentPanelComponent> alignmentPanel;
+    juce::ToggleButton recordToggle;
+    std::unique_ptr<juce::FileChooser> timelineChooser;
+    juce::ToggleButton replayToggle;
+    TimelinePlayer timelinePlayer;
+    std::unique_ptr<ReplayPanelComponent> replayPanel;
+    juce::ToggleButton filePlayerToggle;
+    std::unique_ptr<FilePlayerPanelComponent> filePlayerPanel;
+    juce::ToggleButton exportToggle;
+    std::unique_ptr<ExportPanelComponent> exportPanel;
+    juce::ToggleButton activityToggle;
+    std::unique_ptr<ActivityTimelineComponent> activityTimeline;
+    std::unique_ptr<LoudnessPanelComponent> loudnessPanel;
     std::vector<juce::Rectangle<int>> sectionDividers;
     juce::Slider zoomSlider;
     juce::ComboBox sliderModeCombo;
@@ -1,92 +1,12 @@
 #include <cmath>
 #include <algorithm>
 #include <array>
+#include <limits>
 #include <utility>
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-namespace
-{
-    constexpr float degToRad(float degrees) noexcept
-    {
-        return degrees * juce::MathConstants<float>::pi / 180.0f;
-    }
-
-    juce::Vector3D<float> unitVectorFromAngles(float azimuthDeg, float elevationDeg) noexcept
-    {
-        const auto azimuth = degToRad(azimuthDeg);
-        const auto elevation = degToRad(elevationDeg);
-        const auto cosElevation = std::cos(elevation);
-
-        return {
-            cosElevation * std::cos(azimuth),
-            std::sin(elevation),
-            cosElevation * std::sin(azimuth)
-        };
-    }
-
-    juce::Vector3D<float> mapUnitToRoom(const juce::Vector3D<float>& unit,
-        const AtmosVizAudioProcessor::RoomDimensions& room,
-        bool isLfe) noexcept
-    {
-        if (isLfe)
-            return { room.depth * 0.48f, -room.earHeight * 0.85f, 0.0f };
-
-        const auto depthHalf = room.depth * 0.5f;
-        const auto widthHalf = room.width * 0.5f;
-        const auto ceiling = room.height - room.earHeight;
-        const auto floor = room.earHeight;
-
-        const auto x = juce::jlimit(-depthHalf, depthHalf, unit.x * depthHalf);
-        const auto z = juce::jlimit(-widthHalf, widthHalf, unit.z * widthHalf);
-        const auto y = unit.y >= 0.0f
-            ? juce::jlimit(0.0f, ceiling, unit.y * ceiling)
-            : juce::jlimit(-floor, 0.0f, unit.y * floor);
-
-        return { x, y, z };
-    }    struct SpeakerSeed
-    {
-        juce::AudioChannelSet::ChannelType type;
-        const char* id;
-        const char* displayName;
-        float azimuthDegrees;
-        float elevationDegrees;
-        bool isLfe;
-    };
-
-        static constexpr SpeakerSeed speakerSeedTable[] =
-    {
-        { juce::AudioChannelSet::left,             "L",   "Left",             -30.0f,  0.0f, false },
-        { juce::AudioChannelSet::right,            "R",   "Right",             30.0f,  0.0f, false },
-        { juce::AudioChannelSet::centre,           "C",   "Centre",             0.0f,  0.0f, false },
-        { juce::AudioChannelSet::leftCentre,       "Lc",  "Left Centre",      -15.0f,  0.0f, false },
-        { juce::AudioChannelSet::rightCentre,      "Rc",  "Right Centre",      15.0f,  0.0f, false },
-        { juce::AudioChannelSet::surround,         "S",   "Surround",         180.0f,  0.0f, false },
-        { juce::AudioChannelSet::centreSurround,   "Cs",  "Centre Surround",  180.0f,  0.0f, false },
-        { juce::AudioChannelSet::LFE,              "LFE", "LFE",                0.0f, -30.0f, true  },
-        { juce::AudioChannelSet::leftSurround,     "Ls",  "Surround L",      -100.0f,  0.0f, false },
-        { juce::AudioChannelSet::rightSurround,    "Rs",  "Surround R",       100.0f,  0.0f, false },
-        { juce::AudioChannelSet::leftSurroundSide, "Lss", "Side Surround L",  -110.0f,  0.0f, false },
-        { juce::AudioChannelSet::rightSurroundSide,"Rss", "Side Surround R",   110.0f,  0.0f, false },
-        { juce::AudioChannelSet::leftSurroundRear, "Lrs", "Rear Surround L", -150.0f,  0.0f, false },
-        { juce::AudioChannelSet::rightSurroundRear,"Rrs", "Rear Surround R",  150.0f,  0.0f, false },
-        { juce::AudioChannelSet::wideLeft,         "Lw",  "Wide Left",        -55.0f,  0.0f, false },
-        { juce::AudioChannelSet::wideRight,        "Rw",  "Wide Right",        55.0f,  0.0f, false },
-        { juce::AudioChannelSet::topFrontLeft,     "Ltf", "Top Front L",      -45.0f, 50.0f, false },
-        { juce::AudioChannelSet::topFrontRight,    "Rtf", "Top Front R",       45.0f, 50.0f, false },
-        { juce::AudioChannelSet::topFrontCentre,   "Tfc", "Top Front C",        0.0f, 55.0f, false },
-        { juce::AudioChannelSet::topSideLeft,      "Lts", "Top Side L",       -90.0f, 65.0f, false },
-        { juce::AudioChannelSet::topSideRight,     "Rts", "Top Side R",        90.0f, 65.0f, false },
-        { juce::AudioChannelSet::topRearLeft,      "Ltr", "Top Rear L",      -135.0f, 50.0f, false },
-        { juce::AudioChannelSet::topRearRight,     "Rtr", "Top Rear R",       135.0f, 50.0f, false },
-        { juce::AudioChannelSet::topRearCentre,    "Trc", "Top Rear C",       180.0f, 55.0f, false }
-    };
-
-
-}
-
-const AtmosVizAudioProcessor::RoomDimensions AtmosVizAudioProcessor::defaultRoom{ 6.4f, 3.05f, 7.6f, 1.2f };
 AtmosVizAudioProcessor::AtmosVizAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
     : AudioProcessor(BusesProperties()
@@ -94,7 +14,6 @@ AtmosVizAudioProcessor::AtmosVizAudioProcessor()
         .withOutput("Atmos Output", juce::AudioChannelSet::create7point1point4(), true))
 #endif
 {
-    fftBuffer.allocate(2 * fftSize, true);
     rebuildSpeakerLayout();
 }
 
@@ -111,15 +30,26 @@ void AtmosVizAudioProcessor::setCurrentProgram(int) {}
 const juce::String AtmosVizAudioProcessor::getProgramName(int) { return {}; }
 void AtmosVizAudioProcessor::changeProgramName(int, const juce::String&) {}
 
-void AtmosVizAudioProcessor::prepareToPlay(double sampleRate, int)
+void AtmosVizAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
-    updateBandSplit();
-    rebuildSpeakerLayout();
-    juce::FloatVectorOperations::clear(fftBuffer.get(), 2 * fftSize);
+    analysisGovernor.reset();
+    filePlayer.prepareToPlay (sampleRate, samplesPerBlock);
+
+    {
+        const juce::SpinLock::ScopedLockType lock (metricsLock);
+        engine.prepare (sampleRate, getBusesLayout().getMainInputChannelSet());
+        latestMetrics.assign (engine.getSpeakerDefinitions().size(), {});
+    }
+
+    const juce::SpinLock::ScopedLockType lock (ballisticsLock);
+    engine.setMeterBallistics (meterBallistics);
 }
 
-void AtmosVizAudioProcessor::releaseResources() {}
+void AtmosVizAudioProcessor::releaseResources()
+{
+    engine.release();
+}
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool AtmosVizAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
@@ -189,46 +119,57 @@ void AtmosVizAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
     juce::ignoreUnused(midiMessages);
 
     const auto numSamples = buffer.getNumSamples();
-    const auto numChannels = buffer.getNumChannels();
+    const BlockTimingStats::ScopedBlockTimer blockTimer (blockTimingStats, numSamples, currentSampleRate);
 
-    const auto& layout = getBusesLayout().getMainInputChannelSet();
+    // A file playing in the standalone app was analysed ahead of the playhead by the player,
+    // and the view reads its cache; this block only carries the audio. The history and the
+    // timeline recorder follow the live input, so they wait while it plays; a paused file
+    // leaves the live input to be analysed as usual.
+    if (filePlayer.renderNextBlock (buffer, getChannelLayoutOfBus (false, 0)))
+        return;
+
+    const auto blockStart = engine.getSamplesProcessed();
 
-    if (speakerDefinitions.size() != static_cast<size_t> (layout.size()))
+    if (engine.getSpeakerDefinitions().size() != static_cast<size_t> (getBusesLayout().getMainInputChannelSet().size()))
         rebuildSpeakerLayout();
 
-    SpeakerMetricsArray metrics;
-    metrics.resize(speakerDefinitions.size());
+    applyPendingMeterChanges();
+
+    const auto offline = isNonRealtime();
 
-    if (metrics.empty())
+    if (offline != wasRenderingOffline)
     {
-        const juce::SpinLock::ScopedLockType lock (metricsLock);
-        latestMetrics.clear();
-        return;
+        analysisGovernor.reset();
+        wasRenderingOffline = offline;
     }
 
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        const auto channelType = layout.getTypeOfChannel (ch);
-        const auto defIndex = findDefinitionIndexForChannel (channelType);
-        if (defIndex < 0 || static_cast<size_t> (defIndex) >= metrics.size())
-            continue;
+    // The governor sees the previous block's load, so it reacts one block late but never
+    // has to time itself. Offline renders have no deadline and bypass it.
+    const auto tier = offline ? AnalysisGovernor::Tier::Full
+                              : analysisGovernor.update (blockTimingStats.getLastLoad(), numSamples / currentSampleRate);
 
-        const auto* channelData = buffer.getReadPointer (ch);
+    engine.process (buffer, offline, tier, blockResult);
+    const auto& metrics = blockResult.metrics;
 
-        auto& entry = metrics[(size_t) defIndex];
-        entry.rms = computeRms (channelData, numSamples);
-        entry.peak = computePeak (channelData, numSamples);
-        entry.bands = analyseFrequencyContent (channelData, numSamples);
+    if (! metrics.empty())
+    {
+        publishHistoryFrame (metrics, blockStart, numSamples);
 
-        if (speakerDefinitions[(size_t) defIndex].isLfe)
-        {
-            entry.bands.mid = 0.0f;
-            entry.bands.high = 0.0f;
-        }
+        if (timelineRecorder.isRecording())
+            recordTimelineBlock (metrics, numSamples);
     }
 
+    const auto waitStart = juce::Time::getHighResolutionTicks();
     const juce::SpinLock::ScopedLockType lock (metricsLock);
+    blockTimingStats.recordLockWait (juce::Time::getHighResolutionTicks() - waitStart);
     latestMetrics = metrics;
+    latestCorrelations = blockResult.correlations;
+    latestEnergyVectors = blockResult.energyVectors;
+}
+
+bool AtmosVizAudioProcessor::popOnsetEvent (OnsetEvent& event) noexcept
+{
+    return engine.popOnsetEvent (event);
 }
 
 bool AtmosVizAudioProcessor::hasEditor() const { return true; }
@@ -242,7 +183,7 @@ void AtmosVizAudioProcessor::setStateInformation(const void*, int) {}
 
 const AtmosVizAudioProcessor::SpeakerDefinitions& AtmosVizAudioProcessor::getSpeakerDefinitions() const noexcept
 {
-    return speakerDefinitions;
+    return engine.getSpeakerDefinitions();
 }
 
 void AtmosVizAudioProcessor::copyLatestMetrics(SpeakerMetricsArray& dest) const noexcept
@@ -256,152 +197,138 @@ const AtmosVizAudioProcessor::RoomDimensions& AtmosVizAudioProcessor::getRoomDim
     return roomDimensions;
 }
 
-void AtmosVizAudioProcessor::updateBandSplit()
+BlockTimingStats::Snapshot AtmosVizAudioProcessor::getBlockTimingSnapshot() const noexcept
 {
-    const auto hzPerBin = (float)currentSampleRate / (float)fftSize;
-    lowBandLimit = juce::jlimit(1, fftSize / 2, (int)std::ceil(200.0f / hzPerBin));
-    midBandLimit = juce::jlimit(lowBandLimit + 1, fftSize / 2, (int)std::ceil(2000.0f / hzPerBin));
+    return blockTimingStats.getSnapshot();
 }
 
-float AtmosVizAudioProcessor::computeRms(const float* data, int numSamples) const noexcept
+void AtmosVizAudioProcessor::resetBlockTimingStats() noexcept
 {
-    if (numSamples <= 0)
-        return 0.0f;
-
-    double sumSquares = 0.0;
-    for (int i = 0; i < numSamples; ++i)
-        sumSquares += (double)data[i] * (double)data[i];
-
-    return (float)std::sqrt(sumSquares / numSamples);
+    blockTimingStats.requestReset();
 }
 
-float AtmosVizAudioProcessor::computePeak(const float* data, int numSamples) const noexcept
+AnalysisGovernor::Tier AtmosVizAudioProcessor::getAnalysisTier() const noexcept
 {
-    float peak = 0.0f;
-    for (int i = 0; i < numSamples; ++i)
-        peak = std::max(peak, std::abs(data[i]));
-    return peak;
+    return analysisGovernor.getTier();
 }
 
-AtmosVizAudioProcessor::FrequencyBands AtmosVizAudioProcessor::analyseFrequencyContent(const float* data, int
-    numSamples) noexcept
+void AtmosVizAudioProcessor::setMeterBallistics (const MeterBallistics& newBallistics)
 {
-    FrequencyBands bands;
-    auto* fftData = fftBuffer.get();
+    const juce::SpinLock::ScopedLockType lock (ballisticsLock);
+    meterBallistics = newBallistics;
+    ballisticsChanged.store (true, std::memory_order_release);
+}
 
-    const auto copyCount = std::min(fftSize, numSamples);
-    juce::FloatVectorOperations::copy(fftData, data, copyCount);
-    if (copyCount < fftSize)
-        juce::FloatVectorOperations::clear(fftData + copyCount, fftSize - copyCount);
-    juce::FloatVectorOperations::clear(fftData + fftSize, fftSize);
+MeterBallistics AtmosVizAudioProcessor::getMeterBallistics() const
+{
+    const juce::SpinLock::ScopedLockType lock (ballisticsLock);
+    return meterBallistics;
+}
 
-    window.multiplyWithWindowingTable(fftData, fftSize);
-    fft.performFrequencyOnlyForwardTransform(fftData);
+void AtmosVizAudioProcessor::resetMeterCounters() noexcept
+{
+    meterCountersResetRequested.store (true, std::memory_order_release);
+}
 
-    const auto nyquist = fftSize / 2;
-    for (int bin = 1; bin < nyquist; ++bin)
-    {
-        const auto magnitude = fftData[bin];
+void AtmosVizAudioProcessor::copyLatestCorrelations (CorrelationMatrix::Values& dest) const noexcept
+{
+    const juce::SpinLock::ScopedLockType lock (metricsLock);
+    dest = latestCorrelations;
+}
 
-        if (bin < lowBandLimit)      bands.low += magnitude;
-        else if (bin < midBandLimit) bands.mid += magnitude;
-        else                         bands.high += magnitude;
-    }
+const DelayEstimator& AtmosVizAudioProcessor::getDelayEstimator() const noexcept
+{
+    return engine.getDelayEstimator();
+}
 
-    const auto lowNorm = std::max(1, lowBandLimit - 1);
-    const auto midNorm = std::max(1, midBandLimit - lowBandLimit);
-    const auto highNorm = std::max(1, nyquist - midBandLimit);
+void AtmosVizAudioProcessor::copyLatestEnergyVectors (EnergyVectors& dest) const noexcept
+{
+    const juce::SpinLock::ScopedLockType lock (metricsLock);
+    dest = latestEnergyVectors;
+}
 
-    bands.low /= (float)lowNorm;
-    bands.mid /= (float)midNorm;
-    bands.high /= (float)highNorm;
+LoudnessMeter::Snapshot AtmosVizAudioProcessor::getLoudnessSnapshot() const noexcept
+{
+    return engine.getLoudnessMeter().getSnapshot();
+}
 
-    return bands;
+void AtmosVizAudioProcessor::resetIntegratedLoudness() noexcept
+{
+    engine.getLoudnessMeter().requestReset();
 }
 
-AtmosVizAudioProcessor::SpeakerDefinitions AtmosVizAudioProcessor::buildSpeakerDefinitions (const juce::AudioChannelSet& layout) const
+void AtmosVizAudioProcessor::publishHistoryFrame (const SpeakerMetricsArray& metrics, juce::int64 blockStart, int numSamples) noexcept
 {
-    SpeakerDefinitions defs;
-    defs.reserve (layout.size());
+    historyFrame.hostSamplePosition = -1;
 
-    auto findSeed = [] (juce::AudioChannelSet::ChannelType type) -> const SpeakerSeed*
-    {
-        for (const auto& seed : speakerSeedTable)
-        {
-            if (seed.type == type)
-                return &seed;
-        }
+    if (auto* playHead = getPlayHead())
+        if (const auto position = playHead->getPosition())
+            if (const auto timeInSamples = position->getTimeInSamples())
+                historyFrame.hostSamplePosition = *timeInSamples;
 
-        return nullptr;
-    };
+    historyFrame.samplePosition = blockStart;
+    historyFrame.timestampMs = juce::Time::getMillisecondCounterHiRes();
+    historyFrame.numSamples = numSamples;
+    historyFrame.numChannels = juce::jmin ((int) metrics.size(), MetricsHistoryRing::maxChannels);
+    std::copy (metrics.begin(), metrics.begin() + historyFrame.numChannels, historyFrame.channels.begin());
+
+    metricsHistory.push (historyFrame);
+}
+
+void AtmosVizAudioProcessor::recordTimelineBlock (const SpeakerMetricsArray& metrics, int numSamples) noexcept
+{
+    const auto loudness = engine.getLoudnessMeter().getSnapshot();
 
-    juce::StringArray usedIds;
+    timelineBlock.hostSamplePosition = historyFrame.hostSamplePosition;
+    timelineBlock.momentaryLufs = loudness.momentaryLufs;
+    timelineBlock.shortTermLufs = loudness.shortTermLufs;
+    timelineBlock.numChannels = juce::jmin ((int) metrics.size(), MetricsTimelineFrame::maxChannels);
 
-    for (int channelIndex = 0; channelIndex < layout.size(); ++channelIndex)
+    for (int ch = 0; ch < timelineBlock.numChannels; ++ch)
     {
-        const auto channelType = layout.getTypeOfChannel (channelIndex);
-        const auto* seed = findSeed (channelType);
-
-        float azimuth = seed != nullptr ? seed->azimuthDegrees : 0.0f;
-        float elevation = seed != nullptr ? seed->elevationDegrees : 0.0f;
-        const bool isLfe = seed != nullptr ? seed->isLfe : (channelType == juce::AudioChannelSet::LFE);
-
-        const auto unit = unitVectorFromAngles (azimuth, elevation);
-        const auto position = mapUnitToRoom (unit, defaultRoom, isLfe);
-
-        auto aim = -position;
-        const auto aimLength = aim.length();
-        if (aimLength > 1.0e-4f)
-            aim /= aimLength;
-        else
-            aim = { -1.0f, 0.0f, 0.0f };
-
-        juce::String id = seed != nullptr ? seed->id : juce::AudioChannelSet::getAbbreviatedChannelTypeName (channelType);
-        if (id.isEmpty())
-            id = juce::String (channelIndex + 1);
-
-        if (usedIds.contains (id))
-            id += '_' + juce::String (channelIndex + 1);
-        usedIds.add (id);
-        juce::String displayName = seed != nullptr ? seed->displayName : juce::AudioChannelSet::getChannelTypeName (channelType);
-
-        defs.push_back ({
-            id,
-            displayName,
-            azimuth,
-            elevation,
-            position.length(),
-            isLfe,
-            position,
-            aim,
-            channelType
-        });
+        const auto& source = metrics[(size_t) ch];
+        timelineBlock.channels[(size_t) ch] = { source.rms, source.peak, source.bands.low, source.bands.mid, source.bands.high };
     }
 
-    return defs;
+    timelineRecorder.addBlock (timelineBlock, numSamples);
 }
 
-void AtmosVizAudioProcessor::rebuildSpeakerLayout()
+bool AtmosVizAudioProcessor::startTimelineRecording (const juce::File& file)
 {
-    auto layout = getBusesLayout().getMainInputChannelSet();
-    auto defs = buildSpeakerDefinitions (layout);
+    juce::StringArray channelNames;
+    for (const auto& def : engine.getSpeakerDefinitions())
+        channelNames.add (def.displayName);
 
-    if (defs.empty())
-        defs = buildSpeakerDefinitions (juce::AudioChannelSet::create7point1point4());
+    return timelineRecorder.start (file, currentSampleRate, channelNames);
+}
 
-    const juce::SpinLock::ScopedLockType lock (metricsLock);
-    speakerDefinitions = std::move (defs);
-    latestMetrics.assign (speakerDefinitions.size(), {});
+void AtmosVizAudioProcessor::stopTimelineRecording()
+{
+    timelineRecorder.stop();
 }
-int AtmosVizAudioProcessor::findDefinitionIndexForChannel(juce::AudioChannelSet::ChannelType type) const noexcept
+
+void AtmosVizAudioProcessor::applyPendingMeterChanges() noexcept
 {
-    for (size_t i = 0; i < speakerDefinitions.size(); ++i)
+    if (ballisticsChanged.load (std::memory_order_acquire))
     {
-        if (speakerDefinitions[i].channelType == type)
-            return static_cast<int>(i);
+        const juce::SpinLock::ScopedTryLockType lock (ballisticsLock);
+
+        if (lock.isLocked())
+        {
+            engine.setMeterBallistics (meterBallistics);
+            ballisticsChanged.store (false, std::memory_order_relaxed);
+        }
     }
 
-    return -1;
+    if (meterCountersResetRequested.exchange (false, std::memory_order_acquire))
+        engine.resetMeterCounters();
+}
+
+void AtmosVizAudioProcessor::rebuildSpeakerLayout()
+{
+    const juce::SpinLock::ScopedLockType lock (metricsLock);
+    engine.setLayout (getBusesLayout().getMainInputChannelSet());
+    latestMetrics.assign (engine.getSpeakerDefinitions().size(), {});
 }
 
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -1,51 +1,33 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
+#include "AnalysisEngine.h"
+#include "BlockTimingStats.h"
+#include "FilePlayer.h"
+#include "MetricsHistory.h"
+#include "MetricsTimeline.h"
+
 class AtmosVizAudioProcessor : public juce::AudioProcessor
 {
 public:
-    static constexpr int fftOrder = 9;
-    static constexpr int fftSize = 1 << fftOrder;
-
-    struct FrequencyBands
-    {
-        float low{ 0.0f };
-        float mid{ 0.0f };
-        float high{ 0.0f };
-    };
-
-    struct SpeakerDefinition
-    {
-        juce::String id;
-        juce::String displayName;
-        float azimuthDegrees;
-        float elevationDegrees;
-        float radius;
-        bool isLfe;
-        juce::Vector3D<float> position;
-        juce::Vector3D<float> aimDirection;
-        juce::AudioChannelSet::ChannelType channelType{};
-    };
-
-    struct SpeakerMetrics
-    {
-        float rms{ 0.0f };
-        float peak{ 0.0f };
-        FrequencyBands bands{};
-    };
-
-    struct RoomDimensions
-    {
-        float width;
-        float height;
-        float depth;
-        float earHeight;
-    };
-
-    using SpeakerDefinitions = std::vector<SpeakerDefinition>;
-    using SpeakerMetricsArray = std::vector<SpeakerMetrics>;
+    using FrequencyBands = AnalysisEngine::FrequencyBands;
+    using SpeakerDefinition = AnalysisEngine::SpeakerDefinition;
+    using SpeakerMetrics = AnalysisEngine::SpeakerMetrics;
+    using EnergyVector = AnalysisEngine::EnergyVector;
+    using EnergyVectors = AnalysisEngine::EnergyVectors;
+    using RoomDimensions = AnalysisEngine::RoomDimensions;
+    using SpeakerDefinitions = AnalysisEngine::SpeakerDefinitions;
+    using SpeakerMetricsArray = AnalysisEngine::SpeakerMetricsArray;
+
+    // Every block's metrics, kept for the last few seconds (2048 blocks: about 5 s at 128
+    // samples and 48 kHz, longer with larger blocks).
+    using MetricsHistoryRing = MetricsHistory<SpeakerMetrics>;
+    static constexpr int metricsHistoryCapacity = 2048;
 
     AtmosVizAudioProcessor();
     ~AtmosVizAudioProcessor() override;
@@ -80,32 +62,67 @@ public:
 
     const SpeakerDefinitions& getSpeakerDefinitions() const noexcept;
     void copyLatestMetrics(SpeakerMetricsArray& dest) const noexcept;
+    const MetricsHistoryRing& getMetricsHistory() const noexcept { return metricsHistory; }
+    void copyLatestCorrelations (CorrelationMatrix::Values& dest) const noexcept;
+    const DelayEstimator& getDelayEstimator() const noexcept;
+    void copyLatestEnergyVectors (EnergyVectors& dest) const noexcept;
+
+    /** Message thread: records the metrics stream of every speaker to file until stopped. */
+    bool startTimelineRecording (const juce::File& file);
+    void stopTimelineRecording();
+    bool isTimelineRecording() const noexcept { return timelineRecorder.isRecording(); }
+    juce::File getTimelineFile() const { return timelineRecorder.getFile(); }
+
+    /** The standalone app's file transport. While it has a file open, blocks carry the file's
+        audio instead of the input and are not analysed live. */
+    FilePlayer& getFilePlayer() noexcept { return filePlayer; }
+
+    /** Message thread, single consumer: takes the oldest queued onset, if any. */
+    bool popOnsetEvent (OnsetEvent& event) noexcept;
     const RoomDimensions& getRoomDimensions() const noexcept;
 
+    BlockTimingStats::Snapshot getBlockTimingSnapshot() const noexcept;
+    void resetBlockTimingStats() noexcept;
+    AnalysisGovernor::Tier getAnalysisTier() const noexcept;
+
+    void setMeterBallistics (const MeterBallistics& newBallistics);
+    MeterBallistics getMeterBallistics() const;
+    void resetMeterCounters() noexcept;
+
+    LoudnessMeter::Snapshot getLoudnessSnapshot() const noexcept;
+    void resetIntegratedLoudness() noexcept;
+
 private:
-    void updateBandSplit();
-    float computeRms(const float* data, int numSamples) const noexcept;
-    float computePeak(const float* data, int numSamples) const noexcept;
-    FrequencyBands analyseFrequencyContent(const float* data, int numSamples) noexcept;
-    SpeakerDefinitions buildSpeakerDefinitions (const juce::AudioChannelSet& layout) const;
+    void applyPendingMeterChanges() noexcept;
+    void publishHistoryFrame (const SpeakerMetricsArray& metrics, juce::int64 blockStart, int numSamples) noexcept;
+    void recordTimelineBlock (const SpeakerMetricsArray& metrics, int numSamples) noexcept;
     void rebuildSpeakerLayout();
-    int findDefinitionIndexForChannel(juce::AudioChannelSet::ChannelType type) const noexcept;
 
-    static const RoomDimensions defaultRoom;
-
-    SpeakerDefinitions speakerDefinitions;
+    AnalysisEngine engine;
+    AnalysisEngine::BlockResult blockResult;
     SpeakerMetricsArray latestMetrics;
+    MetricsHistoryRing metricsHistory{ metricsHistoryCapacity };
+    MetricsHistoryRing::Frame historyFrame;
+    MetricsTimelineRecorder timelineRecorder;
+    MetricsTimelineFrame timelineBlock;
+    FilePlayer filePlayer;
     mutable juce::SpinLock metricsLock;
-
-    juce::HeapBlock<float> fftBuffer;
-    juce::dsp::FFT fft{ fftOrder };
-    juce::dsp::WindowingFunction<float> window{ fftSize, juce::dsp::WindowingFunction<float>::hann };
+    BlockTimingStats blockTimingStats;
+    AnalysisGovernor analysisGovernor;
+    CorrelationMatrix::Values latestCorrelations {};
+    EnergyVectors latestEnergyVectors{};
+    bool wasRenderingOffline = false;
 
     double currentSampleRate = 48000.0;
-    int lowBandLimit = 8;
-    int midBandLimit = fftSize / 4;
 
-    RoomDimensions roomDimensions = defaultRoom;
+    // Ballistics are edited on the message thread and picked up by the audio thread at the
+    // start of a block, only if it can take the lock without waiting.
+    MeterBallistics meterBallistics;
+    mutable juce::SpinLock ballisticsLock;
+    std::atomic<bool> ballisticsChanged{ false };
+    std::atomic<bool> meterCountersResetRequested{ false };
+
+    RoomDimensions roomDimensions = AnalysisEngine::defaultRoom;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AtmosVizAudioProcessor)
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+// Speaker positions and directions. juce::Vector3D lives in juce_opengl, so builds that link
+// no GUI modules (the batch analyser) get a stand-in with the part of its interface the
+// analysis code uses; the plugin keeps the real type the editor works with.
+#if JUCE_MODULE_AVAILABLE_juce_opengl
+using SpatialVector = juce::Vector3D<float>;
+#else
+struct SpatialVector
+{
+    constexpr SpatialVector() noexcept = default;
+    constexpr SpatialVector (float xValue, float yValue, float zValue) noexcept : x (xValue), y (yValue), z (zValue) {}
+
+    constexpr SpatialVector operator-() const noexcept              { return { -x, -y, -z }; }
+    constexpr SpatialVector operator/ (float divisor) const noexcept { return { x / divisor, y / divisor, z / divisor }; }
+    SpatialVector& operator/= (float divisor) noexcept               { x /= divisor; y /= divisor; z /= divisor; return *this; }
+    float length() const noexcept                                    { return std::sqrt (x * x + y * y + z * z); }
+
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Per-frame descriptors derived from the band analysis magnitudes in the same pass.
+struct SpectralFeatures
+{
+    float centroidHz = 0.0f;
+    float flatness = 0.0f;      // geometric / arithmetic mean power: 0 tonal, 1 noise
+    float rolloffHz = 0.0f;     // 85% of the frame's energy lies below
+    float flux = 0.0f;          // positive magnitude change since the previous frame, relative to this frame (0-1)
+};
+
+// Magnitudes of a channel's previous frame, for the flux. Frames of a different transform
+// size are not comparable, so a size change restarts it.
+struct SpectralHistory
+{
+    std::vector<float> magnitudes;
+    int order = 0;
+};
+
+struct OnsetEvent
+{
+    int channel = 0;                    // speaker definition index
+    juce::int64 samplePosition = 0;     // processor sample clock, counted from prepareToPlay
+    float strength = 0.0f;              // 0-1
+};
+
+// Flags frames whose flux rises above an adaptive threshold: a running mean plus a multiple
+// of the running mean deviation, both exponentially weighted in time so the behaviour does
+// not depend on the analysis hop. A refractory period stops one attack firing repeatedly.
+class OnsetDetector
+{
+public:
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        refractorySamples = (juce::int64) (refractorySeconds * sampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        mean = 0.0f;
+        deviation = 0.0f;
+        lastFrame = -1;
+        lastOnset = std::numeric_limits<juce::int64>::min() / 2;
+    }
+
+    /** Returns the onset strength (0-1) when the frame starting at frameSample is an onset, else 0. */
+    float process (float flux, juce::int64 frameSample) noexcept
+    {
+        const auto threshold = mean + sensitivity * deviation + minimumFlux;
+        const auto isOnset = lastFrame >= 0
+                          && flux > threshold
+                          && frameSample - lastOnset >= refractorySamples;
+
+        const auto elapsed = lastFrame < 0 ? 0.0 : (double) (frameSample - lastFrame) / sampleRate;
+        const auto alpha = lastFrame < 0 ? 1.0f : (float) (1.0 - std::exp (-elapsed / timeConstantSeconds));
+
+        mean += (flux - mean) * alpha;
+        deviation += (std::abs (flux - mean) - deviation) * alpha;
+        lastFrame = frameSample;
+
+        if (! isOnset)
+            return 0.0f;
+
+        lastOnset = frameSample;
+        return juce::jlimit (0.0f, 1.0f, flux);
+    }
+
+private:
+    static constexpr double timeConstantSeconds = 0.5;
+    static constexpr double refractorySeconds = 0.05;
+    static constexpr float sensitivity = 2.0f;
+    static constexpr float minimumFlux = 0.08f;
+
+    double sampleRate = 48000.0;
+    juce::int64 refractorySamples = 2400;
+    float mean = 0.0f;
+    float deviation = 0.0f;
+    juce::int64 lastFrame = -1;
+    juce::int64 lastOnset = 0;
+};
+
+// Single producer (audio thread), single consumer (editor) queue of onset events for all
+// channels. A full queue drops new events rather than blocking.
+class OnsetEventQueue
+{
+public:
+    static constexpr int capacity = 256;
+
+    bool push (const OnsetEvent& event) noexcept
+    {
+        const auto scope = fifo.write (1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        events[(size_t) scope.startIndex1] = event;
+        return true;
+    }
+
+    bool pop (OnsetEvent& event) noexcept
+    {
+        const auto scope = fifo.read (1);
+        if (scope.blockSize1 == 0)
+            return false;
+
+        event = events[(size_t) scope.startIndex1];
+        return true;
+    }
+
+private:
+    std::array<OnsetEvent, capacity> events {};
+    juce::AbstractFifo fifo { capacity };
+};
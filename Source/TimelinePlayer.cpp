@@ -0,0 +1,225 @@
+#include "TimelinePlayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TimelinePlayer::TimelinePlayer()
+    : juce::Thread ("AtmosViz timeline prefetch")
+{
+    for (auto& page : pages)
+        page.frames.resize (framesPerPage);
+
+    decodeScratch.frames.resize (framesPerPage);
+}
+
+TimelinePlayer::~TimelinePlayer()
+{
+    close();
+}
+
+bool TimelinePlayer::open (const juce::File& file)
+{
+    close();
+
+    auto newReader = std::make_unique<MetricsTimelineReader> (file);
+    auto newPrefetchReader = std::make_unique<MetricsTimelineReader> (file);
+
+    if (! newReader->isValid() || ! newPrefetchReader->isValid() || newReader->getNumFrames() == 0)
+        return false;
+
+    reader = std::move (newReader);
+    prefetchReader = std::move (newPrefetchReader);
+    currentFile = file;
+    numFrames = reader->getNumFrames();
+    sampleRate = reader->getSampleRate();
+
+    MetricsTimelineFrame last;
+    reader->readFrame (numFrames - 1, last);
+    endSamples = (double) last.samplePosition;
+    durationSeconds = (endSamples + sampleRate / reader->getFrameRate()) / sampleRate;
+
+    for (auto& page : pages)
+        page.index = -1;
+
+    positionSamples = 0.0;
+    currentFrame = 0;
+    playing = false;
+
+    startThread (juce::Thread::Priority::low);
+    requestPrefetch (0);
+    return true;
+}
+
+void TimelinePlayer::close()
+{
+    stopThread (2000);
+    wantedPage.store (-1);
+
+    reader.reset();
+    prefetchReader.reset();
+    currentFile = juce::File();
+    numFrames = 0;
+    durationSeconds = 0.0;
+    playing = false;
+}
+
+const juce::StringArray& TimelinePlayer::getChannelNames() const noexcept
+{
+    static const juce::StringArray none;
+    return reader != nullptr ? reader->getChannelNames() : none;
+}
+
+void TimelinePlayer::setPositionSeconds (double seconds)
+{
+    if (reader == nullptr)
+        return;
+
+    positionSamples = juce::jlimit (0.0, endSamples, seconds * sampleRate);
+    currentFrame = reader->findFrame ((juce::int64) positionSamples);
+    requestPrefetch (currentFrame);
+}
+
+void TimelinePlayer::setPlaying (bool shouldPlay)
+{
+    if (shouldPlay && positionSamples >= endSamples)
+        setPositionSeconds (0.0);
+
+    playing = shouldPlay && reader != nullptr;
+    lastTickMs = juce::Time::getMillisecondCounterHiRes();
+}
+
+void TimelinePlayer::setSpeed (double newSpeed) noexcept
+{
+    speed = juce::jlimit (0.125, 64.0, newSpeed);
+    prefetchSpeed.store (speed, std::memory_order_relaxed);
+}
+
+bool TimelinePlayer::advance (MetricsTimelineFrame& dest)
+{
+    if (reader == nullptr)
+        return false;
+
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if (playing)
+    {
+        positionSamples += (now - lastTickMs) * 0.001 * speed * sampleRate;
+
+        if (positionSamples >= endSamples)
+        {
+            positionSamples = endSamples;
+            playing = false;
+        }
+    }
+
+    lastTickMs = now;
+
+    // Frames are usually evenly spaced, but long host blocks stretch them, so the cursor
+    // walks forward by position rather than by frame count. Seeks reposition it directly.
+    while (currentFrame + 1 < numFrames
+           && getFrame (currentFrame + 1, lookahead)
+           && (double) lookahead.samplePosition <= positionSamples)
+    {
+        ++currentFrame;
+    }
+
+    requestPrefetch (currentFrame);
+    return getFrame (currentFrame, dest);
+}
+
+bool TimelinePlayer::getFrame (juce::int64 frameIndex, MetricsTimelineFrame& dest)
+{
+    const auto pageIndex = frameIndex / framesPerPage;
+
+    {
+        const juce::ScopedLock lock (cacheLock);
+
+        for (const auto& page : pages)
+        {
+            if (page.index == pageIndex && frameIndex - pageIndex * framesPerPage < page.numFrames)
+            {
+                dest = page.frames[(size_t) (frameIndex - pageIndex * framesPerPage)];
+                return true;
+            }
+        }
+    }
+
+    // Not prefetched yet (typically right after a seek): decode it here.
+    return reader->readFrame (frameIndex, dest);
+}
+
+void TimelinePlayer::requestPrefetch (juce::int64 frameIndex)
+{
+    const auto pageIndex = frameIndex / framesPerPage;
+
+    if (wantedPage.exchange (pageIndex) != pageIndex)
+        notify();
+}
+
+void TimelinePlayer::decodePage (juce::int64 pageIndex, Page& page)
+{
+    const auto firstFrame = pageIndex * framesPerPage;
+    page.index = pageIndex;
+    page.numFrames = (int) juce::jmin ((juce::int64) framesPerPage, numFrames - firstFrame);
+
+    for (int i = 0; i < page.numFrames; ++i)
+        prefetchReader->readFrame (firstFrame + i, page.frames[(size_t) i]);
+}
+
+void TimelinePlayer::run()
+{
+    while (! threadShouldExit())
+    {
+        const auto wanted = wantedPage.load();
+
+        if (wanted >= 0)
+        {
+            // One page covers about ten seconds at normal speed; look further ahead when
+            // playing fast, keeping a page of the cache for what was just played.
+            const auto pagesAhead = juce::jlimit (1, numPages - 2, 1 + (int) std::ceil (prefetchSpeed.load (std::memory_order_relaxed) / 4.0));
+
+            for (auto pageIndex = wanted; pageIndex <= wanted + pagesAhead && ! threadShouldExit(); ++pageIndex)
+            {
+                if (pageIndex * framesPerPage >= numFrames || wantedPage.load() != wanted)
+                    break;
+
+                {
+                    const juce::ScopedLock lock (cacheLock);
+
+                    const auto cached = std::any_of (pages.begin(), pages.end(), [pageIndex] (const Page& page) { return page.index == pageIndex; });
+                    if (cached)
+                        continue;
+                }
+
+                decodePage (pageIndex, decodeScratch);
+
+                const juce::ScopedLock lock (cacheLock);
+
+                // Replace the page furthest from the wanted window, counting pages behind the
+                // playhead as further than those ahead.
+                auto* victim = &pages[0];
+                auto worstDistance = std::numeric_limits<juce::int64>::min();
+
+                for (auto& page : pages)
+                {
+                    const auto distance = page.index < 0 ? std::numeric_limits<juce::int64>::max()
+                                        : page.index < wanted ? 2 * (wanted - page.index)
+                                                              : page.index - wanted;
+                    if (distance > worstDistance)
+                    {
+                        worstDistance = distance;
+                        victim = &page;
+                    }
+                }
+
+                std::swap (victim->frames, decodeScratch.frames);
+                victim->index = decodeScratch.index;
+                victim->numFrames = decodeScratch.numFrames;
+            }
+        }
+
+        // Woken by requestPrefetch when the playhead enters another page.
+        wait (-1);
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "MetricsTimeline.h"
+
+// Plays a recorded metrics timeline back at any speed, for reviewing a pass without the
+// audio. The message thread owns the playhead and reads frames from a small cache of
+// decoded pages (one page per file chunk); a background thread decodes the pages at and
+// ahead of the playhead into it. Each side has its own reader on the same memory-mapped
+// file, so a seek to an uncached spot decodes just that frame's chunk on the spot instead of
+// waiting for the prefetcher.
+class TimelinePlayer : public MetricsFrameSource,
+                       private juce::Thread
+{
+public:
+    TimelinePlayer();
+    ~TimelinePlayer() override;
+
+    /** Message thread. Returns false if the file is not a readable timeline. */
+    bool open (const juce::File& file);
+    void close();
+
+    bool isOpen() const noexcept override           { return reader != nullptr; }
+    juce::File getFile() const                      { return currentFile; }
+    const juce::StringArray& getChannelNames() const noexcept override;
+
+    double getDurationSeconds() const noexcept      { return durationSeconds; }
+    double getPositionSeconds() const noexcept      { return positionSamples / sampleRate; }
+    void setPositionSeconds (double seconds);
+
+    void setPlaying (bool shouldPlay);
+    bool isPlaying() const noexcept                 { return playing; }
+    void setSpeed (double newSpeed) noexcept;
+    double getSpeed() const noexcept                { return speed; }
+
+    /** Message thread, once per display tick: moves the playhead on by the wall-clock time
+        since the previous call times the speed, and copies the frame under it. */
+    bool advance (MetricsTimelineFrame& dest) override;
+
+private:
+    static constexpr int numPages = 8;
+    static constexpr int framesPerPage = MetricsTimelineRecorder::framesPerChunk;
+
+    struct Page
+    {
+        juce::int64 index = -1;
+        int numFrames = 0;
+        std::vector<MetricsTimelineFrame> frames;
+    };
+
+    void run() override;
+    bool getFrame (juce::int64 frameIndex, MetricsTimelineFrame& dest);
+    void requestPrefetch (juce::int64 frameIndex);
+    void decodePage (juce::int64 pageIndex, Page& page);
+
+    juce::File currentFile;
+    std::unique_ptr<MetricsTimelineReader> reader;           // message thread
+    std::unique_ptr<MetricsTimelineReader> prefetchReader;   // prefetch thread
+    juce::int64 numFrames = 0;
+    double sampleRate = 48000.0;
+    double durationSeconds = 0.0;
+    double endSamples = 0.0;
+
+    double positionSamples = 0.0;
+    juce::int64 currentFrame = 0;
+    bool playing = false;
+    double speed = 1.0;
+    double lastTickMs = 0.0;
+    MetricsTimelineFrame lookahead;
+
+    juce::CriticalSection cacheLock;
+    std::array<Page, numPages> pages;
+    Page decodeScratch;
+    std::atomic<juce::int64> wantedPage { -1 };
+    std::atomic<double> prefetchSpeed { 1.0 };
+
+    JUCE_DECLARE_NON_COPYABLE (TimelinePlayer)
+};
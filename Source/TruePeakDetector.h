@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+// 4x oversampled peak detector per ITU-R BS.1770-4 Annex 2: a 48-tap polyphase
+// interpolator split into four 12-tap phases, one per inter-sample position.
+// Keeps its own history so consecutive blocks join seamlessly.
+class TruePeakDetector
+{
+public:
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    void reset() noexcept
+    {
+        history.fill (0.0f);
+        writeIndex = 0;
+    }
+
+    /** Returns the largest absolute interpolated value in the block. */
+    float process (const float* data, int numSamples) noexcept
+    {
+        float peak = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            push (data[i]);
+
+            const auto* window = history.data() + writeIndex + 1;
+
+            for (const auto& phase : coefficients)
+            {
+                float sum = 0.0f;
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                    sum += phase[(size_t) tap] * window[tapsPerPhase - 1 - tap];
+
+                peak = juce::jmax (peak, std::abs (sum));
+            }
+        }
+
+        return peak;
+    }
+
+    /** Feeds a block into the history without filtering it, so a later process() call
+        continues seamlessly. */
+    void prime (const float* data, int numSamples) noexcept
+    {
+        for (int i = juce::jmax (0, numSamples - tapsPerPhase); i < numSamples; ++i)
+            push (data[i]);
+    }
+
+private:
+    void push (float sample) noexcept
+    {
+        // Every sample is written twice so the newest tapsPerPhase values are always
+        // contiguous, oldest first, starting at writeIndex + 1.
+        writeIndex = (writeIndex + 1) % tapsPerPhase;
+        history[(size_t) writeIndex] = sample;
+        history[(size_t) (writeIndex + tapsPerPhase)] = sample;
+    }
+
+    static constexpr std::array<std::array<float, tapsPerPhase>, oversampling> coefficients {{
+        {{  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+            0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f }},
+        {{ -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+            0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f }},
+        {{ -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+            0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f }},
+        {{ -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+            0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }}
+    }};
+
+    std::array<float, 2 * tapsPerPhase> history {};
+    int writeIndex = 0;
+};
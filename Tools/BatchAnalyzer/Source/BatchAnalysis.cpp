@@ -0,0 +1,365 @@
+#include "BatchAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "AnalysisEngine.h"
+#include "MetricsTimeline.h"
+
+namespace BatchAnalysis
+{
+namespace
+{
+    struct NamedLayout
+    {
+        const char* name;
+        juce::AudioChannelSet (*create)();
+    };
+
+    const NamedLayout namedLayouts[] =
+    {
+        { "1.0", &juce::AudioChannelSet::mono },
+        { "2.0", &juce::AudioChannelSet::stereo },
+        { "5.1", &juce::AudioChannelSet::create5point1 },
+        { "7.1", &juce::AudioChannelSet::create7point1 },
+        { "5.1.2", &juce::AudioChannelSet::create5point1point2 },
+        { "7.1.2", &juce::AudioChannelSet::create7point1point2 },
+        { "5.1.4", &juce::AudioChannelSet::create5point1point4 },
+        { "7.1.4", &juce::AudioChannelSet::create7point1point4 },
+        { "9.1.4", &juce::AudioChannelSet::create9point1point4 },
+        { "7.1.6", &juce::AudioChannelSet::create7point1point6 },
+        { "9.1.6", &juce::AudioChannelSet::create9point1point6 },
+    };
+
+    constexpr float floorDb = -120.0f;
+    constexpr double shortTermWindowSeconds = 3.0;
+
+    // The WAV channel mask only names the classic positions, so wide and top-side speakers
+    // (and everything in files without a mask) come from the channel count instead.
+    juce::AudioChannelSet chooseLayout (juce::AudioFormatReader& reader, const Options& options)
+    {
+        const auto numChannels = (int) reader.numChannels;
+
+        if (! options.layoutOverride.isDisabled())
+            return options.layoutOverride.size() == numChannels ? options.layoutOverride : juce::AudioChannelSet();
+
+        const auto fromFile = reader.getChannelLayout();
+        if (fromFile.size() == numChannels && ! fromFile.isDiscreteLayout())
+            return fromFile;
+
+        return AnalysisEngine::getDefaultLayoutForChannelCount (numChannels);
+    }
+
+    juce::String describeLayout (const juce::AudioChannelSet& layout)
+    {
+        for (const auto& named : namedLayouts)
+            if (named.create() == layout)
+                return named.name;
+
+        return layout.getDescription();
+    }
+
+    juce::String toDbString (float gain)
+    {
+        return juce::String (juce::Decibels::gainToDecibels (gain, floorDb), 2);
+    }
+
+    // EBU Tech 3342: short-term values above -70 LUFS and within 20 LU of their power mean,
+    // spread between the 10th and 95th percentiles.
+    float computeLoudnessRange (std::vector<float> shortTerm)
+    {
+        shortTerm.erase (std::remove_if (shortTerm.begin(), shortTerm.end(), [] (float lufs) { return lufs <= -70.0f; }), shortTerm.end());
+
+        if (shortTerm.empty())
+            return 0.0f;
+
+        double powerSum = 0.0;
+        for (auto lufs : shortTerm)
+            powerSum += std::pow (10.0, lufs / 10.0);
+
+        const auto relativeGate = (float) (10.0 * std::log10 (powerSum / (double) shortTerm.size())) - 20.0f;
+        shortTerm.erase (std::remove_if (shortTerm.begin(), shortTerm.end(), [relativeGate] (float lufs) { return lufs <= relativeGate; }), shortTerm.end());
+
+        if (shortTerm.empty())
+            return 0.0f;
+
+        std::sort (shortTerm.begin(), shortTerm.end());
+
+        const auto percentile = [&shortTerm] (double fraction)
+        {
+            return shortTerm[(size_t) juce::jlimit (0, (int) shortTerm.size() - 1, juce::roundToInt (fraction * (double) (shortTerm.size() - 1)))];
+        };
+
+        return percentile (0.95) - percentile (0.10);
+    }
+
+    struct ChannelStatistics
+    {
+        float peak = 0.0f;
+        float truePeak = 0.0f;
+        double sumOfSquares = 0.0;
+        std::uint32_t overs = 0;
+        std::uint32_t clips = 0;
+    };
+}
+
+juce::AudioChannelSet layoutFromName (const juce::String& name)
+{
+    for (const auto& named : namedLayouts)
+        if (name.trim() == named.name)
+            return named.create();
+
+    return {};
+}
+
+juce::StringArray getLayoutNames()
+{
+    juce::StringArray names;
+    for (const auto& named : namedLayouts)
+        names.add (named.name);
+
+    return names;
+}
+
+juce::String getFileWildcard()
+{
+    return "*.wav;*.bwf;*.caf;*.aif;*.aiff";
+}
+
+Result analyseFile (const juce::File& file, const Options& options)
+{
+    Result result;
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr)
+    {
+        result.message = "not a readable audio file";
+        return result;
+    }
+
+    const auto numChannels = (int) reader->numChannels;
+    const auto sampleRate = reader->sampleRate;
+    const auto lengthInSamples = reader->lengthInSamples;
+
+    if (numChannels > MetricsTimelineFrame::maxChannels)
+    {
+        result.message = juce::String (numChannels) + " channels; at most " + juce::String (MetricsTimelineFrame::maxChannels) + " are supported";
+        return result;
+    }
+
+    const auto layout = chooseLayout (*reader, options);
+
+    if (layout.size() != numChannels)
+    {
+        result.message = "no known layout has " + juce::String (numChannels) + " channels; pass --layout";
+        return result;
+    }
+
+    // Decoding from the mapped file avoids a copy through the stream buffers; formats that
+    // cannot be mapped (CAF, compressed AIFF) are streamed.
+    juce::AudioFormatReader* source = reader.get();
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+
+    if (auto* format = formats.findFormatForFileExtension (file.getFileExtension()))
+    {
+        mappedReader.reset (format->createMemoryMappedReader (file));
+
+        if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            source = mappedReader.get();
+    }
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    AnalysisEngine engine;
+    engine.prepare (sampleRate, layout);
+
+    const auto& definitions = engine.getSpeakerDefinitions();
+    const auto numDefinitions = juce::jmin ((int) definitions.size(), MetricsTimelineFrame::maxChannels);
+
+    MetricsTimelineFrameBuilder builder;
+    builder.prepare (sampleRate, MetricsTimelineWriter::framesPerSecond);
+    builder.reset();
+
+    const auto outputFor = [&] (const juce::String& suffix)
+    {
+        const auto folder = options.outputDirectory != juce::File() ? options.outputDirectory : file.getParentDirectory();
+        return folder.getChildFile (file.getFileNameWithoutExtension() + suffix);
+    };
+
+    std::unique_ptr<juce::FileOutputStream> csv;
+
+    if (options.writeCsv)
+    {
+        const auto csvFile = outputFor (".metrics.csv");
+        csvFile.deleteFile();
+        csv = std::make_unique<juce::FileOutputStream> (csvFile);
+
+        if (! csv->openedOk())
+        {
+            result.message = "cannot write " + csvFile.getFullPathName();
+            return result;
+        }
+
+        juce::String header ("time_s,momentary_lufs,short_term_lufs");
+        for (int i = 0; i < numDefinitions; ++i)
+            for (auto* column : { "rms_db", "peak_db", "low_db", "mid_db", "high_db" })
+                header << ',' << definitions[(size_t) i].id << '_' << column;
+
+        csv->writeText (header + "\n", false, false, nullptr);
+    }
+
+    MetricsTimelineWriter timeline;
+
+    if (options.writeTimeline)
+    {
+        juce::StringArray channelNames;
+        for (int i = 0; i < numDefinitions; ++i)
+            channelNames.add (definitions[(size_t) i].displayName);
+
+        if (! timeline.open (outputFor (".avtl"), sampleRate, channelNames))
+        {
+            result.message = "cannot write " + outputFor (".avtl").getFullPathName();
+            return result;
+        }
+    }
+
+    // Blocks of one timeline frame; the builder splits any block size, this just keeps the
+    // analysis granularity matching the frames.
+    const auto blockSize = builder.getSamplesPerFrame();
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+    AnalysisEngine::BlockResult blockResult;
+    MetricsTimelineFrame block;
+    std::vector<ChannelStatistics> statistics ((size_t) numDefinitions);
+    std::vector<float> shortTermValues;
+    auto maxMomentary = LoudnessMeter::silenceLufs;
+    auto maxShortTerm = LoudnessMeter::silenceLufs;
+
+    const auto writeFrame = [&] (const MetricsTimelineFrame& frame)
+    {
+        const auto seconds = (double) frame.samplePosition / sampleRate;
+
+        maxMomentary = juce::jmax (maxMomentary, frame.momentaryLufs);
+
+        if (seconds + 1.0 / MetricsTimelineWriter::framesPerSecond >= shortTermWindowSeconds)
+        {
+            maxShortTerm = juce::jmax (maxShortTerm, frame.shortTermLufs);
+            shortTermValues.push_back (frame.shortTermLufs);
+        }
+
+        if (csv != nullptr)
+        {
+            juce::String row;
+            row.preallocateBytes ((size_t) (32 + numDefinitions * 40));
+            row << juce::String (seconds, 3) << ',' << juce::String (frame.momentaryLufs, 2) << ',' << juce::String (frame.shortTermLufs, 2);
+
+            for (int i = 0; i < numDefinitions; ++i)
+            {
+                const auto& channel = frame.channels[(size_t) i];
+                row << ',' << toDbString (channel.rms) << ',' << toDbString (channel.peak)
+                    << ',' << toDbString (channel.low) << ',' << toDbString (channel.mid) << ',' << toDbString (channel.high);
+            }
+
+            csv->writeText (row + "\n", false, false, nullptr);
+        }
+
+        if (timeline.isOpen())
+            timeline.append (frame);
+    };
+
+    for (juce::int64 position = 0; position < lengthInSamples; position += blockSize)
+    {
+        const auto numSamples = (int) juce::jmin ((juce::int64) blockSize, lengthInSamples - position);
+
+        if (numSamples != buffer.getNumSamples())
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+        source->read (&buffer, 0, numSamples, position, true, true);
+        engine.process (buffer, true, AnalysisGovernor::Tier::Full, blockResult);
+
+        const auto loudness = engine.getLoudnessMeter().getSnapshot();
+        block.momentaryLufs = loudness.momentaryLufs;
+        block.shortTermLufs = loudness.shortTermLufs;
+        block.numChannels = numDefinitions;
+
+        for (int i = 0; i < numDefinitions; ++i)
+        {
+            const auto& metrics = blockResult.metrics[(size_t) i];
+            auto& stats = statistics[(size_t) i];
+
+            stats.peak = juce::jmax (stats.peak, metrics.peak);
+            stats.truePeak = juce::jmax (stats.truePeak, metrics.truePeak);
+            stats.sumOfSquares += (double) metrics.rms * (double) metrics.rms * (double) numSamples;
+            stats.overs = juce::jmax (stats.overs, metrics.overs);
+            stats.clips = juce::jmax (stats.clips, metrics.clips);
+
+            block.channels[(size_t) i] = { metrics.rms, metrics.peak, metrics.bands.low, metrics.bands.mid, metrics.bands.high };
+        }
+
+        builder.addBlock (block, numSamples, writeFrame);
+    }
+
+    // The file rarely ends on a frame boundary; its tail still belongs in the outputs.
+    builder.flush (writeFrame);
+
+    const auto integrated = engine.getLoudnessMeter().getSnapshot().integratedLufs;
+    engine.release();
+    timeline.close();
+    csv.reset();
+
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    result.durationSeconds = (double) lengthInSamples / sampleRate;
+    result.realtimeFactor = elapsed > 0.0 ? result.durationSeconds / elapsed : 0.0;
+
+    if (options.writeJson)
+    {
+        juce::DynamicObject::Ptr summary (new juce::DynamicObject());
+        summary->setProperty ("file", file.getFullPathName());
+        summary->setProperty ("sampleRate", sampleRate);
+        summary->setProperty ("durationSeconds", result.durationSeconds);
+        summary->setProperty ("layout", describeLayout (layout));
+        summary->setProperty ("realtimeFactor", result.realtimeFactor);
+        summary->setProperty ("integratedLufs", integrated);
+        summary->setProperty ("maxMomentaryLufs", maxMomentary);
+        summary->setProperty ("maxShortTermLufs", maxShortTerm);
+        summary->setProperty ("loudnessRangeLu", computeLoudnessRange (std::move (shortTermValues)));
+
+        juce::Array<juce::var> channels;
+
+        for (int i = 0; i < numDefinitions; ++i)
+        {
+            const auto& stats = statistics[(size_t) i];
+            const auto rms = lengthInSamples > 0 ? (float) std::sqrt (stats.sumOfSquares / (double) lengthInSamples) : 0.0f;
+            const auto peakDb = juce::Decibels::gainToDecibels (stats.peak, floorDb);
+            const auto rmsDb = juce::Decibels::gainToDecibels (rms, floorDb);
+
+            juce::DynamicObject::Ptr channel (new juce::DynamicObject());
+            channel->setProperty ("id", definitions[(size_t) i].id);
+            channel->setProperty ("peakDbfs", peakDb);
+            channel->setProperty ("truePeakDbtp", juce::Decibels::gainToDecibels (stats.truePeak, floorDb));
+            channel->setProperty ("rmsDbfs", rmsDb);
+            channel->setProperty ("crestFactorDb", rms > 0.0f ? peakDb - rmsDb : 0.0f);
+            channel->setProperty ("overs", (int) stats.overs);
+            channel->setProperty ("clips", (int) stats.clips);
+            channels.add (channel.get());
+        }
+
+        summary->setProperty ("channels", channels);
+
+        const auto jsonFile = outputFor (".summary.json");
+        if (! jsonFile.replaceWithText (juce::JSON::toString (summary.get())))
+        {
+            result.message = "cannot write " + jsonFile.getFullPathName();
+            return result;
+        }
+    }
+
+    result.ok = true;
+    return result;
+}
+}
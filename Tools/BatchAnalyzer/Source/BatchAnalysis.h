@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Analyses one multichannel file with the plugin's analysis engine, as fast as it can be read,
+// and writes what it measured next to it (or into the output folder).
+namespace BatchAnalysis
+{
+    struct Options
+    {
+        juce::File outputDirectory;              // empty: next to each input file
+        bool writeCsv = true;                    // <name>.metrics.csv, one row per timeline frame
+        bool writeJson = true;                   // <name>.summary.json, loudness and per-channel statistics
+        bool writeTimeline = false;              // <name>.avtl, the binary timeline the plugin replays
+        juce::AudioChannelSet layoutOverride;    // empty: from the file's channel mask or count
+    };
+
+    struct Result
+    {
+        bool ok = false;
+        juce::String message;
+        double durationSeconds = 0.0;
+        double realtimeFactor = 0.0;
+    };
+
+    /** Thread safe: every call owns its reader, engine and outputs. */
+    Result analyseFile (const juce::File& file, const Options& options);
+
+    /** "5.1", "7.1.4", "9.1.6" and so on; empty for anything else. */
+    juce::AudioChannelSet layoutFromName (const juce::String& name);
+    juce::StringArray getLayoutNames();
+
+    juce::String getFileWildcard();
+}
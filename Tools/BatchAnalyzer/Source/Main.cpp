@@ -0,0 +1,149 @@
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <iostream>
+
+#include "BatchAnalysis.h"
+
+namespace
+{
+    void printUsage (const juce::String& executableName)
+    {
+        std::cout << "Usage: " << executableName << " [options] <file or folder>...\n"
+                  << "\n"
+                  << "Analyses multichannel WAV/BWF/AIFF (and CAF on macOS) files faster than realtime.\n"
+                  << "\n"
+                  << "  -o, --output <folder>   write results here instead of next to each input\n"
+                  << "  -f, --format <list>     any of csv,json,avtl (default csv,json)\n"
+                  << "  -j, --jobs <n>          files analysed at once (default: one per core)\n"
+                  << "  -r, --recursive         include files in subfolders\n"
+                  << "      --layout <name>     channel layout for every file: "
+                  << BatchAnalysis::getLayoutNames().joinIntoString (", ") << "\n"
+                  << "  -h, --help              show this message\n";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        printUsage (args.executableName);
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    BatchAnalysis::Options options;
+
+    // Options are removed as they are read; whatever is left names the inputs.
+    if (args.containsOption ("--output|-o"))
+    {
+        options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args.removeValueForOption ("--output|-o"));
+
+        if (! options.outputDirectory.createDirectory())
+        {
+            std::cerr << "Cannot create " << options.outputDirectory.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--format|-f"))
+    {
+        const auto formatList = args.removeValueForOption ("--format|-f");
+        const auto formats = juce::StringArray::fromTokens (formatList, ",", {});
+        options.writeCsv = formats.contains ("csv");
+        options.writeJson = formats.contains ("json");
+        options.writeTimeline = formats.contains ("avtl");
+
+        if (! (options.writeCsv || options.writeJson || options.writeTimeline))
+        {
+            std::cerr << "No known output format in '" << formatList << "'\n";
+            return 1;
+        }
+    }
+
+    if (args.containsOption ("--layout"))
+    {
+        const auto layoutName = args.removeValueForOption ("--layout");
+        options.layoutOverride = BatchAnalysis::layoutFromName (layoutName);
+
+        if (options.layoutOverride.isDisabled())
+        {
+            std::cerr << "Unknown layout '" << layoutName << "'\n";
+            return 1;
+        }
+    }
+
+    const auto numJobs = args.containsOption ("--jobs|-j")
+                             ? juce::jmax (1, args.removeValueForOption ("--jobs|-j").getIntValue())
+                             : juce::SystemStats::getNumCpus();
+    const auto recursive = args.removeOptionIfFound ("--recursive|-r");
+
+    juce::Array<juce::File> inputs;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto argument = args[i];
+
+        if (argument.isOption())
+        {
+            std::cerr << "Unknown option " << argument.text << "\n";
+            return 1;
+        }
+
+        const auto file = argument.resolveAsFile();
+
+        if (file.isDirectory())
+        {
+            for (const auto& child : file.findChildFiles (juce::File::findFiles, recursive, BatchAnalysis::getFileWildcard()))
+                inputs.add (child);
+        }
+        else if (file.existsAsFile())
+        {
+            inputs.add (file);
+        }
+        else
+        {
+            std::cerr << "Not found: " << file.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    if (inputs.isEmpty())
+    {
+        std::cerr << "No audio files to analyse\n";
+        return 1;
+    }
+
+    // One file per job: the engine's loudness, correlation and delay state spans every
+    // channel of a file, so files are the unit that parallelises without any sharing.
+    juce::ThreadPool pool (juce::jmin (numJobs, inputs.size()));
+    juce::CriticalSection outputLock;
+    std::atomic<int> failures { 0 };
+
+    for (const auto& input : inputs)
+    {
+        pool.addJob ([input, &options, &outputLock, &failures]
+        {
+            const auto result = BatchAnalysis::analyseFile (input, options);
+
+            const juce::ScopedLock lock (outputLock);
+
+            if (result.ok)
+            {
+                std::cout << input.getFullPathName() << ": " << juce::String (result.durationSeconds, 1) << " s at "
+                          << juce::String (result.realtimeFactor, 1) << "x realtime\n";
+            }
+            else
+            {
+                std::cerr << input.getFullPathName() << ": " << result.message << "\n";
+                ++failures;
+            }
+        });
+    }
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep (50);
+
+    return failures.load() > 0 ? 1 : 0;
+}
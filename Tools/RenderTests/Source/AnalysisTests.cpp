@@ -0,0 +1,192 @@
+#include <JuceHeader.h>
+
+#include "AnalysisEngine.h"
+
+namespace
+{
+    using Bands = AnalysisEngine::FrequencyBands;
+    using Tier = AnalysisGovernor::Tier;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr double signalSeconds = 3.0;
+    constexpr double settleSeconds = 0.5;     // longer than every window, including the decimated one
+    constexpr float noiseAmplitude = 0.5f;    // uniform, so an RMS of 0.5 / sqrt (3)
+
+    // A sine of the given frequency at half scale, or uniform white noise when it is 0.
+    juce::AudioBuffer<float> makeSignal (double frequencyHz)
+    {
+        juce::AudioBuffer<float> signal (1, (int) (signalSeconds * sampleRate));
+        juce::Random random (1234);
+        auto* data = signal.getWritePointer (0);
+
+        for (int i = 0; i < signal.getNumSamples(); ++i)
+            data[i] = frequencyHz > 0.0 ? 0.5f * (float) std::sin (juce::MathConstants<double>::twoPi * frequencyHz * i / sampleRate)
+                                        : noiseAmplitude * (2.0f * random.nextFloat() - 1.0f);
+
+        return signal;
+    }
+
+    // Runs a mono engine over the signal block by block and returns each band's RMS over the
+    // blocks after the settling time, so noise reads without the bias of averaging magnitudes.
+    Bands measureBands (const juce::AudioBuffer<float>& signal, bool offline, Tier tier)
+    {
+        AnalysisEngine engine;
+        engine.prepare (sampleRate, juce::AudioChannelSet::mono());
+
+        AnalysisEngine::BlockResult result;
+        juce::AudioBuffer<float> block (1, blockSize);
+        double low = 0.0, mid = 0.0, high = 0.0;
+        int count = 0;
+
+        for (int start = 0; start + blockSize <= signal.getNumSamples(); start += blockSize)
+        {
+            block.copyFrom (0, 0, signal, 0, start, blockSize);
+            engine.process (block, offline, tier, result);
+
+            if (start < (int) (settleSeconds * sampleRate))
+                continue;
+
+            const auto& bands = result.metrics.front().bands;
+            low += (double) bands.low * bands.low;
+            mid += (double) bands.mid * bands.mid;
+            high += (double) bands.high * bands.high;
+            ++count;
+        }
+
+        return { (float) std::sqrt (low / count), (float) std::sqrt (mid / count), (float) std::sqrt (high / count) };
+    }
+
+    float ratioDb (float value, float reference)
+    {
+        return juce::Decibels::gainToDecibels (value / reference, -200.0f);
+    }
+
+    float bandValue (const Bands& bands, int band) noexcept
+    {
+        return band == 0 ? bands.low : (band == 1 ? bands.mid : bands.high);
+    }
+
+    // A tone in each band (only that band is compared), and noise (all three are).
+    struct SignalCase
+    {
+        const char* name;
+        double frequencyHz;
+        int band;
+    };
+
+    constexpr std::array<SignalCase, 4> signalCases { {
+        { "140 Hz tone", 140.0,  0 },
+        { "1 kHz tone",  1000.0, 1 },
+        { "6 kHz tone",  6000.0, 2 },
+        { "White noise", 0.0,   -1 }
+    } };
+}
+
+// Feeds tones and noise through every realtime governor tier and checks that the bands read
+// alike whichever transforms produced them, so a tier change does not shift the colours.
+class BandScaleTest : public juce::UnitTest
+{
+public:
+    BandScaleTest()
+        : juce::UnitTest ("Band levels across analysis tiers", "AtmosViz") {}
+
+    void runTest() override
+    {
+        static constexpr std::array<Tier, 3> reducedTiers { Tier::ReducedFft, Tier::LongHop, Tier::RoundRobin };
+
+        for (const auto& testCase : signalCases)
+        {
+            beginTest (testCase.name);
+
+            const auto signal = makeSignal (testCase.frequencyHz);
+            const auto reference = measureBands (signal, false, Tier::Full);
+
+            for (auto tier : reducedTiers)
+            {
+                const auto bands = measureBands (signal, false, tier);
+                const juce::String tierName (AnalysisGovernor::getTierDescription (tier));
+
+                for (int band = 0; band < 3; ++band)
+                {
+                    if (testCase.band >= 0 && band != testCase.band)
+                        continue;
+
+                    // The 256-point transform has a single bin below 200 Hz, which a low tone
+                    // partly leaks out of.
+                    const auto tolerance = testCase.band == 0 ? 2.5f : 1.0f;
+                    const auto difference = ratioDb (bandValue (bands, band), bandValue (reference, band));
+
+                    expect (std::abs (difference) < tolerance,
+                            tierName + ", band " + juce::String (band) + ": " + juce::String (difference, 2) + " dB from Full");
+                }
+            }
+        }
+    }
+};
+
+static BandScaleTest bandScaleTest;
+
+// The Full tier takes each band from a different transform, the low one on a decimated
+// stream. White noise has the same density at every frequency, so all three bands must read
+// the value the reference unit gives it: the noise RMS times the square root of the window
+// power of a fftSize-point unit-mean Hann.
+class FullTierBalanceTest : public juce::UnitTest
+{
+public:
+    FullTierBalanceTest()
+        : juce::UnitTest ("Full tier band balance", "AtmosViz") {}
+
+    void runTest() override
+    {
+        beginTest ("White noise");
+
+        const auto bands = measureBands (makeSignal (0.0), false, Tier::Full);
+        const auto expected = noiseAmplitude / std::sqrt (3.0f) * std::sqrt (1.5f * (float) AnalysisEngine::fftSize);
+
+        for (const auto& [name, value] : { std::pair<const char*, float> { "low", bands.low },
+                                           std::pair<const char*, float> { "mid", bands.mid },
+                                           std::pair<const char*, float> { "high", bands.high } })
+        {
+            expect (std::abs (ratioDb (value, expected)) < 1.0f,
+                    juce::String (name) + " reads " + juce::String (value, 3) + " for an expected " + juce::String (expected, 3));
+        }
+    }
+};
+
+static FullTierBalanceTest fullTierBalanceTest;
+
+// Offline renders analyse with a 2048- or 4096-point transform; a bounce, and everything
+// built on the offline path (batch analysis, the file player's cache, frame export), has to
+// read like the same material played live.
+class OfflineBandScaleTest : public juce::UnitTest
+{
+public:
+    OfflineBandScaleTest()
+        : juce::UnitTest ("Offline and realtime band levels", "AtmosViz") {}
+
+    void runTest() override
+    {
+        for (const auto& testCase : signalCases)
+        {
+            beginTest (testCase.name);
+
+            const auto signal = makeSignal (testCase.frequencyHz);
+            const auto realtime = measureBands (signal, false, Tier::Full);
+            const auto offline = measureBands (signal, true, Tier::Full);
+
+            for (int band = 0; band < 3; ++band)
+            {
+                if (testCase.band >= 0 && band != testCase.band)
+                    continue;
+
+                const auto difference = ratioDb (bandValue (offline, band), bandValue (realtime, band));
+
+                expect (std::abs (difference) < 1.0f,
+                        "band " + juce::String (band) + ": offline is " + juce::String (difference, 2) + " dB from realtime");
+            }
+        }
+    }
+};
+
+static OfflineBandScaleTest offlineBandScaleTest;
@@ -0,0 +1,17 @@
+#include <JuceHeader.h>
+
+int main()
+{
+    // Fonts, images and components need the GUI side of JUCE set up, but no message loop.
+    const juce::ScopedJuceInitialiser_GUI gui;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+    runner.runTestsInCategory ("AtmosViz");
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult (i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+#include <JuceHeader.h>
+
+#include "PluginEditor.h"
+#include "PluginProcessor.h"
+
+// Paints the visualizer into an image in every view mode, driven by loud and moving levels so
+// the field sources, grids, isosurface meshes and level-dependent markers and labels all run,
+// and checks that, once warmed up, a frame fits in the storage kept from the frames before it.
+class VisualizerFrameStorageTest : public juce::UnitTest
+{
+public:
+    VisualizerFrameStorageTest()
+        : juce::UnitTest ("Visualizer frame storage", "AtmosViz") {}
+
+    void runTest() override
+    {
+        using Mode = SpeakerVisualizerComponent::VisualizationMode;
+
+        static constexpr std::array<std::pair<Mode, const char*>, 8> modes { {
+            { Mode::DirectionalLobes,   "Directional lobes" },
+            { Mode::LayeredLobes,       "Layered lobes" },
+            { Mode::DirectivityBalloon, "Directivity balloon" },
+            { Mode::RadiationHeatmap,   "Radiation heatmap" },
+            { Mode::TemporalTrail,      "Temporal trail" },
+            { Mode::SliceHeatmap,       "Slice heatmap" },
+            { Mode::VolumetricField,    "Volumetric field" },
+            { Mode::Isosurface,         "Isosurface" }
+        } };
+
+        AtmosVizAudioProcessor processor;
+        processor.prepareToPlay (48000.0, 512);
+
+        juce::StringArray channelNames;
+        for (const auto& definition : processor.getSpeakerDefinitions())
+            channelNames.add (definition.displayName);
+
+        SpeakerVisualizerComponent screenView (processor);
+        screenView.setBounds (0, 0, width, height);
+
+        SpeakerVisualizerComponent visualizer (processor);
+        visualizer.setBounds (0, 0, width, height);
+        visualizer.prepareForExport (screenView);
+
+        juce::Image image (juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+
+        for (const auto& [mode, name] : modes)
+        {
+            beginTest (name);
+            visualizer.setVisualizationMode (mode);
+
+            // Two cycles of the level pattern let every store grow to what the pattern needs;
+            // the third must then fit.
+            for (int frame = 0; frame < 2 * cycleFrames; ++frame)
+                paintFrame (visualizer, image, channelNames, frame);
+
+            size_t mostBytes = 0;
+
+            for (int frame = 0; frame < cycleFrames; ++frame)
+            {
+                paintFrame (visualizer, image, channelNames, frame);
+                expectEquals (visualizer.getArenaOverflowsLastFrame(), 0);
+                mostBytes = juce::jmax (mostBytes, visualizer.getArenaBytesLastFrame());
+            }
+
+            expect (mostBytes > 0, "no frame used the arena");
+        }
+
+        processor.releaseResources();
+    }
+
+private:
+    static constexpr int width = 960;
+    static constexpr int height = 540;
+    static constexpr int cycleFrames = 8;
+
+    // Several channels well above the view's floors, swelling and fading out of step so the
+    // levels, band mix and marker sizes change every frame; the rest stay quiet.
+    static MetricsTimelineFrame makeFrame (int numChannels, int frameIndex)
+    {
+        MetricsTimelineFrame frame;
+        frame.numChannels = juce::jmin (numChannels, MetricsTimelineFrame::maxChannels);
+
+        for (int ch = 0; ch < frame.numChannels; ++ch)
+        {
+            const auto phase = juce::MathConstants<float>::twoPi * (float) (frameIndex + 3 * ch) / (float) cycleFrames;
+            const auto level = ch % 3 == 2 ? 0.02f : 0.35f + 0.3f * std::sin (phase);
+
+            auto& channel = frame.channels[(size_t) ch];
+            channel.rms = level;
+            channel.peak = juce::jmin (1.0f, level * 1.6f);
+            channel.low = level * (0.5f + 0.5f * std::cos (phase));
+            channel.mid = level;
+            channel.high = level * (0.5f - 0.4f * std::cos (phase));
+        }
+
+        frame.momentaryLufs = frame.shortTermLufs = -14.0f;
+        return frame;
+    }
+
+    static void paintFrame (SpeakerVisualizerComponent& visualizer, juce::Image& image,
+                            const juce::StringArray& channelNames, int frameIndex)
+    {
+        juce::Graphics g (image);
+        visualizer.renderExportFrame (makeFrame (channelNames.size(), frameIndex), channelNames, g);
+    }
+};
+
+static VisualizerFrameStorageTest visualizerFrameStorageTest;
@@ -0,0 +1,154 @@
+#include <JuceHeader.h>
+
+#include "MetricsTimeline.h"
+
+// Writes a timeline across several chunks and reads it back: the zigzag varint deltas and the
+// level and loudness quantisation must round-trip, findFrame() must land on the right frame,
+// also across a gap left by dropped frames, and a file whose last chunk was cut short must
+// still open with the chunks before it.
+class MetricsTimelineRoundTripTest : public juce::UnitTest
+{
+public:
+    MetricsTimelineRoundTripTest()
+        : juce::UnitTest ("Metrics timeline round trip", "AtmosViz") {}
+
+    void runTest() override
+    {
+        const auto file = juce::File::createTempFile (".avtl");
+        const juce::StringArray channelNames { "Left", "Right", "Centre" };
+
+        beginTest ("Write");
+        {
+            MetricsTimelineWriter writer;
+            expect (writer.open (file, sampleRate, channelNames));
+
+            for (int i = 0; i < numFrames; ++i)
+                writer.append (makeFrame (i));
+
+            writer.close();
+        }
+
+        beginTest ("Read back");
+        {
+            MetricsTimelineReader reader (file);
+            expect (reader.isValid());
+            expectEquals (reader.getNumFrames(), (juce::int64) numFrames);
+            expectEquals (reader.getNumChannels(), channelNames.size());
+            expect (reader.getChannelNames() == channelNames);
+            expectEquals (reader.getSampleRate(), sampleRate);
+
+            // Out of chunk order, so chunks are decoded again rather than only walked forwards.
+            for (auto i : { 0, 1, 255, 256, 700, 3, framesPerChunk * 3 - 1, numFrames - 1, 511, 512 })
+                expectFrame (reader, i);
+
+            checkFindFrame (reader, numFrames);
+        }
+
+        beginTest ("Truncated last chunk");
+        {
+            juce::MemoryBlock data;
+            expect (file.loadFileAsData (data));
+            expect (file.replaceWithData (data.getData(), data.getSize() - 10));
+
+            MetricsTimelineReader reader (file);
+            expect (reader.isValid());
+            expectEquals (reader.getNumFrames(), (juce::int64) framesPerChunk * 3);
+
+            expectFrame (reader, framesPerChunk * 3 - 1);
+            expect (! reader.readFrame (framesPerChunk * 3, scratch));
+            checkFindFrame (reader, framesPerChunk * 3);
+        }
+
+        file.deleteFile();
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int samplesPerFrame = 1920;
+    static constexpr int framesPerChunk = MetricsTimelineWriter::framesPerChunk;
+    static constexpr int numFrames = framesPerChunk * 3 + 100;   // three full chunks and a partial one
+    static constexpr int gapStart = 300;                           // frames from here on come...
+    static constexpr int gapFrames = 5;                            // ...this many frames late
+
+    static juce::int64 positionOf (int index) noexcept
+    {
+        return (juce::int64) (index < gapStart ? index : index + gapFrames) * samplesPerFrame;
+    }
+
+    // Levels that rise and fall (negative deltas), drop to silence (the quantisation floor) and
+    // a host position that jumps by a lot, so the varints take several bytes either way.
+    static MetricsTimelineFrame makeFrame (int index)
+    {
+        MetricsTimelineFrame frame;
+        frame.samplePosition = positionOf (index);
+        frame.hostSamplePosition = index % 50 == 0 ? -1 : ((juce::int64) 1 << 40) + (juce::int64) index * 977;
+        frame.momentaryLufs = -23.0f + 10.0f * std::sin ((float) index * 0.1f);
+        frame.shortTermLufs = index % 97 == 0 ? -120.0f : -18.0f + 0.05f * (float) (index % 40);
+        frame.numChannels = 3;
+
+        for (int ch = 0; ch < frame.numChannels; ++ch)
+        {
+            const auto level = index % 31 == ch ? 0.0f : 0.5f + 0.45f * std::sin ((float) (index + 7 * ch) * 0.05f);
+            frame.channels[(size_t) ch] = { level, juce::jmin (1.0f, level * 1.5f), level * 20.0f, level * 5.0f, level * 0.01f };
+        }
+
+        return frame;
+    }
+
+    void expectFrame (MetricsTimelineReader& reader, int index)
+    {
+        const auto expected = makeFrame (index);
+        expect (reader.readFrame (index, scratch), "frame " + juce::String (index) + " did not read");
+
+        expectEquals (scratch.samplePosition, expected.samplePosition);
+        expectEquals (scratch.hostSamplePosition, expected.hostSamplePosition);
+        expectWithinAbsoluteError (scratch.momentaryLufs, expected.momentaryLufs, 0.051f);
+        expectWithinAbsoluteError (scratch.shortTermLufs, expected.shortTermLufs, 0.051f);
+        expectEquals (scratch.numChannels, expected.numChannels);
+
+        for (int ch = 0; ch < expected.numChannels; ++ch)
+        {
+            const auto& got = scratch.channels[(size_t) ch];
+            const auto& want = expected.channels[(size_t) ch];
+
+            for (const auto& [value, reference] : { std::pair<float, float> { got.rms, want.rms },
+                                                    std::pair<float, float> { got.peak, want.peak },
+                                                    std::pair<float, float> { got.low, want.low },
+                                                    std::pair<float, float> { got.mid, want.mid },
+                                                    std::pair<float, float> { got.high, want.high } })
+            {
+                // Silence stays silence; anything else comes back within half a 0.1 dB step.
+                if (reference <= 1.0e-6f)
+                    expectEquals (value, 0.0f);
+                else
+                    expectWithinAbsoluteError (juce::Decibels::gainToDecibels (value / reference), 0.0f, 0.051f);
+            }
+        }
+    }
+
+    void checkFindFrame (MetricsTimelineReader& reader, int framesReadable)
+    {
+        const auto last = (juce::int64) framesReadable - 1;
+
+        expectEquals (reader.findFrame (-100), (juce::int64) 0);
+        expectEquals (reader.findFrame (0), (juce::int64) 0);
+        expectEquals (reader.findFrame (positionOf (1) - 1), (juce::int64) 0);
+        expectEquals (reader.findFrame (positionOf (1)), (juce::int64) 1);
+
+        // Chunk boundaries, both ways round.
+        expectEquals (reader.findFrame (positionOf (framesPerChunk) - 1), (juce::int64) framesPerChunk - 1);
+        expectEquals (reader.findFrame (positionOf (framesPerChunk)), (juce::int64) framesPerChunk);
+        expectEquals (reader.findFrame (positionOf (2 * framesPerChunk) + 1), (juce::int64) 2 * framesPerChunk);
+
+        // Inside the gap, the frame before it is the latest that has started.
+        expectEquals (reader.findFrame (positionOf (gapStart - 1) + 2 * samplesPerFrame), (juce::int64) gapStart - 1);
+        expectEquals (reader.findFrame (positionOf (gapStart)), (juce::int64) gapStart);
+
+        expectEquals (reader.findFrame (positionOf ((int) last)), last);
+        expectEquals (reader.findFrame (positionOf ((int) last) + 100 * samplesPerFrame), last);
+    }
+
+    MetricsTimelineFrame scratch;
+};
+
+static MetricsTimelineRoundTripTest metricsTimelineRoundTripTest;